@@ -112,6 +112,74 @@ console.log('Server configuration:', {
     AUTH_MODE: API_KEY ? 'Anonymous Authentication' : 'Database Rules Only'
 });
 
+// One record under the database root, through the Admin SDK when it is set up and the
+// REST API (with the anonymous token, if any) otherwise
+async function writeFirebase(path, data) {
+    if (adminInitialized && admin) {
+        await admin.database().ref(path).set(data);
+        return;
+    }
+    let url = `${FIREBASE_URL}/${path}.json`;
+    if (authToken) {
+        url += `?auth=${authToken}`;
+    }
+    await axios({
+        method: 'PUT',
+        url: url,
+        data: data,
+        headers: {
+            'Content-Type': 'application/json'
+        }
+    });
+}
+
+async function readFirebase(path) {
+    if (adminInitialized && admin) {
+        const snapshot = await admin.database().ref(path).once('value');
+        return snapshot.val();
+    }
+    let url = `${FIREBASE_URL}/${path}.json`;
+    if (authToken) {
+        url += `?auth=${authToken}`;
+    }
+    const response = await axios.get(url);
+    return response.data;
+}
+
+// Alert rule tables per device (devices/{id}/config/alert_rules, a string in the
+// firmware's "input,op,threshold,hysteresis,consecutive,weight,group;..." form).
+// Cached so a 2 s upload rate does not turn into a 2 s read rate.
+const RULES_CACHE_MS = 60 * 1000;
+const rulesCache = {};
+
+async function getDeviceRules(deviceId) {
+    const cached = rulesCache[deviceId];
+    if (cached && Date.now() - cached.fetchedAt < RULES_CACHE_MS) {
+        return cached.rules;
+    }
+
+    let rules = null;
+    try {
+        rules = await readFirebase(`devices/${deviceId}/config/alert_rules`);
+    } catch (error) {
+        console.warn('Could not read alert rules:', error.message);
+    }
+
+    if (typeof rules !== 'string' || rules.length === 0) {
+        rules = null;
+    }
+    rulesCache[deviceId] = { rules: rules, fetchedAt: Date.now() };
+    return rules;
+}
+
+// The device only knows seconds since boot, which repeat after every reset: place a
+// boot-relative time on the wall clock as far back from receipt as it was before the
+// device's own clock at send time
+function wallClockSeconds(deviceNow, bootSeconds) {
+    const age = isNaN(deviceNow) ? 0 : Math.max(0, deviceNow - bootSeconds);
+    return Math.floor(Date.now() / 1000) - age;
+}
+
 // Proxy endpoint for sensor data
 app.post('/sensor-data', async (req, res) => {
     try {
@@ -119,6 +187,127 @@ app.post('/sensor-data', async (req, res) => {
         
         // Extract data from request
         const deviceId = req.body.device_id || 'MXCHIP_001';
+
+        // Falls detected on the device go into the event log with their evidence
+        if (req.body.fall) {
+            const fall = req.body.fall;
+            const bootTime = parseInt(fall.time) || 0;
+            const fallTime = wallClockSeconds(parseInt(req.body.timestamp), bootTime);
+            const fallData = {
+                device_id: deviceId,
+                timestamp: fallTime,
+                boot_time: bootTime,
+                type: 'fall',
+                source: 'fall',
+                confidence: parseFloat(fall.confidence) || 0,
+                impact_g: parseFloat(fall.impact_g) || 0,
+                impact_z: parseFloat(fall.impact_z) || 0,
+                free_fall_ms: parseInt(fall.free_fall_ms) || 0,
+                angle_change: parseFloat(fall.angle_change) || 0,
+                height_drop: parseFloat(fall.height_drop) || 0,
+                still: !!fall.still,
+                received_at: new Date().toISOString()
+            };
+            const fallPath = `devices/${deviceId}/events/${fallTime}_fall`;
+
+            await writeFirebase(fallPath, fallData);
+
+            return res.json({
+                success: true,
+                message: 'Fall event sent to Firebase successfully',
+                device_id: deviceId,
+                timestamp: fallTime
+            });
+        }
+
+        // Status transitions (e.g. sound MEDIUM -> HIGH), one record each
+        if (req.body.event) {
+            const event = req.body.event;
+            const bootTime = parseInt(event.time) || 0;
+            const eventTime = wallClockSeconds(parseInt(req.body.timestamp), bootTime);
+            const eventData = {
+                device_id: deviceId,
+                timestamp: eventTime,
+                boot_time: bootTime,
+                source: String(event.source || 'unknown'),
+                from: String(event.from || ''),
+                to: String(event.to || ''),
+                value: parseFloat(event.value) || 0,
+                received_at: new Date().toISOString()
+            };
+            const eventKey = `${eventTime}_${eventData.source}`;
+            const eventPath = `devices/${deviceId}/events/${eventKey}`;
+
+            await writeFirebase(eventPath, eventData);
+
+            return res.json({
+                success: true,
+                message: 'Event sent to Firebase successfully',
+                device_id: deviceId,
+                timestamp: eventTime
+            });
+        }
+
+        // Activity features per IMU window (SMA, ENMO, jerk, variance, dominant frequency, cadence)
+        if (req.body.activity) {
+            const activity = req.body.activity;
+            const bootStart = parseInt(activity.start) || 0;
+            const start = wallClockSeconds(parseInt(req.body.timestamp), bootStart);
+            const activityData = {
+                device_id: deviceId,
+                start: start,
+                boot_start: bootStart,
+                window_s: parseInt(activity.window_s) || 0,
+                sma: parseFloat(activity.sma) || 0,
+                enmo: parseFloat(activity.enmo) || 0,
+                jerk_rms: parseFloat(activity.jerk_rms) || 0,
+                var_x: parseFloat(activity.var_x) || 0,
+                var_y: parseFloat(activity.var_y) || 0,
+                var_z: parseFloat(activity.var_z) || 0,
+                gyro_rms: parseFloat(activity.gyro_rms) || 0,
+                dominant_hz: parseFloat(activity.dominant_hz) || 0,
+                steps: parseInt(activity.steps) || 0,
+                cadence: parseFloat(activity.cadence) || 0,
+                received_at: new Date().toISOString()
+            };
+            const activityPath = `devices/${deviceId}/activity/${start}`;
+
+            await writeFirebase(activityPath, activityData);
+
+            return res.json({
+                success: true,
+                message: 'Activity window sent to Firebase successfully',
+                device_id: deviceId,
+                start: start
+            });
+        }
+
+        // Per-period summaries (min/max/mean/std per channel) are kept apart from raw snapshots
+        if (req.body.summary) {
+            const summary = req.body.summary;
+            const periodS = parseInt(summary.period_s) || 60;
+            const bootStart = parseInt(summary.start) || 0;
+            const start = wallClockSeconds(parseInt(req.body.timestamp), bootStart);
+            const summaryData = {
+                device_id: deviceId,
+                period_s: periodS,
+                start: start,
+                boot_start: bootStart,
+                channels: summary.channels || {},
+                received_at: new Date().toISOString()
+            };
+            const summaryPath = `devices/${deviceId}/summaries/${periodS}s/${start}`;
+
+            await writeFirebase(summaryPath, summaryData);
+
+            return res.json({
+                success: true,
+                message: 'Summary sent to Firebase successfully',
+                device_id: deviceId,
+                start: start
+            });
+        }
+
         const timestamp = parseInt(req.body.timestamp) || Date.now();
         const temperature = parseFloat(req.body.temperature);
         const humidity = parseFloat(req.body.humidity);
@@ -133,6 +322,11 @@ app.post('/sensor-data', async (req, res) => {
         const angleY = parseFloat(req.body.angle_y) || 0;
         const angleZ = parseFloat(req.body.angle_z) || 0;
         const sound = parseInt(req.body.sound) || 0;
+        const pressure = parseFloat(req.body.pressure);
+        const heightChange = parseFloat(req.body.height_change) || 0;
+        const soundBands = Array.isArray(req.body.sound_bands) ? req.body.sound_bands.map(Number) : null;
+        const soundCentroid = parseFloat(req.body.sound_centroid) || 0;
+        const soundFlatness = parseFloat(req.body.sound_flatness) || 0;
 
         // Validate required fields
         if (isNaN(temperature) || isNaN(humidity) || isNaN(timestamp)) {
@@ -165,6 +359,21 @@ app.post('/sensor-data', async (req, res) => {
             received_at: new Date().toISOString()
         };
 
+        // Spectral summary is only sent once the device has analysed a few blocks
+        if (soundBands) {
+            firebaseData.sensors.sound.bands = soundBands;
+            firebaseData.sensors.sound.centroid_hz = soundCentroid;
+            firebaseData.sensors.sound.flatness = soundFlatness;
+        }
+
+        // Boards without a working barometer leave the pressure fields out
+        if (!isNaN(pressure)) {
+            firebaseData.sensors.pressure = {
+                hpa: pressure,
+                height_change: heightChange
+            };
+        }
+
         console.log('Processed data:', firebaseData);
         
         // Construct Firebase path with authentication
@@ -215,12 +424,20 @@ app.post('/sensor-data', async (req, res) => {
             });
         }
 
-        res.json({
+        const response = {
             success: true,
             message: 'Data sent to Firebase successfully',
             device_id: deviceId,
             timestamp: timestamp
-        });
+        };
+
+        // The device reloads its alert rules whenever this text changes
+        const rules = await getDeviceRules(deviceId);
+        if (rules) {
+            response.rules = rules;
+        }
+
+        res.json(response);
     } catch (error) {
         console.error('Error details:', {
             name: error.name,
@@ -1,5 +1,6 @@
 #include "MXChipFirebase.h"
 #include "Wire.h"
+#include <math.h>
 // WiFiClient is provided via AZ3166WiFi.h included in MXChipFirebase.h
 // WiFi class is available from AZ3166WiFi.h included in MXChipFirebase.h
 
@@ -13,6 +14,7 @@ MXChipFirebase::MXChipFirebase() {
     deviceId = "MXCHIP_001";
     lastSendTime = 0;
     updateInterval = 5000;  // Default: send every 5 seconds
+    motionSnapshot = true;
     strcpy(lastError, "");
 }
 
@@ -157,6 +159,16 @@ bool MXChipFirebase::sendJSON(const char* jsonData) {
         success = true;
     }
 
+    // Optional rule table: "rules":"input,op,threshold,..."
+    int rulesStart = response.indexOf("\"rules\":\"");
+    if (success && rulesStart >= 0) {
+        rulesStart += 9;
+        int rulesEnd = response.indexOf('"', rulesStart);
+        if (rulesEnd > rulesStart) {
+            pendingRules = response.substring(rulesStart, rulesEnd);
+        }
+    }
+
     if (debugMode) {
         if (success) Serial.println("Proxy: Data sent successfully to Firebase");
         else Serial.println("Proxy: Request sent but no success confirmation");
@@ -182,7 +194,10 @@ void MXChipFirebase::setPath(const char* path) {
 bool MXChipFirebase::sendSensorData(const char* deviceId, float temp, float hum, float motionMag, int sound,
                                     float accelX, float accelY, float accelZ,
                                     float gyroX, float gyroY, float gyroZ,
-                                    float xAngle, float yAngle, float zAngle) {
+                                    float xAngle, float yAngle, float zAngle,
+                                    float pressure, float heightChange,
+                                    const int16_t* soundBands, uint8_t soundBandCount,
+                                    uint16_t soundCentroidHz, float soundFlatness) {
     if (!connected || WiFi.status() != WL_CONNECTED) {
         strcpy(lastError, "WiFi not connected");
         return false;
@@ -195,6 +210,46 @@ bool MXChipFirebase::sendSensorData(const char* deviceId, float temp, float hum,
     }
     lastSendTime = now;
 
+    // Optional spectral summary of the microphone, appended after "sound"
+    char spectrum[160] = "";
+    if (soundBands != nullptr && soundBandCount > 0) {
+        int len = snprintf(spectrum, sizeof(spectrum), ",\"sound_bands\":[");
+        for (uint8_t i = 0; i < soundBandCount && len < (int)sizeof(spectrum); i++) {
+            len += snprintf(spectrum + len, sizeof(spectrum) - len, i ? ",%d" : "%d", soundBands[i]);
+        }
+        if (len < (int)sizeof(spectrum)) {
+            snprintf(spectrum + len, sizeof(spectrum) - len,
+                     "],\"sound_centroid\":%u,\"sound_flatness\":%.3f", soundCentroidHz, soundFlatness);
+        }
+    }
+
+    // Raw motion fields, left out when motion goes up as activity windows only
+    char motionFields[200] = "";
+    if (motionSnapshot) {
+        snprintf(motionFields, sizeof(motionFields),
+            "\"motion_x\":%.3f,"
+            "\"motion_y\":%.3f,"
+            "\"motion_z\":%.3f,"
+            "\"gyro_x\":%.3f,"
+            "\"gyro_y\":%.3f,"
+            "\"gyro_z\":%.3f,"
+            "\"angle_x\":%.2f,"
+            "\"angle_y\":%.2f,"
+            "\"angle_z\":%.2f,",
+            accelX, accelY, accelZ,
+            gyroX, gyroY, gyroZ,
+            xAngle, yAngle, zAngle);
+    }
+
+    // Barometer fields, left out when there is no reading (NaN)
+    char pressureFields[64] = "";
+    if (!isnan(pressure)) {
+        snprintf(pressureFields, sizeof(pressureFields),
+            "\"pressure\":%.2f,"
+            "\"height_change\":%.2f,",
+            pressure, heightChange);
+    }
+
     // Create JSON payload matching proxy server format
     char jsonPayload[800];
     unsigned long timestamp = now / 1000; // Convert to seconds
@@ -206,28 +261,124 @@ bool MXChipFirebase::sendSensorData(const char* deviceId, float temp, float hum,
         "\"temperature\":%.2f,"
         "\"humidity\":%.2f,"
         "\"motion_magnitude\":%.3f,"
-        "\"motion_x\":%.3f,"
-        "\"motion_y\":%.3f,"
-        "\"motion_z\":%.3f,"
-        "\"gyro_x\":%.3f,"
-        "\"gyro_y\":%.3f,"
-        "\"gyro_z\":%.3f,"
-        "\"angle_x\":%.2f,"
-        "\"angle_y\":%.2f,"
-        "\"angle_z\":%.2f,"
+        "%s"
+        "%s"
         "\"sound\":%d"
+        "%s"
         "}",
         deviceId ? deviceId : this->deviceId, timestamp,
         temp, hum,
-        motionMag, accelX, accelY, accelZ,
-        gyroX, gyroY, gyroZ,
-        xAngle, yAngle, zAngle,
-        sound
+        motionMag,
+        motionFields,
+        pressureFields,
+        sound,
+        spectrum
     );
 
     return sendJSON(jsonPayload);
 }
 
+bool MXChipFirebase::sendSummary(const char* deviceId, uint32_t periodSeconds, unsigned long startSeconds,
+                                 const ChannelSummary* channels, uint8_t channelCount) {
+    if (!connected || WiFi.status() != WL_CONNECTED) {
+        strcpy(lastError, "WiFi not connected");
+        return false;
+    }
+
+    // Not rate limited: summaries already arrive once per period
+    char jsonPayload[800];
+    int len = snprintf(jsonPayload, sizeof(jsonPayload),
+        "{"
+        "\"device_id\":\"%s\","
+        "\"timestamp\":%lu,"
+        "\"summary\":{\"period_s\":%lu,\"start\":%lu,\"channels\":{",
+        deviceId ? deviceId : this->deviceId, millis() / 1000,
+        (unsigned long)periodSeconds, startSeconds);
+    for (uint8_t i = 0; i < channelCount && len < (int)sizeof(jsonPayload); i++) {
+        const ChannelSummary& c = channels[i];
+        len += snprintf(jsonPayload + len, sizeof(jsonPayload) - len,
+            "%s\"%s\":{\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f,\"std\":%.3f,\"n\":%lu}",
+            i ? "," : "", c.name, c.min, c.max, c.mean, c.stddev, (unsigned long)c.count);
+    }
+    if (len + 4 > (int)sizeof(jsonPayload)) {
+        strcpy(lastError, "Summary payload too large");
+        return false;
+    }
+    strcpy(jsonPayload + len, "}}}");
+
+    return sendJSON(jsonPayload);
+}
+
+bool MXChipFirebase::sendEvent(const char* deviceId, const char* source, const char* from, const char* to,
+                               float value, unsigned long eventSeconds) {
+    if (!connected || WiFi.status() != WL_CONNECTED) {
+        strcpy(lastError, "WiFi not connected");
+        return false;
+    }
+
+    // Not rate limited: transitions are rare and each one matters
+    char jsonPayload[256];
+    snprintf(jsonPayload, sizeof(jsonPayload),
+        "{"
+        "\"device_id\":\"%s\","
+        "\"timestamp\":%lu,"
+        "\"event\":{\"source\":\"%s\",\"from\":\"%s\",\"to\":\"%s\",\"value\":%.2f,\"time\":%lu}"
+        "}",
+        deviceId ? deviceId : this->deviceId, millis() / 1000, source, from, to, value, eventSeconds);
+
+    return sendJSON(jsonPayload);
+}
+
+bool MXChipFirebase::sendFallEvent(const char* deviceId, float confidence, float impactG, float impactZ,
+                                   unsigned int freeFallMs, float angleChangeDeg, float heightDropM,
+                                   bool still, unsigned long eventSeconds) {
+    if (!connected || WiFi.status() != WL_CONNECTED) {
+        strcpy(lastError, "WiFi not connected");
+        return false;
+    }
+
+    // Sent as soon as it is detected, outside the periodic rate limit
+    char jsonPayload[320];
+    snprintf(jsonPayload, sizeof(jsonPayload),
+        "{"
+        "\"device_id\":\"%s\","
+        "\"timestamp\":%lu,"
+        "\"fall\":{\"confidence\":%.2f,\"impact_g\":%.2f,\"impact_z\":%.1f,\"free_fall_ms\":%u,"
+        "\"angle_change\":%.1f,\"height_drop\":%.2f,\"still\":%s,\"time\":%lu}"
+        "}",
+        deviceId ? deviceId : this->deviceId, millis() / 1000, confidence, impactG, impactZ, freeFallMs,
+        angleChangeDeg, heightDropM, still ? "true" : "false", eventSeconds);
+
+    return sendJSON(jsonPayload);
+}
+
+bool MXChipFirebase::sendActivity(const char* deviceId, unsigned long startSeconds, uint32_t windowSeconds,
+                                  float sma, float enmo, float jerkRms,
+                                  float varianceX, float varianceY, float varianceZ,
+                                  float gyroRms, float dominantHz, uint16_t steps, float cadence) {
+    if (!connected || WiFi.status() != WL_CONNECTED) {
+        strcpy(lastError, "WiFi not connected");
+        return false;
+    }
+
+    // One per closed window, so not rate limited
+    char jsonPayload[400];
+    snprintf(jsonPayload, sizeof(jsonPayload),
+        "{"
+        "\"device_id\":\"%s\","
+        "\"timestamp\":%lu,"
+        "\"activity\":{\"start\":%lu,\"window_s\":%lu,\"sma\":%.4f,\"enmo\":%.4f,\"jerk_rms\":%.3f,"
+        "\"var_x\":%.5f,\"var_y\":%.5f,\"var_z\":%.5f,\"gyro_rms\":%.2f,"
+        "\"dominant_hz\":%.2f,\"steps\":%u,\"cadence\":%.1f}"
+        "}",
+        deviceId ? deviceId : this->deviceId, millis() / 1000,
+        startSeconds, (unsigned long)windowSeconds, sma, enmo, jerkRms,
+        varianceX, varianceY, varianceZ, gyroRms,
+        dominantHz, steps, cadence);
+
+    return sendJSON(jsonPayload);
+}
+
 void MXChipFirebase::setDeviceId(const char* deviceId) {
     this->deviceId = deviceId;
 }
@@ -236,6 +387,22 @@ void MXChipFirebase::setUpdateInterval(unsigned long interval) {
     this->updateInterval = interval;
 }
 
+void MXChipFirebase::setMotionSnapshot(bool enabled) {
+    this->motionSnapshot = enabled;
+}
+
+bool MXChipFirebase::takeRules(char* rules, size_t size) {
+    if (pendingRules.length() == 0 || size == 0) return false;
+    if (pendingRules.length() >= size) {
+        pendingRules = "";
+        strcpy(lastError, "Rules from proxy too long");
+        return false;
+    }
+    strcpy(rules, pendingRules.c_str());
+    pendingRules = "";
+    return true;
+}
+
 const char* MXChipFirebase::getLastError() {
     return lastError;
 } 
\ No newline at end of file
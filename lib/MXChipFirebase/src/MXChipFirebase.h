@@ -5,21 +5,50 @@
 #include "AZ3166WiFi.h"
 #include "Wire.h"
 
+// One channel of an aggregated upload (min/max/mean/stddev over `count` samples)
+struct ChannelSummary {
+    const char* name;
+    float min;
+    float max;
+    float mean;
+    float stddev;
+    uint32_t count;
+};
+
 class MXChipFirebase {
 public:
     MXChipFirebase();
     bool begin(const char* host, int port);
     bool sendData(float temperature, float humidity);
+    // Pressure NaN (no barometer) leaves "pressure" and "height_change" out of the snapshot
     bool sendSensorData(const char* deviceId, float temp, float hum, float motionMag, int sound,
                        float accelX, float accelY, float accelZ,
                        float gyroX, float gyroY, float gyroZ,
-                       float xAngle, float yAngle, float zAngle);
+                       float xAngle, float yAngle, float zAngle,
+                       float pressure, float heightChange,
+                       const int16_t* soundBands = nullptr, uint8_t soundBandCount = 0,
+                       uint16_t soundCentroidHz = 0, float soundFlatness = 0.0f);
+    bool sendSummary(const char* deviceId, uint32_t periodSeconds, unsigned long startSeconds,
+                     const ChannelSummary* channels, uint8_t channelCount);
+    bool sendEvent(const char* deviceId, const char* source, const char* from, const char* to,
+                   float value, unsigned long eventSeconds);
+    bool sendFallEvent(const char* deviceId, float confidence, float impactG, float impactZ,
+                       unsigned int freeFallMs, float angleChangeDeg, float heightDropM,
+                       bool still, unsigned long eventSeconds);
+    bool sendActivity(const char* deviceId, unsigned long startSeconds, uint32_t windowSeconds,
+                      float sma, float enmo, float jerkRms,
+                      float varianceX, float varianceY, float varianceZ,
+                      float gyroRms, float dominantHz, uint16_t steps, float cadence);
     bool sendJSON(const char* jsonData);
+    // Alert rule table sent back by the proxy ("rules" in its response), once per response
+    bool takeRules(char* rules, size_t size);
     bool isConnected();
     void setDebugMode(bool debug);
     void setPath(const char* path);
     void setDeviceId(const char* deviceId);
     void setUpdateInterval(unsigned long interval);
+    // Include the raw accel/gyro/angle fields in sendSensorData snapshots (default on)
+    void setMotionSnapshot(bool enabled);
     const char* getLastError();
 
 private:
@@ -33,7 +62,9 @@ private:
     const char* deviceId;
     unsigned long lastSendTime;
     unsigned long updateInterval;
+    bool motionSnapshot;
     char lastError[256];
+    String pendingRules;
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "I2CAsyncEngine.h"
+
+I2CAsyncEngine::I2CAsyncEngine() {
+    backend = nullptr;
+    waiter = nullptr;
+    timeoutMs = I2C_ENGINE_TIMEOUT_MS;
+    waiting = 0;
+    queueHead = 0;
+    queueCount = 0;
+    active = nullptr;
+    starting = false;
+    completed = 0;
+    failed = 0;
+    rejected = 0;
+    timeouts = 0;
+}
+
+void I2CAsyncEngine::begin(I2CBackend* backend) {
+    this->backend = backend;
+    backend->attach(this);
+}
+
+void I2CAsyncEngine::setWaiter(I2CWaiter* waiter, uint32_t timeoutMs) {
+    this->waiter = waiter;
+    this->timeoutMs = timeoutMs;
+}
+
+bool I2CAsyncEngine::submit(I2CRequest* request) {
+    if (backend == nullptr || request == nullptr || request->isBusy()) return false;
+
+    uint32_t irq = I2C_ENGINE_LOCK();
+    if (queueCount >= I2C_ENGINE_QUEUE_DEPTH) {
+        rejected++;
+        I2C_ENGINE_UNLOCK(irq);
+        return false;
+    }
+    request->state = I2C_REQUEST_QUEUED;
+    queue[(queueHead + queueCount) % I2C_ENGINE_QUEUE_DEPTH] = request;
+    queueCount++;
+    I2C_ENGINE_UNLOCK(irq);
+
+    startNext();
+    return true;
+}
+
+// Start queued transfers until one is in flight. Blocking backends complete inside
+// start(), so this loops instead of recursing through onComplete().
+void I2CAsyncEngine::startNext() {
+    uint32_t irq = I2C_ENGINE_LOCK();
+    if (starting) {
+        I2C_ENGINE_UNLOCK(irq);
+        return;
+    }
+    starting = true;
+
+    while (true) {
+        if (active != nullptr || queueCount == 0) {
+            starting = false;
+            I2C_ENGINE_UNLOCK(irq);
+            return;
+        }
+        I2CRequest* next = queue[queueHead];
+        queueHead = (queueHead + 1) % I2C_ENGINE_QUEUE_DEPTH;
+        queueCount--;
+        next->state = I2C_REQUEST_IN_FLIGHT;
+        active = next;
+        I2C_ENGINE_UNLOCK(irq);
+
+        if (!backend->start(next)) {
+            onComplete(false);
+        }
+
+        irq = I2C_ENGINE_LOCK();
+    }
+}
+
+void I2CAsyncEngine::onComplete(bool ok) {
+    uint32_t irq = I2C_ENGINE_LOCK();
+    I2CRequest* finished = active;
+    active = nullptr;
+    bool kick = !starting;
+    if (finished != nullptr) {
+        finished->state = ok ? I2C_REQUEST_DONE : I2C_REQUEST_FAILED;
+        if (ok) completed++;
+        else failed++;
+    }
+    uint8_t sleepers = waiting;
+    I2C_ENGINE_UNLOCK(irq);
+
+    if (finished != nullptr && finished->callback != nullptr) {
+        finished->callback(finished->ctx, finished);
+    }
+    if (kick) startNext();
+    // Every blocked caller rechecks its own request; one wake each
+    if (waiter != nullptr) {
+        for (uint8_t i = 0; i < sleepers; i++) waiter->wake();
+    }
+}
+
+bool I2CAsyncEngine::wait(I2CRequest* request) {
+    waitUntil(request);
+    return request->isDone();
+}
+
+void I2CAsyncEngine::waitIdle() {
+    waitUntil(nullptr);
+}
+
+// Block until request (nullptr: the whole queue) has finished. A transfer that stays in
+// flight past the timeout is aborted and failed, so a lost completion interrupt or a
+// held-down SDA line costs one failed read instead of hanging every caller.
+void I2CAsyncEngine::waitUntil(I2CRequest* request) {
+    I2CRequest* watched = nullptr;
+    uint32_t watchedSinceMs = 0;
+    while (true) {
+        // Registered as waiting before the check, so a completion in between still wakes us
+        uint32_t irq = I2C_ENGINE_LOCK();
+        waiting++;
+        I2C_ENGINE_UNLOCK(irq);
+
+        backend->poll();
+        irq = I2C_ENGINE_LOCK();
+        bool finished = request != nullptr ? !request->isBusy() : (active == nullptr && queueCount == 0);
+        I2CRequest* current = active;
+        I2C_ENGINE_UNLOCK(irq);
+
+        if (!finished && waiter != nullptr) {
+            uint32_t now = waiter->nowMs();
+            if (current != watched) {
+                watched = current;
+                watchedSinceMs = now;
+            }
+            uint32_t elapsed = now - watchedSinceMs;
+            if (current != nullptr && elapsed >= timeoutMs) {
+                expire(current);
+            } else {
+                waiter->sleep(elapsed < timeoutMs ? timeoutMs - elapsed : timeoutMs);
+            }
+        }
+
+        irq = I2C_ENGINE_LOCK();
+        waiting--;
+        I2C_ENGINE_UNLOCK(irq);
+        if (finished) return;
+    }
+}
+
+void I2CAsyncEngine::expire(I2CRequest* stuck) {
+    uint32_t irq = I2C_ENGINE_LOCK();
+    bool abort = active == stuck;
+    if (abort) {
+        backend->abort();
+        timeouts++;
+    }
+    I2C_ENGINE_UNLOCK(irq);
+    if (abort) onComplete(false);
+}
+
+bool I2CAsyncEngine::transfer(uint8_t address, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) {
+    if (txLen > sizeof(((I2CRequest*)0)->tx)) return false;
+
+    I2CRequest request;
+    request.address = address;
+    for (uint8_t i = 0; i < txLen; i++) {
+        request.tx[i] = tx[i];
+    }
+    request.txLen = txLen;
+    request.rx = rx;
+    request.rxLen = rxLen;
+    request.callback = nullptr;
+    request.ctx = nullptr;
+    request.state = I2C_REQUEST_IDLE;
+
+    if (!submit(&request)) return false;
+    return wait(&request);
+}
+
+bool I2CAsyncEngine::isIdle() const {
+    return active == nullptr && queueCount == 0;
+}
+
+uint8_t I2CAsyncEngine::getQueuedCount() const {
+    return queueCount;
+}
+
+uint32_t I2CAsyncEngine::getCompletedCount() const {
+    return completed;
+}
+
+uint32_t I2CAsyncEngine::getFailedCount() const {
+    return failed;
+}
+
+uint32_t I2CAsyncEngine::getRejectedCount() const {
+    return rejected;
+}
+
+uint32_t I2CAsyncEngine::getTimeoutCount() const {
+    return timeouts;
+}
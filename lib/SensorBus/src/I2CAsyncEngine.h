@@ -0,0 +1,152 @@
+#ifndef I2CAsyncEngine_H
+#define I2CAsyncEngine_H
+
+#include <stdint.h>
+#include "SensorBus.h"
+
+#ifndef I2C_ENGINE_QUEUE_DEPTH
+#define I2C_ENGINE_QUEUE_DEPTH 8
+#endif
+#ifndef I2C_ENGINE_TIMEOUT_MS
+#define I2C_ENGINE_TIMEOUT_MS 25        // A transfer in flight longer than this is aborted
+#endif
+
+// Queue operations run from loop(), the IMU acquisition thread and the transfer-complete
+// interrupt, so they are guarded by masking interrupts on the device. The previous mask
+// is restored on unlock, so a caller that already had interrupts off (or the completion
+// interrupt itself) keeps them off.
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "cmsis.h"
+#define I2C_ENGINE_LOCK()        i2cEngineLock()
+#define I2C_ENGINE_UNLOCK(state) __set_PRIMASK(state)
+static inline uint32_t i2cEngineLock() {
+    uint32_t state = __get_PRIMASK();
+    __disable_irq();
+    return state;
+}
+#else
+#define I2C_ENGINE_LOCK()        0u
+#define I2C_ENGINE_UNLOCK(state) (void)(state)
+#endif
+
+class I2CAsyncEngine;
+struct I2CRequest;
+
+// Completion callback. Runs in the context that finished the transfer (the I2C
+// interrupt for the hardware backend), so it must be short and must not block.
+typedef void (*I2CCallback)(void* ctx, I2CRequest* request);
+
+enum I2CRequestState {
+    I2C_REQUEST_IDLE = 0,
+    I2C_REQUEST_QUEUED,
+    I2C_REQUEST_IN_FLIGHT,
+    I2C_REQUEST_DONE,
+    I2C_REQUEST_FAILED
+};
+
+// One write-then-read transfer. The caller owns the request and its rx buffer
+// until the request reaches DONE or FAILED.
+struct I2CRequest {
+    uint8_t address;
+    uint8_t tx[2];                    // Sub-address (+ value for register writes)
+    uint8_t txLen;
+    uint8_t* rx;
+    uint8_t rxLen;
+    I2CCallback callback;
+    void* ctx;
+    volatile uint8_t state;
+
+    bool isBusy() const { return state == I2C_REQUEST_QUEUED || state == I2C_REQUEST_IN_FLIGHT; }
+    bool isDone() const { return state == I2C_REQUEST_DONE; }
+};
+
+// Non-blocking register block read owned by a sensor driver: submit it, carry on,
+// and pick up the bytes once isDone() reports the transfer finished.
+struct BusAsyncRead {
+    I2CRequest request;
+    uint8_t data[SENSOR_BUS_MAX_BURST];
+    SensorBus* bus;                   // Set by SensorBus::submit, which sees the completion first
+    I2CCallback callback;
+    void* ctx;
+
+    BusAsyncRead() : bus(nullptr), callback(nullptr), ctx(nullptr) { request.state = I2C_REQUEST_IDLE; }
+    bool isBusy() const { return request.isBusy(); }
+    bool isDone() const { return request.isDone(); }
+    // Mark the result as consumed so the next submit starts fresh
+    void release() { if (!request.isBusy()) request.state = I2C_REQUEST_IDLE; }
+};
+
+// Moves bytes for the engine. start() begins a transfer and returns immediately;
+// the backend calls engine->onComplete() when it finishes (from its interrupt, or
+// before start() returns for blocking backends).
+class I2CBackend {
+public:
+    I2CBackend() : engine(nullptr) {}
+    virtual ~I2CBackend() {}
+    virtual bool start(I2CRequest* request) = 0;
+    // Give polled backends (mock) a chance to make progress while someone waits
+    virtual void poll() {}
+    // Stop the transfer in flight without completing it (called with interrupts masked)
+    virtual void abort() {}
+    void attach(I2CAsyncEngine* engine) { this->engine = engine; }
+
+protected:
+    I2CAsyncEngine* engine;
+};
+
+// How a caller blocked in wait() passes the time: on the device an RTOS semaphore
+// released from the completion interrupt, so a waiting thread sleeps instead of spinning.
+class I2CWaiter {
+public:
+    virtual ~I2CWaiter() {}
+    virtual uint32_t nowMs() = 0;
+    virtual void sleep(uint32_t maxMs) = 0;   // Until wake() or maxMs, whichever comes first
+    virtual void wake() = 0;                  // From onComplete(), possibly in interrupt context
+};
+
+// Serialises queued register transfers onto one bus. Sensors submit requests and
+// carry on; completion is signalled through the request state and optional callback.
+// Implements I2CTransport so SensorBus' blocking calls become submit + wait.
+class I2CAsyncEngine : public I2CTransport {
+public:
+    I2CAsyncEngine();
+    void begin(I2CBackend* backend);
+    // Without a waiter, wait() polls the backend with no deadline (host builds)
+    void setWaiter(I2CWaiter* waiter, uint32_t timeoutMs = I2C_ENGINE_TIMEOUT_MS);
+
+    bool submit(I2CRequest* request);
+    void onComplete(bool ok);           // Backend -> engine, may run in interrupt context
+    bool wait(I2CRequest* request);     // Block until request finishes (synchronous fallback)
+    void waitIdle();                    // Block until nothing is queued or in flight
+
+    bool transfer(uint8_t address, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) override;
+
+    bool isIdle() const;
+    uint8_t getQueuedCount() const;
+    uint32_t getCompletedCount() const;
+    uint32_t getFailedCount() const;
+    uint32_t getRejectedCount() const;
+    uint32_t getTimeoutCount() const;
+
+private:
+    void startNext();
+    void waitUntil(I2CRequest* request);
+    void expire(I2CRequest* stuck);
+
+    I2CBackend* backend;
+    I2CWaiter* waiter;
+    uint32_t timeoutMs;
+    volatile uint8_t waiting;
+    I2CRequest* queue[I2C_ENGINE_QUEUE_DEPTH];
+    uint8_t queueHead;
+    uint8_t queueCount;
+    I2CRequest* volatile active;
+    volatile bool starting;
+    volatile uint32_t completed;
+    volatile uint32_t failed;
+    volatile uint32_t rejected;
+    volatile uint32_t timeouts;
+};
+
+#endif
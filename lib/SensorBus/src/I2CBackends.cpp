@@ -0,0 +1,139 @@
+#include "I2CBackends.h"
+
+bool SyncI2CBackend::start(I2CRequest* request) {
+    bool ok = transport->transfer(request->address, request->tx, request->txLen, request->rx, request->rxLen);
+    engine->onComplete(ok);
+    return true;
+}
+
+#if defined(ARDUINO) && defined(DEVICE_I2C_ASYNCH)
+HalAsyncI2CBackend* HalAsyncI2CBackend::instance = nullptr;
+
+HalAsyncI2CBackend::HalAsyncI2CBackend(PinName sda, PinName scl, uint32_t frequencyHz)
+    : sda(sda), scl(scl), frequencyHz(frequencyHz) {
+}
+
+void HalAsyncI2CBackend::begin() {
+    instance = this;
+    i2c_init(&hal, sda, scl);
+    i2c_frequency(&hal, frequencyHz);
+}
+
+bool HalAsyncI2CBackend::start(I2CRequest* request) {
+    // 8-bit address; STOP after the read (repeated START between write and read)
+    i2c_transfer_asynch(&hal, request->tx, request->txLen, request->rx, request->rxLen,
+                        request->address << 1, true, (uint32_t)&HalAsyncI2CBackend::irqHandler,
+                        I2C_EVENT_ALL, DMA_USAGE_NEVER);
+    return true;
+}
+
+// The engine's deadline ran out: stop the peripheral and drop its interrupt
+void HalAsyncI2CBackend::abort() {
+    i2c_abort_asynch(&hal);
+}
+
+void HalAsyncI2CBackend::irqHandler() {
+    int event = i2c_irq_handler_asynch(&instance->hal);
+    if (event == 0) return; // Transfer still running
+    bool ok = (event & (I2C_EVENT_ERROR | I2C_EVENT_ERROR_NO_SLAVE | I2C_EVENT_TRANSFER_EARLY_NACK)) == 0;
+    instance->engine->onComplete(ok);
+}
+#endif
+
+MockI2CBackend::MockI2CBackend() {
+    deviceCount = 0;
+    deferred = false;
+    stalled = false;
+    pending = nullptr;
+    transferCount = 0;
+}
+
+void MockI2CBackend::addDevice(uint8_t address, uint8_t autoIncrementFlag) {
+    if (deviceCount >= MOCK_I2C_MAX_DEVICES) return;
+    Device& device = devices[deviceCount++];
+    device.address = address;
+    device.autoIncrementFlag = autoIncrementFlag;
+    for (uint16_t i = 0; i < 256; i++) {
+        device.registers[i] = 0;
+    }
+}
+
+MockI2CBackend::Device* MockI2CBackend::findDevice(uint8_t address) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) return &devices[i];
+    }
+    return nullptr;
+}
+
+const MockI2CBackend::Device* MockI2CBackend::findDevice(uint8_t address) const {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) return &devices[i];
+    }
+    return nullptr;
+}
+
+void MockI2CBackend::setRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    Device* device = findDevice(address);
+    if (device != nullptr) device->registers[reg] = value;
+}
+
+uint8_t MockI2CBackend::getRegister(uint8_t address, uint8_t reg) const {
+    const Device* device = findDevice(address);
+    return device ? device->registers[reg] : 0;
+}
+
+void MockI2CBackend::setDeferredCompletion(bool deferred) {
+    this->deferred = deferred;
+}
+
+void MockI2CBackend::setStalled(bool stalled) {
+    this->stalled = stalled;
+}
+
+// Apply a transfer to the register file: first tx byte is the sub-address, the rest
+// is written; reads continue from the sub-address with auto-increment.
+bool MockI2CBackend::execute(I2CRequest* request) {
+    Device* device = findDevice(request->address);
+    if (device == nullptr || request->txLen == 0) return false;
+
+    // MSB-increment parts only advance the pointer when the flag is in the sub-address
+    uint8_t reg = request->tx[0] & ~device->autoIncrementFlag;
+    uint8_t step = (device->autoIncrementFlag == 0 || (request->tx[0] & device->autoIncrementFlag)) ? 1 : 0;
+    for (uint8_t i = 1; i < request->txLen; i++) {
+        device->registers[(uint8_t)(reg + (i - 1) * step)] = request->tx[i];
+    }
+    for (uint8_t i = 0; i < request->rxLen; i++) {
+        request->rx[i] = device->registers[(uint8_t)(reg + i * step)];
+    }
+    transferCount++;
+    return true;
+}
+
+bool MockI2CBackend::start(I2CRequest* request) {
+    if (deferred || stalled) {
+        pending = request;
+        return true;
+    }
+    engine->onComplete(execute(request));
+    return true;
+}
+
+void MockI2CBackend::poll() {
+    completePending();
+}
+
+void MockI2CBackend::abort() {
+    pending = nullptr;
+}
+
+bool MockI2CBackend::completePending() {
+    if (pending == nullptr || stalled) return false;
+    I2CRequest* request = pending;
+    pending = nullptr;
+    engine->onComplete(execute(request));
+    return true;
+}
+
+uint32_t MockI2CBackend::getTransferCount() const {
+    return transferCount;
+}
@@ -0,0 +1,82 @@
+#ifndef I2CBackends_H
+#define I2CBackends_H
+
+#include <stdint.h>
+#include "I2CAsyncEngine.h"
+
+// Blocking fallback: runs each transfer to completion on an I2CTransport (e.g. Wire)
+class SyncI2CBackend : public I2CBackend {
+public:
+    explicit SyncI2CBackend(I2CTransport* transport) : transport(transport) {}
+    bool start(I2CRequest* request) override;
+
+private:
+    I2CTransport* transport;
+};
+
+#if defined(ARDUINO) && defined(DEVICE_I2C_ASYNCH)
+#include "i2c_api.h"
+
+// Interrupt-driven transfers on the STM32F412 I2C peripheral through the mbed HAL.
+// The HAL asynch API is used directly because mbed::I2C takes a mutex, which is not
+// allowed from the completion interrupt where the next queued transfer is started.
+class HalAsyncI2CBackend : public I2CBackend {
+public:
+    HalAsyncI2CBackend(PinName sda, PinName scl, uint32_t frequencyHz);
+    void begin();
+    bool start(I2CRequest* request) override;
+    void abort() override;
+
+private:
+    static void irqHandler();
+    static HalAsyncI2CBackend* instance;
+
+    i2c_t hal;
+    PinName sda;
+    PinName scl;
+    uint32_t frequencyHz;
+};
+#endif
+
+#ifndef MOCK_I2C_MAX_DEVICES
+#define MOCK_I2C_MAX_DEVICES 4
+#endif
+
+// In-memory register file standing in for the sensors on a host build.
+// With deferred completion, transfers stay in flight until completePending()
+// is called, which mimics the transfer-complete interrupt.
+class MockI2CBackend : public I2CBackend {
+public:
+    MockI2CBackend();
+    void addDevice(uint8_t address, uint8_t autoIncrementFlag);
+    void setRegister(uint8_t address, uint8_t reg, uint8_t value);
+    uint8_t getRegister(uint8_t address, uint8_t reg) const;
+    void setDeferredCompletion(bool deferred);
+
+    void setStalled(bool stalled);      // Transfers never complete (lost interrupt, stuck SDA)
+
+    bool start(I2CRequest* request) override;
+    void poll() override;
+    void abort() override;
+    bool completePending();
+    uint32_t getTransferCount() const;
+
+private:
+    struct Device {
+        uint8_t address;
+        uint8_t autoIncrementFlag;
+        uint8_t registers[256];
+    };
+    Device* findDevice(uint8_t address);
+    const Device* findDevice(uint8_t address) const;
+    bool execute(I2CRequest* request);
+
+    Device devices[MOCK_I2C_MAX_DEVICES];
+    uint8_t deviceCount;
+    bool deferred;
+    bool stalled;
+    I2CRequest* pending;
+    uint32_t transferCount;
+};
+
+#endif
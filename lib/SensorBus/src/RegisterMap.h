@@ -0,0 +1,97 @@
+#ifndef RegisterMap_H
+#define RegisterMap_H
+
+#include <stdint.h>
+#include <type_traits>
+#include "SensorBus.h"
+
+// Compile-time register descriptions.
+//
+// A device map is a struct whose typedefs describe its registers (Reg), the bit
+// fields inside them (Field) and the address ranges the part auto-increments over
+// (RegBlock). Register values and burst-read plans are composed from these types in
+// constexpr code, so they cost nothing at runtime, and static_asserts reject fields
+// written to the wrong register or bursts that leave an auto-increment range.
+
+template <typename Device, uint8_t Address, uint8_t Reset = 0x00>
+struct Reg {
+    typedef Device device;
+    static constexpr uint8_t address = Address;
+    static constexpr uint8_t reset = Reset;
+};
+
+template <typename Register, uint8_t Shift, uint8_t Width = 1>
+struct Field {
+    static_assert(Width >= 1 && Shift + Width <= 8, "Field does not fit in an 8-bit register");
+
+    typedef Register reg;
+    static constexpr uint8_t shift = Shift;
+    static constexpr uint8_t width = Width;
+    static constexpr uint8_t mask = (uint8_t)(((1u << Width) - 1) << Shift);
+    static constexpr uint8_t maxValue = (uint8_t)((1u << Width) - 1);
+
+    static constexpr uint8_t encode(uint8_t value) {
+        return (uint8_t)((value << Shift) & mask);
+    }
+    static constexpr uint8_t decode(uint8_t regValue) {
+        return (uint8_t)((regValue & mask) >> Shift);
+    }
+};
+
+// Value under construction for one register, starting from its reset value
+template <typename Register>
+struct RegisterValue {
+    uint8_t value;
+
+    constexpr RegisterValue() : value(Register::reset) {}
+    constexpr explicit RegisterValue(uint8_t v) : value(v) {}
+
+    template <typename F>
+    constexpr RegisterValue<Register> set(uint8_t fieldValue) const {
+        static_assert(std::is_same<typename F::reg, Register>::value, "Field belongs to a different register");
+        return RegisterValue<Register>((uint8_t)((value & ~F::mask) | F::encode(fieldValue)));
+    }
+
+    // Start from all-zero instead of the reset value
+    static constexpr RegisterValue<Register> zero() {
+        return RegisterValue<Register>(0);
+    }
+};
+
+// Contiguous range the device auto-increments over in one burst
+template <typename Device, uint8_t First, uint8_t Last>
+struct RegBlock {
+    static_assert(Last >= First, "RegBlock range is reversed");
+    typedef Device device;
+    static constexpr uint8_t first = First;
+    static constexpr uint8_t last = Last;
+};
+
+// One burst from register First to register Last inside Block
+template <typename Block, typename First, typename Last>
+struct BurstRead {
+    static_assert(std::is_same<typename First::device, typename Block::device>::value &&
+                  std::is_same<typename Last::device, typename Block::device>::value,
+                  "Burst registers belong to a different device");
+    static_assert(Last::address >= First::address, "Burst range is reversed");
+    static_assert(First::address >= Block::first && Last::address <= Block::last,
+                  "Burst leaves the device's auto-increment range");
+    static_assert(Last::address - First::address + 1 <= SENSOR_BUS_MAX_BURST,
+                  "Burst longer than the bus transfer buffer");
+
+    static constexpr uint8_t start = First::address;
+    static constexpr uint8_t length = Last::address - First::address + 1;
+
+    // Offset of a register inside the burst buffer
+    template <typename R>
+    static constexpr uint8_t offset() {
+        static_assert(R::address >= First::address && R::address <= Last::address, "Register not covered by burst");
+        return R::address - First::address;
+    }
+
+    static constexpr BusReadPlan plan(uint8_t i2cAddress) {
+        return BusReadPlan{i2cAddress, start, length};
+    }
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "SensorBus.h"
+#include "I2CAsyncEngine.h"
+
+#ifdef ARDUINO
+#include "Wire.h"
+
+bool WireTransport::transfer(uint8_t address, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) {
+    Wire.beginTransmission(address);
+    for (uint8_t i = 0; i < txLen; i++) {
+        Wire.write(tx[i]);
+    }
+    // Keep the bus (repeated START) when a read follows
+    uint8_t result = Wire.endTransmission(rxLen == 0);
+    if (rxLen == 0) return result == 0;
+
+    uint8_t received = Wire.requestFrom(address, rxLen);
+    for (uint8_t i = 0; i < rxLen; i++) {
+        rx[i] = Wire.read();
+    }
+    return received == rxLen;
+}
+#endif
+
+SensorBus::SensorBus() {
+    transport = nullptr;
+    engine = nullptr;
+    deviceCount = 0;
+}
+
+void SensorBus::begin(I2CTransport* transport) {
+    this->transport = transport;
+}
+
+void SensorBus::attachEngine(I2CAsyncEngine* engine) {
+    this->engine = engine;
+}
+
+void SensorBus::registerDevice(uint8_t address, const char* name, uint8_t autoIncrementFlag) {
+    Device* device = findDevice(address);
+    if (device == nullptr) {
+        if (deviceCount >= SENSOR_BUS_MAX_DEVICES) return;
+        device = &devices[deviceCount++];
+        device->address = address;
+        device->stats = {0, 0, 0, 0};
+    }
+    device->name = name;
+    device->autoIncrementFlag = autoIncrementFlag;
+}
+
+SensorBus::Device* SensorBus::findDevice(uint8_t address) {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) return &devices[i];
+    }
+    return nullptr;
+}
+
+const SensorBus::Device* SensorBus::findDevice(uint8_t address) const {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        if (devices[i].address == address) return &devices[i];
+    }
+    return nullptr;
+}
+
+bool SensorBus::writeRegister(uint8_t address, uint8_t reg, uint8_t value) {
+    if (transport == nullptr) return false;
+    Device* device = findDevice(address);
+    uint8_t tx[2] = {reg, value};
+    bool ok = transport->transfer(address, tx, 2, nullptr, 0);
+    if (device != nullptr) {
+        device->stats.transactions++;
+        device->stats.bytesWritten += 2;
+        if (!ok) device->stats.errors++;
+    }
+    return ok;
+}
+
+bool SensorBus::readRegisters(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length) {
+    if (transport == nullptr || length == 0 || length > SENSOR_BUS_MAX_BURST) return false;
+    Device* device = findDevice(address);
+
+    // Multi-byte reads on MSB-increment parts need the flag in the sub-address
+    uint8_t subAddress = reg;
+    if (length > 1 && device != nullptr) subAddress |= device->autoIncrementFlag;
+
+    bool ok = transport->transfer(address, &subAddress, 1, data, length);
+    if (device != nullptr) {
+        device->stats.transactions++;
+        device->stats.bytesWritten += 1;
+        device->stats.bytesRead += length;
+        if (!ok) device->stats.errors++;
+    }
+    return ok;
+}
+
+uint8_t SensorBus::readRegister(uint8_t address, uint8_t reg) {
+    uint8_t value = 0;
+    readRegisters(address, reg, &value, 1);
+    return value;
+}
+
+bool SensorBus::probe(uint8_t address, uint8_t reg) {
+    if (transport == nullptr) return false;
+    return transport->transfer(address, &reg, 1, nullptr, 0);
+}
+
+bool SensorBus::execute(const BusReadPlan& plan, uint8_t* data) {
+    return readRegisters(plan.address, plan.startReg, data, plan.length);
+}
+
+bool SensorBus::submit(const BusReadPlan& plan, BusAsyncRead& read, I2CCallback callback, void* ctx) {
+    if (engine == nullptr || read.isBusy() || plan.length == 0 || plan.length > SENSOR_BUS_MAX_BURST) return false;
+    Device* device = findDevice(plan.address);
+
+    I2CRequest& request = read.request;
+    request.address = plan.address;
+    request.tx[0] = plan.startReg;
+    if (plan.length > 1 && device != nullptr) request.tx[0] |= device->autoIncrementFlag;
+    request.txLen = 1;
+    request.rx = read.data;
+    request.rxLen = plan.length;
+    request.callback = &SensorBus::onReadComplete;
+    request.ctx = &read;
+    read.bus = this;
+    read.callback = callback;
+    read.ctx = ctx;
+
+    if (!engine->submit(&request)) return false;
+    if (device != nullptr) {
+        device->stats.transactions++;
+        device->stats.bytesWritten += 1;
+        device->stats.bytesRead += plan.length;
+    }
+    return true;
+}
+
+// Completion of a submitted read, in the context that finished the transfer (the I2C
+// interrupt for the HAL backend): count a failure against the device, then hand over
+// to the caller's callback
+void SensorBus::onReadComplete(void* ctx, I2CRequest* request) {
+    BusAsyncRead* read = static_cast<BusAsyncRead*>(ctx);
+    if (request->state == I2C_REQUEST_FAILED) {
+        Device* device = read->bus->findDevice(request->address);
+        if (device != nullptr) device->stats.errors++;
+    }
+    if (read->callback != nullptr) read->callback(read->ctx, request);
+}
+
+BusReadPlan SensorBus::planCoveringRead(uint8_t address, const uint8_t* regs, uint8_t count) {
+    BusReadPlan plan = {address, 0, 0};
+    if (count == 0) return plan;
+
+    uint8_t lo = regs[0];
+    uint8_t hi = regs[0];
+    for (uint8_t i = 1; i < count; i++) {
+        if (regs[i] < lo) lo = regs[i];
+        if (regs[i] > hi) hi = regs[i];
+    }
+    plan.startReg = lo;
+    plan.length = hi - lo + 1;
+    return plan;
+}
+
+const BusStats* SensorBus::getStats(uint8_t address) const {
+    const Device* device = findDevice(address);
+    return device ? &device->stats : nullptr;
+}
+
+const char* SensorBus::getDeviceName(uint8_t index) const {
+    return index < deviceCount ? devices[index].name : nullptr;
+}
+
+const BusStats* SensorBus::getStatsByIndex(uint8_t index) const {
+    return index < deviceCount ? &devices[index].stats : nullptr;
+}
+
+uint8_t SensorBus::getDeviceCount() const {
+    return deviceCount;
+}
+
+void SensorBus::resetStats() {
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        devices[i].stats = {0, 0, 0, 0};
+    }
+}
+
+uint32_t SensorBus::estimateBusTimeUs(uint8_t address, uint32_t clockHz) const {
+    const Device* device = findDevice(address);
+    if (device == nullptr || clockHz == 0) return 0;
+
+    // 9 clocks per byte (8 data + ACK), plus per transaction the address byte(s) and
+    // START/STOP. Reads pay a repeated START and second address byte, so that is the
+    // overhead assumed for every transaction (an upper bound for plain writes).
+    const BusStats& s = device->stats;
+    uint64_t clocks = (uint64_t)(s.bytesRead + s.bytesWritten) * 9 + (uint64_t)s.transactions * (2 * 9 + 3);
+    return (uint32_t)(clocks * 1000000ULL / clockHz);
+}
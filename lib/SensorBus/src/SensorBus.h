@@ -0,0 +1,107 @@
+#ifndef SensorBus_H
+#define SensorBus_H
+
+#include <stdint.h>
+
+// Largest single burst. Wire on the AZ3166 buffers 32 bytes per transfer.
+#ifndef SENSOR_BUS_MAX_BURST
+#define SENSOR_BUS_MAX_BURST 32
+#endif
+
+#ifndef SENSOR_BUS_MAX_DEVICES
+#define SENSOR_BUS_MAX_DEVICES 8
+#endif
+
+class I2CAsyncEngine;
+struct BusAsyncRead;
+struct I2CRequest;
+typedef void (*I2CCallback)(void* ctx, I2CRequest* request);
+
+// Raw byte mover underneath SensorBus. One call is one bus transaction:
+// START, address+W, tx bytes, then (if rxLen > 0) repeated START, address+R, rx bytes, STOP.
+class I2CTransport {
+public:
+    virtual ~I2CTransport() {}
+    virtual bool transfer(uint8_t address, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) = 0;
+};
+
+#ifdef ARDUINO
+// Transport on top of the Arduino Wire library
+class WireTransport : public I2CTransport {
+public:
+    bool transfer(uint8_t address, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) override;
+};
+#endif
+
+// Per-device traffic counters
+struct BusStats {
+    uint32_t transactions;            // Complete START..STOP sequences
+    uint32_t bytesRead;
+    uint32_t bytesWritten;            // Includes register sub-address bytes
+    uint32_t errors;                  // NACKs / short reads
+};
+
+// One contiguous register block read in a single burst
+struct BusReadPlan {
+    uint8_t address;
+    uint8_t startReg;
+    uint8_t length;
+};
+
+// Register-level access with burst reads and per-device accounting.
+//
+// Devices declare how they auto-increment the register pointer: HTS221/LPS22HB-style
+// parts need the MSB of the sub-address set (autoIncrementFlag = 0x80), LSM6DS3/LIS2MDL
+// increment on their own once IF_INC is set (autoIncrementFlag = 0x00). Multi-byte reads
+// then cost one transaction instead of one per register.
+class SensorBus {
+public:
+    SensorBus();
+    void begin(I2CTransport* transport);
+    void attachEngine(I2CAsyncEngine* engine);
+
+    void registerDevice(uint8_t address, const char* name, uint8_t autoIncrementFlag);
+
+    bool writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t address, uint8_t reg, uint8_t* data, uint8_t length);
+    uint8_t readRegister(uint8_t address, uint8_t reg);
+    // Presence check: sets the register pointer to reg and reports the ACK (not counted)
+    bool probe(uint8_t address, uint8_t reg);
+    bool execute(const BusReadPlan& plan, uint8_t* data);
+
+    // Queue a planned read on the async engine and return immediately. Completion is
+    // visible through read.isDone(); callback (optional) runs when the transfer ends.
+    // A transfer that fails after it was queued counts as an error for its device.
+    bool submit(const BusReadPlan& plan, BusAsyncRead& read, I2CCallback callback = nullptr, void* ctx = nullptr);
+
+    // Smallest single burst covering every register in regs (for one combined read per tick)
+    static BusReadPlan planCoveringRead(uint8_t address, const uint8_t* regs, uint8_t count);
+
+    const BusStats* getStats(uint8_t address) const;
+    const char* getDeviceName(uint8_t index) const;
+    const BusStats* getStatsByIndex(uint8_t index) const;
+    uint8_t getDeviceCount() const;
+    void resetStats();
+
+    // Approximate wire time for the recorded traffic at the given SCL frequency
+    uint32_t estimateBusTimeUs(uint8_t address, uint32_t clockHz) const;
+
+private:
+    struct Device {
+        uint8_t address;
+        uint8_t autoIncrementFlag;
+        const char* name;
+        BusStats stats;
+    };
+
+    Device* findDevice(uint8_t address);
+    const Device* findDevice(uint8_t address) const;
+    static void onReadComplete(void* ctx, I2CRequest* request);
+
+    I2CTransport* transport;
+    I2CAsyncEngine* engine;
+    Device devices[SENSOR_BUS_MAX_DEVICES];
+    uint8_t deviceCount;
+};
+
+#endif
@@ -0,0 +1,279 @@
+#ifndef SensorRegisters_H
+#define SensorRegisters_H
+
+#include "RegisterMap.h"
+
+// ============================================================================
+// HTS221 - Temperature & Humidity
+// ============================================================================
+struct HTS221Map {
+    static constexpr uint8_t i2cAddress = 0x5F;
+    static constexpr uint8_t autoIncrementFlag = 0x80;   // Sub-address MSB
+    static constexpr uint8_t whoAmI = 0xBC;
+
+    typedef Reg<HTS221Map, 0x0F, 0xBC> WHO_AM_I;
+    typedef Reg<HTS221Map, 0x10, 0x1B> AV_CONF;
+    typedef Reg<HTS221Map, 0x20> CTRL_REG1;
+    typedef Reg<HTS221Map, 0x21> CTRL_REG2;
+    typedef Reg<HTS221Map, 0x22> CTRL_REG3;
+    typedef Reg<HTS221Map, 0x27> STATUS_REG;
+    typedef Reg<HTS221Map, 0x28> HUMIDITY_OUT_L;
+    typedef Reg<HTS221Map, 0x29> HUMIDITY_OUT_H;
+    typedef Reg<HTS221Map, 0x2A> TEMP_OUT_L;
+    typedef Reg<HTS221Map, 0x2B> TEMP_OUT_H;
+    typedef Reg<HTS221Map, 0x30> H0_RH_X2;
+    typedef Reg<HTS221Map, 0x31> H1_RH_X2;
+    typedef Reg<HTS221Map, 0x32> T0_DEGC_X8;
+    typedef Reg<HTS221Map, 0x33> T1_DEGC_X8;
+    typedef Reg<HTS221Map, 0x35> T1_T0_MSB;
+    typedef Reg<HTS221Map, 0x36> H0_T0_OUT_L;
+    typedef Reg<HTS221Map, 0x37> H0_T0_OUT_H;
+    typedef Reg<HTS221Map, 0x3A> H1_T0_OUT_L;
+    typedef Reg<HTS221Map, 0x3B> H1_T0_OUT_H;
+    typedef Reg<HTS221Map, 0x3C> T0_OUT_L;
+    typedef Reg<HTS221Map, 0x3D> T0_OUT_H;
+    typedef Reg<HTS221Map, 0x3E> T1_OUT_L;
+    typedef Reg<HTS221Map, 0x3F> T1_OUT_H;
+
+    typedef Field<CTRL_REG1, 7> PD;                      // Power-down control (1 = active)
+    typedef Field<CTRL_REG1, 2> BDU;                     // Block data update
+    typedef Field<CTRL_REG1, 0, 2> ODR;                  // 0 = one-shot, 1 = 1Hz, 2 = 7Hz, 3 = 12.5Hz
+    typedef Field<CTRL_REG2, 0> ONE_SHOT;
+    typedef Field<STATUS_REG, 1> H_DA;
+    typedef Field<STATUS_REG, 0> T_DA;
+
+    typedef RegBlock<HTS221Map, 0x27, 0x2B> SampleBlock;
+    typedef RegBlock<HTS221Map, 0x30, 0x3F> CalibrationBlock;
+
+    typedef BurstRead<SampleBlock, STATUS_REG, TEMP_OUT_H> SampleRead;
+    typedef BurstRead<CalibrationBlock, H0_RH_X2, T1_OUT_H> CalibrationRead;
+};
+
+// ============================================================================
+// LSM6DS3 - Accelerometer & Gyroscope
+// ============================================================================
+struct LSM6DS3Map {
+    static constexpr uint8_t i2cAddress = 0x6A;
+    static constexpr uint8_t i2cAddressAlt = 0x6B;
+    static constexpr uint8_t autoIncrementFlag = 0x00;   // IF_INC in CTRL3_C
+    static constexpr uint8_t whoAmI = 0x69;
+    static constexpr uint8_t whoAmIDsl = 0x6A;           // LSM6DSL fitted on later boards
+
+    typedef Reg<LSM6DS3Map, 0x06> FIFO_CTRL1;
+    typedef Reg<LSM6DS3Map, 0x07> FIFO_CTRL2;
+    typedef Reg<LSM6DS3Map, 0x08> FIFO_CTRL3;
+    typedef Reg<LSM6DS3Map, 0x09> FIFO_CTRL4;
+    typedef Reg<LSM6DS3Map, 0x0A> FIFO_CTRL5;
+    typedef Reg<LSM6DS3Map, 0x0D> INT1_CTRL;
+    typedef Reg<LSM6DS3Map, 0x0E> INT2_CTRL;
+    typedef Reg<LSM6DS3Map, 0x0F, 0x69> WHO_AM_I;
+    typedef Reg<LSM6DS3Map, 0x10> CTRL1_XL;
+    typedef Reg<LSM6DS3Map, 0x11> CTRL2_G;
+    typedef Reg<LSM6DS3Map, 0x12, 0x04> CTRL3_C;
+    typedef Reg<LSM6DS3Map, 0x13> CTRL4_C;
+    typedef Reg<LSM6DS3Map, 0x14> CTRL5_C;
+    typedef Reg<LSM6DS3Map, 0x15> CTRL6_C;
+    typedef Reg<LSM6DS3Map, 0x16> CTRL7_G;
+    typedef Reg<LSM6DS3Map, 0x17> CTRL8_XL;
+    typedef Reg<LSM6DS3Map, 0x18, 0x38> CTRL9_XL;
+    typedef Reg<LSM6DS3Map, 0x19, 0x38> CTRL10_C;
+    typedef Reg<LSM6DS3Map, 0x1B> WAKE_UP_SRC;
+    typedef Reg<LSM6DS3Map, 0x1C> TAP_SRC;
+    typedef Reg<LSM6DS3Map, 0x1D> D6D_SRC;
+    typedef Reg<LSM6DS3Map, 0x1E> STATUS_REG;
+    typedef Reg<LSM6DS3Map, 0x20> OUT_TEMP_L;
+    typedef Reg<LSM6DS3Map, 0x21> OUT_TEMP_H;
+    typedef Reg<LSM6DS3Map, 0x22> OUTX_L_G;
+    typedef Reg<LSM6DS3Map, 0x23> OUTX_H_G;
+    typedef Reg<LSM6DS3Map, 0x24> OUTY_L_G;
+    typedef Reg<LSM6DS3Map, 0x25> OUTY_H_G;
+    typedef Reg<LSM6DS3Map, 0x26> OUTZ_L_G;
+    typedef Reg<LSM6DS3Map, 0x27> OUTZ_H_G;
+    typedef Reg<LSM6DS3Map, 0x28> OUTX_L_XL;
+    typedef Reg<LSM6DS3Map, 0x29> OUTX_H_XL;
+    typedef Reg<LSM6DS3Map, 0x2A> OUTY_L_XL;
+    typedef Reg<LSM6DS3Map, 0x2B> OUTY_H_XL;
+    typedef Reg<LSM6DS3Map, 0x2C> OUTZ_L_XL;
+    typedef Reg<LSM6DS3Map, 0x2D> OUTZ_H_XL;
+    typedef Reg<LSM6DS3Map, 0x3A> FIFO_STATUS1;
+    typedef Reg<LSM6DS3Map, 0x3B> FIFO_STATUS2;
+    typedef Reg<LSM6DS3Map, 0x3C> FIFO_STATUS3;
+    typedef Reg<LSM6DS3Map, 0x3D> FIFO_STATUS4;
+    typedef Reg<LSM6DS3Map, 0x3E> FIFO_DATA_OUT_L;
+    typedef Reg<LSM6DS3Map, 0x3F> FIFO_DATA_OUT_H;
+    typedef Reg<LSM6DS3Map, 0x4B> STEP_COUNTER_L;
+    typedef Reg<LSM6DS3Map, 0x4C> STEP_COUNTER_H;
+    typedef Reg<LSM6DS3Map, 0x53> FUNC_SRC;
+    typedef Reg<LSM6DS3Map, 0x58> TAP_CFG;
+    typedef Reg<LSM6DS3Map, 0x59> TAP_THS_6D;
+    typedef Reg<LSM6DS3Map, 0x5B> WAKE_UP_THS;
+    typedef Reg<LSM6DS3Map, 0x5C> WAKE_UP_DUR;
+    typedef Reg<LSM6DS3Map, 0x5D> FREE_FALL;
+    typedef Reg<LSM6DS3Map, 0x5E> MD1_CFG;
+
+    typedef Field<FIFO_CTRL2, 0, 4> FTH_H;               // FIFO threshold bits [11:8]
+    typedef Field<FIFO_CTRL3, 3, 3> DEC_FIFO_GYRO;
+    typedef Field<FIFO_CTRL3, 0, 3> DEC_FIFO_XL;
+    typedef Field<FIFO_CTRL5, 3, 4> ODR_FIFO;
+    typedef Field<FIFO_CTRL5, 0, 3> FIFO_MODE;           // 0 = bypass, 6 = continuous
+    typedef Field<INT1_CTRL, 3> INT1_FTH;
+    typedef Field<INT1_CTRL, 1> INT1_DRDY_G;
+    typedef Field<INT1_CTRL, 0> INT1_DRDY_XL;
+    typedef Field<CTRL1_XL, 4, 4> ODR_XL;
+    typedef Field<CTRL1_XL, 2, 2> FS_XL;
+    typedef Field<CTRL1_XL, 0, 2> BW_XL;
+    typedef Field<CTRL2_G, 4, 4> ODR_G;
+    typedef Field<CTRL2_G, 2, 2> FS_G;
+    typedef Field<CTRL2_G, 1> FS_125;
+    typedef Field<CTRL3_C, 6> BDU;
+    typedef Field<CTRL3_C, 2> IF_INC;
+    typedef Field<CTRL3_C, 0> SW_RESET;
+    typedef Field<CTRL10_C, 4> PEDO_EN_DSL;           // LSM6DSL: pedometer enable lives here...
+    typedef Field<CTRL10_C, 3> TILT_EN_DSL;           // ...and so does tilt
+    typedef Field<CTRL10_C, 2> FUNC_EN;               // Embedded functions (pedometer, tilt)
+    typedef Field<WAKE_UP_SRC, 5> FF_IA;
+    typedef Field<WAKE_UP_SRC, 3> WU_IA;
+    typedef Field<D6D_SRC, 6> D6D_IA;
+    typedef Field<D6D_SRC, 0, 6> D6D_POSITION;        // ZH ZL YH YL XH XL
+    typedef Field<FUNC_SRC, 5> TILT_IA;
+    typedef Field<FUNC_SRC, 4> STEP_DETECTED;
+    typedef Field<TAP_CFG, 7> INTERRUPTS_ENABLE;      // LSM6DSL only (TIMER_EN on the LSM6DS3)
+    typedef Field<TAP_CFG, 6> PEDO_EN;                // LSM6DS3 only (INACT_EN on the LSM6DSL)
+    typedef Field<TAP_CFG, 5> TILT_EN;                // LSM6DS3 only (INACT_EN on the LSM6DSL)
+    typedef Field<TAP_CFG, 0> LIR;                    // Latch event sources until read
+    typedef Field<TAP_THS_6D, 5, 2> SIXD_THS;         // 0 = 80°, 1 = 70°, 2 = 60°, 3 = 50°
+    typedef Field<WAKE_UP_THS, 0, 6> WK_THS;          // LSB = full scale / 64
+    typedef Field<WAKE_UP_DUR, 7> FF_DUR5;
+    typedef Field<WAKE_UP_DUR, 5, 2> WAKE_DUR;        // ODR samples
+    typedef Field<FREE_FALL, 3, 5> FF_DUR;            // ODR samples (bit 5 in FF_DUR5)
+    typedef Field<FREE_FALL, 0, 3> FF_THS;            // 156/219/250/312/344/406/469/500 mg
+    typedef Field<MD1_CFG, 5> INT1_WU;
+    typedef Field<MD1_CFG, 4> INT1_FF;
+    typedef Field<MD1_CFG, 2> INT1_6D;
+    typedef Field<MD1_CFG, 1> INT1_TILT;
+    typedef Field<FIFO_STATUS2, 7> FTH;
+    typedef Field<FIFO_STATUS2, 6> FIFO_OVER_RUN;
+    typedef Field<FIFO_STATUS2, 5> FIFO_FULL;
+    typedef Field<FIFO_STATUS2, 4> FIFO_EMPTY;
+    typedef Field<FIFO_STATUS2, 0, 4> DIFF_FIFO_H;
+
+    typedef RegBlock<LSM6DS3Map, 0x06, 0x0A> FifoControlBlock;
+    typedef RegBlock<LSM6DS3Map, 0x10, 0x19> ControlBlock;
+    typedef RegBlock<LSM6DS3Map, 0x20, 0x2D> OutputBlock;
+    typedef RegBlock<LSM6DS3Map, 0x3A, 0x3D> FifoStatusBlock;
+    typedef RegBlock<LSM6DS3Map, 0x1B, 0x1D> EventSourceBlock;
+    typedef RegBlock<LSM6DS3Map, 0x4B, 0x53> FunctionBlock;
+
+    typedef BurstRead<OutputBlock, OUTX_L_G, OUTZ_H_XL> SampleRead;     // Gyro + accel, 12 bytes
+    typedef BurstRead<OutputBlock, OUTX_L_XL, OUTZ_H_XL> AccelRead;
+    typedef BurstRead<FifoStatusBlock, FIFO_STATUS1, FIFO_STATUS4> FifoStatusRead;
+    typedef BurstRead<EventSourceBlock, WAKE_UP_SRC, D6D_SRC> EventSourceRead;
+    typedef BurstRead<FunctionBlock, STEP_COUNTER_L, FUNC_SRC> FunctionRead;   // Steps + FUNC_SRC, 9 bytes
+};
+
+// ============================================================================
+// LPS22HB - Barometric Pressure
+// ============================================================================
+struct LPS22HBMap {
+    static constexpr uint8_t i2cAddress = 0x5C;
+    static constexpr uint8_t autoIncrementFlag = 0x00;   // IF_ADD_INC in CTRL_REG2 (default on)
+    static constexpr uint8_t whoAmI = 0xB1;
+
+    typedef Reg<LPS22HBMap, 0x0B> INTERRUPT_CFG;
+    typedef Reg<LPS22HBMap, 0x0C> THS_P_L;
+    typedef Reg<LPS22HBMap, 0x0D> THS_P_H;
+    typedef Reg<LPS22HBMap, 0x0F, 0xB1> WHO_AM_I;
+    typedef Reg<LPS22HBMap, 0x10> CTRL_REG1;
+    typedef Reg<LPS22HBMap, 0x11, 0x10> CTRL_REG2;
+    typedef Reg<LPS22HBMap, 0x12> CTRL_REG3;
+    typedef Reg<LPS22HBMap, 0x14> FIFO_CTRL;
+    typedef Reg<LPS22HBMap, 0x18> RPDS_L;
+    typedef Reg<LPS22HBMap, 0x19> RPDS_H;
+    typedef Reg<LPS22HBMap, 0x1A> RES_CONF;
+    typedef Reg<LPS22HBMap, 0x25> INT_SOURCE;
+    typedef Reg<LPS22HBMap, 0x26> FIFO_STATUS;
+    typedef Reg<LPS22HBMap, 0x27> STATUS;
+    typedef Reg<LPS22HBMap, 0x28> PRESS_OUT_XL;
+    typedef Reg<LPS22HBMap, 0x29> PRESS_OUT_L;
+    typedef Reg<LPS22HBMap, 0x2A> PRESS_OUT_H;
+    typedef Reg<LPS22HBMap, 0x2B> TEMP_OUT_L;
+    typedef Reg<LPS22HBMap, 0x2C> TEMP_OUT_H;
+    typedef Reg<LPS22HBMap, 0x33> LPFP_RES;
+
+    typedef Field<CTRL_REG1, 4, 3> ODR;                  // 0 = one-shot, 1 = 1Hz ... 5 = 75Hz
+    typedef Field<CTRL_REG1, 3> EN_LPFP;
+    typedef Field<CTRL_REG1, 2> LPFP_CFG;
+    typedef Field<CTRL_REG1, 1> BDU;
+    typedef Field<CTRL_REG2, 7> BOOT;
+    typedef Field<CTRL_REG2, 6> FIFO_EN;
+    typedef Field<CTRL_REG2, 5> STOP_ON_FTH;
+    typedef Field<CTRL_REG2, 4> IF_ADD_INC;
+    typedef Field<CTRL_REG2, 2> SWRESET;
+    typedef Field<CTRL_REG2, 0> ONE_SHOT;
+    typedef Field<CTRL_REG3, 4> F_FTH;
+    typedef Field<CTRL_REG3, 2> DRDY;
+    typedef Field<FIFO_CTRL, 5, 3> F_MODE;               // 0 = bypass, 1 = FIFO, 2 = stream
+    typedef Field<FIFO_CTRL, 0, 5> WTM;
+    typedef Field<RES_CONF, 0> LC_EN;                    // Low-current mode
+    typedef Field<FIFO_STATUS, 7> FTH_FIFO;
+    typedef Field<FIFO_STATUS, 6> OVR;
+    typedef Field<FIFO_STATUS, 0, 6> FSS;                // Stored samples
+    typedef Field<STATUS, 1> T_DA;
+    typedef Field<STATUS, 0> P_DA;
+
+    typedef RegBlock<LPS22HBMap, 0x27, 0x2C> OutputBlock;
+    typedef RegBlock<LPS22HBMap, 0x28, 0x2C> FifoOutputBlock;
+
+    typedef BurstRead<OutputBlock, STATUS, TEMP_OUT_H> SampleRead;               // Status + P + T
+    typedef BurstRead<FifoOutputBlock, PRESS_OUT_XL, TEMP_OUT_H> FifoSlotRead;   // One FIFO slot
+};
+
+// ============================================================================
+// LIS2MDL - Magnetometer
+// ============================================================================
+struct LIS2MDLMap {
+    static constexpr uint8_t i2cAddress = 0x1E;
+    static constexpr uint8_t autoIncrementFlag = 0x00;   // Always auto-increments
+    static constexpr uint8_t whoAmI = 0x40;
+
+    typedef Reg<LIS2MDLMap, 0x45> OFFSET_X_REG_L;
+    typedef Reg<LIS2MDLMap, 0x46> OFFSET_X_REG_H;
+    typedef Reg<LIS2MDLMap, 0x47> OFFSET_Y_REG_L;
+    typedef Reg<LIS2MDLMap, 0x48> OFFSET_Y_REG_H;
+    typedef Reg<LIS2MDLMap, 0x49> OFFSET_Z_REG_L;
+    typedef Reg<LIS2MDLMap, 0x4A> OFFSET_Z_REG_H;
+    typedef Reg<LIS2MDLMap, 0x4F, 0x40> WHO_AM_I;
+    typedef Reg<LIS2MDLMap, 0x60, 0x03> CFG_REG_A;
+    typedef Reg<LIS2MDLMap, 0x61> CFG_REG_B;
+    typedef Reg<LIS2MDLMap, 0x62> CFG_REG_C;
+    typedef Reg<LIS2MDLMap, 0x63, 0xE0> INT_CTRL_REG;
+    typedef Reg<LIS2MDLMap, 0x64> INT_SOURCE_REG;
+    typedef Reg<LIS2MDLMap, 0x67> STATUS_REG;
+    typedef Reg<LIS2MDLMap, 0x68> OUTX_L_REG;
+    typedef Reg<LIS2MDLMap, 0x69> OUTX_H_REG;
+    typedef Reg<LIS2MDLMap, 0x6A> OUTY_L_REG;
+    typedef Reg<LIS2MDLMap, 0x6B> OUTY_H_REG;
+    typedef Reg<LIS2MDLMap, 0x6C> OUTZ_L_REG;
+    typedef Reg<LIS2MDLMap, 0x6D> OUTZ_H_REG;
+    typedef Reg<LIS2MDLMap, 0x6E> TEMP_OUT_L_REG;
+    typedef Reg<LIS2MDLMap, 0x6F> TEMP_OUT_H_REG;
+
+    typedef Field<CFG_REG_A, 7> COMP_TEMP_EN;
+    typedef Field<CFG_REG_A, 6> REBOOT;
+    typedef Field<CFG_REG_A, 5> SOFT_RST;
+    typedef Field<CFG_REG_A, 4> LP;
+    typedef Field<CFG_REG_A, 2, 2> ODR;                  // 0 = 10Hz, 1 = 20Hz, 2 = 50Hz, 3 = 100Hz
+    typedef Field<CFG_REG_A, 0, 2> MD;                   // 0 = continuous, 1 = single, 3 = idle
+    typedef Field<CFG_REG_B, 1> OFF_CANC;
+    typedef Field<CFG_REG_B, 0> LPF;
+    typedef Field<CFG_REG_C, 4> BDU;
+    typedef Field<CFG_REG_C, 0> DRDY_ON_PIN;
+    typedef Field<STATUS_REG, 3> ZYXDA;
+
+    typedef RegBlock<LIS2MDLMap, 0x45, 0x4A> OffsetBlock;
+    typedef RegBlock<LIS2MDLMap, 0x67, 0x6F> OutputBlock;
+
+    typedef BurstRead<OutputBlock, STATUS_REG, OUTZ_H_REG> SampleRead;           // Status + XYZ
+};
+
+#endif
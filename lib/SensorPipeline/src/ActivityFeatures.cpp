@@ -0,0 +1,206 @@
+#include "ActivityFeatures.h"
+#include <math.h>
+#include <string.h>
+
+#define ACTIVITY_STANDARD_GRAVITY 9.80665f
+#define ACTIVITY_TWO_PI 6.2831853f
+#define ACTIVITY_RESUME_REPRIME_G 0.25f   // After skipped samples, gravity restarts from a sample this far off
+
+ActivityFeatureExtractor::ActivityFeatureExtractor() {
+    config.windowMs = 10000;
+    config.gravityCutoffHz = 0.3f;
+    config.minFreqHz = 0.5f;
+    config.freqStepHz = 0.1f;
+    config.minDominantG = 0.02f;
+    config.stepThresholdG = 0.12f;
+    config.minStepIntervalMs = 250;
+    memset(&pendingFeatures, 0, sizeof(pendingFeatures));
+    pending = false;
+    setSampleRate(104.0f);
+}
+
+void ActivityFeatureExtractor::begin(const ActivityConfig& config, float sampleRateHz) {
+    this->config = config;
+    setSampleRate(sampleRateHz);
+}
+
+void ActivityFeatureExtractor::setSampleRate(float sampleRateHz) {
+    this->sampleRateHz = sampleRateHz > 0.0f ? sampleRateHz : 1.0f;
+    float dt = 1.0f / this->sampleRateHz;
+    gravityAlpha = 1.0f - expf(-ACTIVITY_TWO_PI * config.gravityCutoffHz * dt);
+    for (uint8_t b = 0; b < ACTIVITY_FREQ_BINS; b++) {
+        float hz = config.minFreqHz + b * config.freqStepHz;
+        coeff[b] = 2.0f * cosf(ACTIVITY_TWO_PI * hz / this->sampleRateHz);
+    }
+    reset();
+}
+
+void ActivityFeatureExtractor::reset() {
+    primed = false;
+    resumed = false;
+    open = false;
+    gravity[0] = gravity[1] = gravity[2] = 0.0f;
+    lastAccel[0] = lastAccel[1] = lastAccel[2] = 0.0f;
+    samples = 0;
+    activeSamples = 0;
+}
+
+void ActivityFeatureExtractor::startWindow(uint32_t timestampUs) {
+    open = true;
+    startUs = timestampUs;
+    lastUs = timestampUs;
+    samples = 0;
+    activeSamples = 0;
+    smaSum = enmoSum = jerkSqSum = gyroSqSum = 0.0f;
+    for (uint8_t i = 0; i < 3; i++) {
+        mean[i] = 0.0f;
+        m2[i] = 0.0f;
+    }
+    memset(s1, 0, sizeof(s1));
+    memset(s2, 0, sizeof(s2));
+    steps = 0;
+    stepArmed = true;
+    lastStepUs = timestampUs - (uint32_t)config.minStepIntervalMs * 1000;
+}
+
+void ActivityFeatureExtractor::checkWindow(uint32_t timestampUs) {
+    if (open && timestampUs - startUs >= config.windowMs * 1000) {
+        closeWindow();
+    }
+    if (!open) {
+        startWindow(timestampUs);
+    }
+}
+
+void ActivityFeatureExtractor::addSample(const float accel[3], const float gyro[3], uint32_t timestampUs) {
+    checkWindow(timestampUs);
+
+    float a[3];
+    for (uint8_t i = 0; i < 3; i++) a[i] = accel[i] / ACTIVITY_STANDARD_GRAVITY;
+    if (!primed) {
+        memcpy(gravity, a, sizeof(gravity));
+        memcpy(lastAccel, a, sizeof(lastAccel));
+        primed = true;
+    } else if (resumed) {
+        // The skipped samples never reached the filters: lastAccel is seconds old, and
+        // gravity is the attitude from before the quiet stretch
+        memcpy(lastAccel, a, sizeof(lastAccel));
+        float offSq = 0.0f;
+        for (uint8_t i = 0; i < 3; i++) offSq += (a[i] - gravity[i]) * (a[i] - gravity[i]);
+        if (offSq > ACTIVITY_RESUME_REPRIME_G * ACTIVITY_RESUME_REPRIME_G) {
+            memcpy(gravity, a, sizeof(gravity));
+        }
+    }
+    resumed = false;
+
+    float body[3], jerkSq = 0.0f, gravityNorm = 0.0f, norm = 0.0f, sma = 0.0f;
+    for (uint8_t i = 0; i < 3; i++) {
+        gravity[i] += gravityAlpha * (a[i] - gravity[i]);
+        body[i] = a[i] - gravity[i];
+        sma += fabsf(body[i]);
+        float d = a[i] - lastAccel[i];
+        jerkSq += d * d;
+        lastAccel[i] = a[i];
+        gravityNorm += gravity[i] * gravity[i];
+        norm += a[i] * a[i];
+
+        // Welford per axis
+        float delta = a[i] - mean[i];
+        mean[i] += delta / (activeSamples + 1);
+        m2[i] += delta * (a[i] - mean[i]);
+    }
+    gravityNorm = sqrtf(gravityNorm);
+    float enmo = sqrtf(norm) - 1.0f;
+
+    smaSum += sma;
+    enmoSum += enmo > 0.0f ? enmo : 0.0f;
+    jerkSqSum += jerkSq * sampleRateHz * sampleRateHz;
+    gyroSqSum += gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2];
+
+    // Body acceleration along gravity, whatever way up the board is
+    float vertical = 0.0f;
+    if (gravityNorm > 0.0f) {
+        vertical = (body[0] * gravity[0] + body[1] * gravity[1] + body[2] * gravity[2]) / gravityNorm;
+    }
+    for (uint8_t b = 0; b < ACTIVITY_FREQ_BINS; b++) {
+        float s = vertical + coeff[b] * s1[b] - s2[b];
+        s2[b] = s1[b];
+        s1[b] = s;
+    }
+
+    if (stepArmed && vertical > config.stepThresholdG &&
+        timestampUs - lastStepUs >= (uint32_t)config.minStepIntervalMs * 1000) {
+        steps++;
+        lastStepUs = timestampUs;
+        stepArmed = false;
+    } else if (!stepArmed && vertical < 0.0f) {
+        stepArmed = true;
+    }
+
+    samples++;
+    activeSamples++;
+    lastUs = timestampUs;
+}
+
+void ActivityFeatureExtractor::addQuiet(uint16_t count, uint32_t timestampUs) {
+    if (count == 0) return;
+    checkWindow(timestampUs);
+    samples += count;
+    lastUs = timestampUs;
+    resumed = true;
+}
+
+void ActivityFeatureExtractor::closeWindow() {
+    open = false;
+    if (samples == 0) return;
+
+    ActivityFeatures& f = pendingFeatures;
+    float n = (float)samples;
+    f.startUs = startUs;
+    f.durationMs = (uint32_t)(samples * 1000.0f / sampleRateHz + 0.5f);
+    f.samples = samples;
+    f.activeSamples = activeSamples;
+    f.sma = smaSum / n;
+    f.enmo = enmoSum / n;
+    f.jerkRms = sqrtf(jerkSqSum / n);
+    f.gyroRms = sqrtf(gyroSqSum / n);
+    for (uint8_t i = 0; i < 3; i++) {
+        f.variance[i] = activeSamples > 1 ? m2[i] / (activeSamples - 1) : 0.0f;
+    }
+
+    // Goertzel power per bin; the amplitude of a sine that fills the window is 2*sqrt(P)/N
+    float total = 0.0f, best = 0.0f;
+    uint8_t bestBin = 0;
+    for (uint8_t b = 0; b < ACTIVITY_FREQ_BINS; b++) {
+        float power = s1[b] * s1[b] + s2[b] * s2[b] - coeff[b] * s1[b] * s2[b];
+        if (power < 0.0f) power = 0.0f;
+        total += power;
+        if (power > best) {
+            best = power;
+            bestBin = b;
+        }
+    }
+    float amplitude = activeSamples > 0 ? 2.0f * sqrtf(best) / activeSamples : 0.0f;
+    bool periodic = activeSamples * 2 >= samples && amplitude >= config.minDominantG && total > 0.0f;
+    f.dominantHz = periodic ? config.minFreqHz + bestBin * config.freqStepHz : 0.0f;
+    f.dominantShare = periodic ? best / total : 0.0f;
+
+    f.steps = steps;
+    f.cadence = f.durationMs > 0 ? steps * 60000.0f / f.durationMs : 0.0f;
+    pending = true;
+}
+
+bool ActivityFeatureExtractor::poll(ActivityFeatures& features) {
+    if (!pending) return false;
+    features = pendingFeatures;
+    pending = false;
+    return true;
+}
+
+const ActivityConfig& ActivityFeatureExtractor::getConfig() const {
+    return config;
+}
+
+float ActivityFeatureExtractor::getSampleRate() const {
+    return sampleRateHz;
+}
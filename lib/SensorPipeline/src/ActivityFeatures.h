@@ -0,0 +1,104 @@
+#ifndef ActivityFeatures_H
+#define ActivityFeatures_H
+
+#include <stdint.h>
+
+// Frequencies scanned for the dominant motion component
+#define ACTIVITY_FREQ_BINS 36
+
+struct ActivityConfig {
+    uint32_t windowMs;                // Feature window
+    float gravityCutoffHz;            // Low-pass that separates gravity from body motion
+    float minFreqHz;                  // Lowest scanned frequency...
+    float freqStepHz;                 // ...and the spacing of the ACTIVITY_FREQ_BINS bins
+    float minDominantG;               // Amplitude below which no dominant frequency is reported
+    float stepThresholdG;             // Vertical body acceleration peak that counts as a step
+    uint16_t minStepIntervalMs;       // Steps closer than this are one step
+};
+
+// Features of one closed window; accelerations in g
+struct ActivityFeatures {
+    uint32_t startUs;                 // First sample of the window
+    uint32_t durationMs;
+    uint16_t samples;                 // Samples the window covered...
+    uint16_t activeSamples;           // ...and how many were analysed (the rest came while quiet)
+    float sma;                        // Signal magnitude area: mean |x|+|y|+|z| of body acceleration
+    float enmo;                       // Euclidean norm minus one, negatives clipped, mean
+    float jerkRms;                    // g/s
+    float variance[3];                // Per-axis accelerometer variance, g²
+    float gyroRms;                    // degrees/s
+    float dominantHz;                 // Strongest scanned component of vertical acceleration, 0 if none
+    float dominantShare;              // Its share of the scanned power (0..1)
+    uint16_t steps;
+    float cadence;                    // Steps per minute
+};
+
+// Windowed activity features over the full-rate IMU stream.
+//
+// Gravity is tracked with a first-order low-pass per axis, so body acceleration and the
+// vertical direction do not assume the board lies flat. Every statistic is a running
+// sum or a Welford update, and the frequency scan is a Goertzel bank over the vertical
+// body acceleration, so a sample costs O(ACTIVITY_FREQ_BINS) and a window needs no
+// sample buffer. Steps are vertical peaks above stepThresholdG, re-armed at zero.
+// Samples are assumed evenly spaced at the rate given to begin().
+class ActivityFeatureExtractor {
+public:
+    ActivityFeatureExtractor();
+    void begin(const ActivityConfig& config, float sampleRateHz);
+    void setSampleRate(float sampleRateHz);
+    void reset();
+
+    // Accelerometer in m/s², gyroscope in degrees/s
+    void addSample(const float accel[3], const float gyro[3], uint32_t timestampUs);
+
+    // Samples the caller skipped because the sensor reported no motion; they count as
+    // still in the window's means and are left out of its variances and frequency scan.
+    // The next addSample() restarts the jerk difference, and the gravity estimate if the
+    // board turned meanwhile.
+    void addQuiet(uint16_t count, uint32_t timestampUs);
+
+    // Takes the newest closed window, if one is waiting
+    bool poll(ActivityFeatures& features);
+
+    const ActivityConfig& getConfig() const;
+    float getSampleRate() const;
+
+private:
+    void startWindow(uint32_t timestampUs);
+    void closeWindow();
+    void checkWindow(uint32_t timestampUs);
+
+    ActivityConfig config;
+    float sampleRateHz;
+    float gravityAlpha;
+    float coeff[ACTIVITY_FREQ_BINS];
+
+    // Filter state, kept across windows
+    bool primed;
+    bool resumed;                     // addQuiet() since the last sample: filter state is stale
+    float gravity[3];
+    float lastAccel[3];
+
+    // Window accumulators
+    bool open;
+    uint32_t startUs;
+    uint32_t lastUs;
+    uint16_t samples;
+    uint16_t activeSamples;
+    float smaSum;
+    float enmoSum;
+    float jerkSqSum;
+    float gyroSqSum;
+    float mean[3];
+    float m2[3];
+    float s1[ACTIVITY_FREQ_BINS];
+    float s2[ACTIVITY_FREQ_BINS];
+    uint16_t steps;
+    bool stepArmed;
+    uint32_t lastStepUs;
+
+    ActivityFeatures pendingFeatures;
+    bool pending;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "AlertRules.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+AlertRuleEngine::AlertRuleEngine() {
+    ruleCount = 0;
+    memset(rules, 0, sizeof(rules));
+    memset(counts, 0, sizeof(counts));
+    memset(clearCounts, 0, sizeof(clearCounts));
+    memset(firing, 0, sizeof(firing));
+    groupMask = 0;
+    memset(groupCounts, 0, sizeof(groupCounts));
+    score = 0;
+}
+
+bool AlertRuleEngine::load(const AlertRule* rules, uint8_t count, uint8_t inputCount) {
+    if (count > ALERT_RULES_MAX) return false;
+    for (uint8_t i = 0; i < count; i++) {
+        const AlertRule& r = rules[i];
+        if (r.input >= inputCount || r.comparator > ALERT_BELOW ||
+            r.group >= ALERT_GROUPS_MAX || r.consecutive == 0 || r.hysteresis < 0.0f) {
+            return false;
+        }
+    }
+    memcpy(this->rules, rules, count * sizeof(AlertRule));
+    ruleCount = count;
+    memset(counts, 0, sizeof(counts));
+    memset(clearCounts, 0, sizeof(clearCounts));
+    memset(firing, 0, sizeof(firing));
+    groupMask = 0;
+    memset(groupCounts, 0, sizeof(groupCounts));
+    score = 0;
+    return true;
+}
+
+bool AlertRuleEngine::parse(const char* text, AlertRule* rules, uint8_t& count, uint8_t maxRules) {
+    count = 0;
+    const char* p = text;
+    while (*p) {
+        while (*p == ' ' || *p == ';') p++;
+        if (!*p) break;
+        if (count >= maxRules) return false;
+
+        AlertRule r;
+        char* end;
+        long input = strtol(p, &end, 10);
+        if (end == p || *end != ',') return false;
+        p = end + 1;
+        while (*p == ' ') p++;
+        if (*p == '>') r.comparator = ALERT_ABOVE;
+        else if (*p == '<') r.comparator = ALERT_BELOW;
+        else return false;
+        p++;
+        if (*p++ != ',') return false;
+
+        float fields[2];
+        for (uint8_t f = 0; f < 2; f++) {
+            fields[f] = strtof(p, &end);
+            if (end == p || *end != ',') return false;
+            p = end + 1;
+        }
+        // consecutive, weight, group and the optional release
+        long ints[4] = {0, 0, 0, 0};
+        for (uint8_t f = 0; f < 4; f++) {
+            ints[f] = strtol(p, &end, 10);
+            if (end == p || ints[f] < 0 || ints[f] > 255) return false;
+            p = end;
+            if (f == 2 && *p != ',') break;
+            if (f < 3) {
+                if (*p != ',') return false;
+                p++;
+            }
+        }
+        while (*p == ' ') p++;
+        if (*p && *p != ';') return false;
+        if (input < 0 || input > 255) return false;
+
+        r.input = (uint8_t)input;
+        r.threshold = fields[0];
+        r.hysteresis = fields[1];
+        r.consecutive = (uint8_t)ints[0];
+        r.weight = (uint8_t)ints[1];
+        r.group = (uint8_t)ints[2];
+        r.release = (uint8_t)ints[3];
+        rules[count++] = r;
+    }
+    return count > 0;
+}
+
+void AlertRuleEngine::evaluate(const float* values, uint8_t valueCount) {
+    uint8_t weights[ALERT_GROUPS_MAX] = {0};
+    memset(groupCounts, 0, sizeof(groupCounts));
+    groupMask = 0;
+
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        const AlertRule& r = rules[i];
+        if (r.input >= valueCount) continue;
+        float v = values[r.input];
+
+        // NaN means the input has no reading (sensor absent): the rule keeps its state
+        if (!isnan(v)) {
+            // While firing, the threshold moves back by the hysteresis
+            float limit = r.threshold;
+            if (firing[i]) limit += (r.comparator == ALERT_ABOVE) ? -r.hysteresis : r.hysteresis;
+            bool beyond = (r.comparator == ALERT_ABOVE) ? (v > limit) : (v < limit);
+
+            if (beyond) {
+                if (counts[i] < UINT16_MAX) counts[i]++;
+                clearCounts[i] = 0;
+                if (counts[i] >= r.consecutive) firing[i] = true;
+            } else {
+                counts[i] = 0;
+                if (firing[i]) {
+                    uint8_t release = r.release ? r.release : r.consecutive;
+                    if (++clearCounts[i] >= release) {
+                        firing[i] = false;
+                        clearCounts[i] = 0;
+                    }
+                }
+            }
+        }
+
+        if (counts[i] > groupCounts[r.group]) groupCounts[r.group] = counts[i];
+        if (firing[i]) {
+            groupMask |= (uint8_t)(1u << r.group);
+            if (r.weight > weights[r.group]) weights[r.group] = r.weight;
+        }
+    }
+
+    uint16_t total = 0;
+    for (uint8_t g = 0; g < ALERT_GROUPS_MAX; g++) total += weights[g];
+    score = total > 255 ? 255 : (uint8_t)total;
+}
+
+bool AlertRuleEngine::isGroupActive(uint8_t group) const {
+    return group < ALERT_GROUPS_MAX && (groupMask & (1u << group));
+}
+
+uint16_t AlertRuleEngine::getGroupCount(uint8_t group) const {
+    return group < ALERT_GROUPS_MAX ? groupCounts[group] : 0;
+}
+
+uint8_t AlertRuleEngine::getScore() const {
+    return score;
+}
+
+uint8_t AlertRuleEngine::getRuleCount() const {
+    return ruleCount;
+}
+
+const AlertRule& AlertRuleEngine::getRule(uint8_t index) const {
+    return rules[index < ruleCount ? index : 0];
+}
+
+bool AlertRuleEngine::format(char* text, size_t size) const {
+    if (size == 0) return false;
+    size_t len = 0;
+    text[0] = '\0';
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        const AlertRule& r = rules[i];
+        int n = snprintf(text + len, size - len, "%s%u,%c,%g,%g,%u,%u,%u",
+                         i ? ";" : "", r.input, r.comparator == ALERT_ABOVE ? '>' : '<',
+                         r.threshold, r.hysteresis, r.consecutive, r.weight, r.group);
+        if (n < 0 || (size_t)n >= size - len) return false;
+        len += n;
+        if (r.release) {
+            n = snprintf(text + len, size - len, ",%u", r.release);
+            if (n < 0 || (size_t)n >= size - len) return false;
+            len += n;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef AlertRules_H
+#define AlertRules_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Upper bounds for a loaded table
+#ifndef ALERT_RULES_MAX
+#define ALERT_RULES_MAX 16
+#endif
+#define ALERT_GROUPS_MAX 8
+
+enum AlertComparator {
+    ALERT_ABOVE = 0,                  // Fires while input > threshold
+    ALERT_BELOW                       // Fires while input < threshold
+};
+
+// One threshold rule. Plain data so tables can be constexpr, copied and parsed.
+struct AlertRule {
+    float threshold;
+    float hysteresis;                 // Once firing, holds until the input is this far back
+    uint8_t input;                    // Index into the values passed to evaluate()
+    uint8_t comparator;               // AlertComparator
+    uint8_t consecutive;              // Evaluations in a row beyond the threshold before it fires
+    uint8_t weight;                   // Score contributed by its group while firing
+    uint8_t group;                    // Rules that raise the same alert share a group
+    uint8_t release;                  // Evaluations in a row back inside before it clears (0 = consecutive)
+};
+
+// Threshold rules evaluated in one pass over a flat table.
+//
+// Each rule counts consecutive evaluations beyond its threshold and fires once the count
+// reaches `consecutive` (enter dwell). While firing the threshold moves back by the
+// hysteresis, and the rule only clears after `release` evaluations in a row back inside
+// it (exit dwell), so one quiet evaluation does not end an alert. A group is active while
+// any of its rules fires, and contributes the largest weight among its firing rules to
+// the score. Tables are replaced at runtime with load(); the text form used over serial
+// and from the proxy is
+//   input,op,threshold,hysteresis,consecutive,weight,group[,release];...   (op is > or <)
+class AlertRuleEngine {
+public:
+    AlertRuleEngine();
+
+    // Validates and copies the table; counters restart. False leaves the old table in place.
+    bool load(const AlertRule* rules, uint8_t count, uint8_t inputCount);
+    static bool parse(const char* text, AlertRule* rules, uint8_t& count, uint8_t maxRules);
+
+    void evaluate(const float* values, uint8_t valueCount);
+
+    bool isGroupActive(uint8_t group) const;
+    uint16_t getGroupCount(uint8_t group) const;    // Longest current run in the group
+    uint8_t getScore() const;
+
+    uint8_t getRuleCount() const;
+    const AlertRule& getRule(uint8_t index) const;
+
+    // Writes the table back in text form; returns false if it did not fit
+    bool format(char* text, size_t size) const;
+
+private:
+    AlertRule rules[ALERT_RULES_MAX];
+    uint8_t ruleCount;
+
+    uint16_t counts[ALERT_RULES_MAX];
+    uint16_t clearCounts[ALERT_RULES_MAX];
+    bool firing[ALERT_RULES_MAX];
+
+    uint8_t groupMask;
+    uint16_t groupCounts[ALERT_GROUPS_MAX];
+    uint8_t score;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#include "BandStateMachine.h"
+#include <string.h>
+
+BandStateMachine::BandStateMachine() {
+    memset(&config, 0, sizeof(config));
+    reset();
+}
+
+void BandStateMachine::begin(const BandConfig& config) {
+    this->config = config;
+    if (this->config.boundaryCount > BAND_MAX - 1) this->config.boundaryCount = BAND_MAX - 1;
+    if (this->config.hysteresis < 0.0f) this->config.hysteresis = 0.0f;
+    reset();
+}
+
+void BandStateMachine::reset() {
+    started = false;
+    band = 0;
+    previousLevel = 0;
+    pending = false;
+    pendingBand = 0;
+    pendingSinceMs = 0;
+}
+
+void BandStateMachine::setBoundary(uint8_t index, float value) {
+    if (index >= config.boundaryCount) return;
+    if (index > 0 && value < config.boundaries[index - 1]) value = config.boundaries[index - 1];
+    if (index + 1 < config.boundaryCount && value > config.boundaries[index + 1]) value = config.boundaries[index + 1];
+    config.boundaries[index] = value;
+}
+
+float BandStateMachine::getBoundary(uint8_t index) const {
+    return index < config.boundaryCount ? config.boundaries[index] : 0.0f;
+}
+
+uint8_t BandStateMachine::bandOf(float value) const {
+    uint8_t b = 0;
+    while (b < config.boundaryCount && value > config.boundaries[b]) b++;
+    return b;
+}
+
+bool BandStateMachine::update(float value, uint32_t nowMs) {
+    if (!started) {
+        band = bandOf(value);
+        previousLevel = config.levels[band];
+        started = true;
+        return false;
+    }
+
+    // The value has to clear the edge by the hysteresis before another band is a candidate
+    uint8_t candidate = bandOf(value);
+    if (candidate > band) {
+        candidate = bandOf(value - config.hysteresis);
+        if (candidate < band) candidate = band;
+    } else if (candidate < band) {
+        candidate = bandOf(value + config.hysteresis);
+        if (candidate > band) candidate = band;
+    }
+
+    if (candidate == band) {
+        pending = false;
+        return false;
+    }
+
+    uint8_t level = config.levels[band];
+    uint8_t candidateLevel = config.levels[candidate];
+    if (candidateLevel == level) {
+        // Same level on the other side of an edge: nothing to report or wait for
+        band = candidate;
+        pending = false;
+        return false;
+    }
+
+    // The dwell runs while the value stays on the same side; it may move between bands there
+    if (!pending || (pendingBand > band) != (candidate > band)) {
+        pending = true;
+        pendingSinceMs = nowMs;
+    }
+    pendingBand = candidate;
+    uint32_t dwell = candidateLevel > level ? config.enterDwellMs : config.exitDwellMs;
+    if (nowMs - pendingSinceMs < dwell) {
+        return false;
+    }
+
+    previousLevel = level;
+    band = candidate;
+    pending = false;
+    return true;
+}
+
+bool BandStateMachine::isStarted() const {
+    return started;
+}
+
+uint8_t BandStateMachine::getLevel() const {
+    return config.levels[band];
+}
+
+uint8_t BandStateMachine::getPreviousLevel() const {
+    return previousLevel;
+}
+
+uint8_t BandStateMachine::getBand() const {
+    return band;
+}
@@ -0,0 +1,59 @@
+#ifndef BandStateMachine_H
+#define BandStateMachine_H
+
+#include <stdint.h>
+
+// Upper bound on bands (boundaries + 1) per channel
+#define BAND_MAX 6
+
+// Bands are split by ascending boundaries (a value equal to a boundary stays below it);
+// each band maps to a level, so two-sided ranges (too cold / comfortable / too hot)
+// reuse a level on both ends.
+struct BandConfig {
+    float boundaries[BAND_MAX - 1];
+    uint8_t levels[BAND_MAX];
+    uint8_t boundaryCount;
+    float hysteresis;                 // Distance past a boundary before the band can change
+    uint32_t enterDwellMs;            // A higher level must hold this long before it is taken
+    uint32_t exitDwellMs;             // ... and a lower one this long
+};
+
+// Hysteresis state machine over one channel's bands.
+//
+// A value has to clear a boundary by `hysteresis` to become a candidate band, and the
+// candidate has to persist for the dwell time of its direction before the level
+// changes, so a signal sitting on an edge does not flap. update() reports only real
+// level changes; the caller turns them into events.
+class BandStateMachine {
+public:
+    BandStateMachine();
+    void begin(const BandConfig& config);
+    void reset();
+
+    // Move one edge, e.g. one that follows a tracked background level. It is kept between
+    // its neighbours; the current band stays until the next update() decides otherwise.
+    void setBoundary(uint8_t index, float value);
+    float getBoundary(uint8_t index) const;
+
+    // True when the level changed; getPreviousLevel() then holds the old one
+    bool update(float value, uint32_t nowMs);
+
+    bool isStarted() const;
+    uint8_t getLevel() const;
+    uint8_t getPreviousLevel() const;
+    uint8_t getBand() const;
+
+private:
+    uint8_t bandOf(float value) const;
+
+    BandConfig config;
+    bool started;
+    uint8_t band;
+    uint8_t previousLevel;
+
+    bool pending;
+    uint8_t pendingBand;
+    uint32_t pendingSinceMs;
+};
+
+#endif
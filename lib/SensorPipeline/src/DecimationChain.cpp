@@ -0,0 +1,164 @@
+#include "DecimationChain.h"
+#include <string.h>
+
+DecimationChain::DecimationChain() {
+    memset(&config, 0, sizeof(config));
+    config.passband = 0.8f;
+    config.tapsPerFactor = 4;
+    inputRateHz = 0.0f;
+    channels = 0;
+    active = false;
+    primed = false;
+}
+
+bool DecimationChain::begin(const DecimationConfig& config, float inputRateHz, uint8_t channels) {
+    active = false;
+    if (config.stages == 0 || config.stages > DECIMATION_MAX_STAGES) return false;
+    if (channels == 0 || channels > DECIMATION_MAX_CHANNELS || inputRateHz <= 0.0f) return false;
+    this->config = config;
+    this->inputRateHz = inputRateHz;
+    this->channels = channels;
+
+    float rate = inputRateHz;
+    for (uint8_t s = 0; s < config.stages; s++) {
+        Stage& st = stage[s];
+        if (config.rateHz[s] <= 0.0f) return false;
+        uint32_t factor = (uint32_t)(rate / config.rateHz[s] + 0.5f);
+        if (factor < 1 || factor > DECIMATION_BLOCK) return false;
+        st.factor = (uint8_t)factor;
+        st.rateHz = rate / factor;
+
+        if (factor > 1) {
+            uint32_t taps = config.taps[s] ? config.taps[s] : (uint32_t)config.tapsPerFactor * factor + 1;
+            if (taps > DECIMATION_MAX_TAPS) taps = DECIMATION_MAX_TAPS;
+            st.taps = (uint8_t)taps;
+            dspDesignLowpassFir(config.passband * 0.5f * st.rateHz, rate, st.taps, st.coeffs);
+            for (uint8_t c = 0; c < channels; c++) {
+                dspFirDecimateInit(st.fir[c], st.taps, st.factor, st.coeffs, st.state[c],
+                                   DECIMATION_BLOCK - DECIMATION_BLOCK % factor);
+            }
+        } else {
+            st.taps = 0;
+        }
+        rate = st.rateHz;
+    }
+
+    active = true;
+    reset();
+    return true;
+}
+
+void DecimationChain::reset() {
+    primed = false;
+    for (uint8_t s = 0; s < config.stages; s++) {
+        stage[s].fill = 0;
+        stage[s].outputs = 0;
+    }
+}
+
+// Fill every filter's history with the first sample, as if the input had always been
+// at that level
+void DecimationChain::prime(const int16_t* const* in) {
+    for (uint8_t s = 0; s < config.stages; s++) {
+        Stage& st = stage[s];
+        for (uint8_t c = 0; c < channels; c++) {
+            if (st.taps > 1) {
+                for (uint8_t i = 0; i < st.taps - 1; i++) st.state[c][i] = in[c][0];
+            }
+            st.newest[c] = in[c][0];
+        }
+    }
+    primed = true;
+}
+
+void DecimationChain::process(const int16_t* const* in, uint16_t n) {
+    if (!active || n == 0) return;
+    if (!primed) prime(in);
+    push(0, in, n);
+}
+
+void DecimationChain::push(uint8_t s, const int16_t* const* in, uint16_t n) {
+    Stage& st = stage[s];
+    bool last = s + 1 >= config.stages;
+
+    if (st.factor == 1) {
+        for (uint8_t c = 0; c < channels; c++) st.newest[c] = in[c][n - 1];
+        st.outputs += n;
+        if (!last) push(s + 1, in, n);
+        return;
+    }
+
+    uint16_t block = DECIMATION_BLOCK - DECIMATION_BLOCK % st.factor;
+    uint16_t used = 0;
+    while (used < n) {
+        uint16_t take = n - used;
+        if (take > block - st.fill) take = block - st.fill;
+        for (uint8_t c = 0; c < channels; c++) {
+            memcpy(st.pending[c] + st.fill, in[c] + used, take * sizeof(int16_t));
+        }
+        st.fill += take;
+        used += take;
+
+        uint16_t ready = st.fill - st.fill % st.factor;
+        if (ready == 0) continue;
+
+        const int16_t* out[DECIMATION_MAX_CHANNELS];
+        uint16_t produced = 0;
+        for (uint8_t c = 0; c < channels; c++) {
+            produced = dspFirDecimateQ15(st.fir[c], st.pending[c], st.output[c], ready);
+            st.newest[c] = st.output[c][produced - 1];
+            out[c] = st.output[c];
+            memmove(st.pending[c], st.pending[c] + ready, (st.fill - ready) * sizeof(int16_t));
+        }
+        st.fill -= ready;
+        st.outputs += produced;
+        if (!last) push(s + 1, out, produced);
+    }
+}
+
+bool DecimationChain::latest(uint8_t stage, int16_t* values) const {
+    if (!active || !primed || stage >= config.stages) return false;
+    memcpy(values, this->stage[stage].newest, channels * sizeof(int16_t));
+    return true;
+}
+
+const DecimationConfig& DecimationChain::getConfig() const {
+    return config;
+}
+
+bool DecimationChain::isActive() const {
+    return active;
+}
+
+uint8_t DecimationChain::getStages() const {
+    return active ? config.stages : 0;
+}
+
+float DecimationChain::getInputRateHz() const {
+    return inputRateHz;
+}
+
+float DecimationChain::getRateHz(uint8_t stage) const {
+    return stage < config.stages ? this->stage[stage].rateHz : 0.0f;
+}
+
+uint8_t DecimationChain::getFactor(uint8_t stage) const {
+    return stage < config.stages ? this->stage[stage].factor : 0;
+}
+
+uint8_t DecimationChain::getTaps(uint8_t stage) const {
+    return stage < config.stages ? this->stage[stage].taps : 0;
+}
+
+uint32_t DecimationChain::getOutputCount(uint8_t stage) const {
+    return stage < config.stages ? this->stage[stage].outputs : 0;
+}
+
+uint32_t DecimationChain::getMacsPerSecond() const {
+    if (!active) return 0;
+    float macs = 0.0f;
+    for (uint8_t s = 0; s < config.stages; s++) {
+        macs += (float)stage[s].taps * stage[s].rateHz * channels;
+    }
+    return (uint32_t)(macs + 0.5f);
+}
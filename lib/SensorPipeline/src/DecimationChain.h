@@ -0,0 +1,82 @@
+#ifndef DecimationChain_H
+#define DecimationChain_H
+
+#include <stdint.h>
+#include "DspKernels.h"
+
+#define DECIMATION_MAX_STAGES 4
+#define DECIMATION_MAX_CHANNELS 7
+#define DECIMATION_MAX_TAPS 64
+#define DECIMATION_BLOCK 32             // Samples a stage filters per call; also the largest factor
+
+struct DecimationConfig {
+    uint8_t stages;
+    float rateHz[DECIMATION_MAX_STAGES];  // Output rate of each stage, each an integer fraction of the one before
+    float passband;                   // FIR cutoff as a fraction of the stage's output Nyquist
+    uint8_t tapsPerFactor;            // FIR length is tapsPerFactor * factor + 1 (capped at DECIMATION_MAX_TAPS)...
+    uint8_t taps[DECIMATION_MAX_STAGES];  // ...unless a stage's length is given here (0 = derive it)
+};
+
+// Multi-stage anti-alias decimation of a few Q15 channels.
+//
+// Each stage is a Hamming-windowed FIR low-pass that only computes the outputs it keeps
+// (the polyphase saving: cost scales with the output rate, not the input rate), run on
+// the DspKernels decimator. Splitting a large ratio into stages keeps every FIR short:
+// early stages only have to stop what would alias into the final passband. A stage that
+// is read needs a sharp cut at its own Nyquist; set its length in taps[], ideally on a
+// small factor at the end of the chain where the input rate is lowest. A stage with
+// factor 1 passes samples through. Blocks may be any length; a stage keeps the samples
+// short of a whole factor for the next call. Filters start primed with the first
+// sample, so the outputs have no start-up ramp.
+class DecimationChain {
+public:
+    DecimationChain();
+
+    // Factors follow from the input rate and the configured output rates; false if a
+    // ratio is below 1 or above DECIMATION_BLOCK (add an intermediate stage)
+    bool begin(const DecimationConfig& config, float inputRateHz, uint8_t channels);
+    void reset();
+
+    // One block of planar samples: in[c][0..n-1] for every channel
+    void process(const int16_t* const* in, uint16_t n);
+
+    // Newest output of a stage, one value per channel; false before the first input
+    bool latest(uint8_t stage, int16_t* values) const;
+
+    const DecimationConfig& getConfig() const;
+    bool isActive() const;
+    uint8_t getStages() const;
+    float getInputRateHz() const;
+    float getRateHz(uint8_t stage) const;   // Actual rate, after rounding the factor
+    uint8_t getFactor(uint8_t stage) const;
+    uint8_t getTaps(uint8_t stage) const;
+    uint32_t getOutputCount(uint8_t stage) const;
+    uint32_t getMacsPerSecond() const;      // Multiply-accumulates per second, all stages and channels
+
+private:
+    struct Stage {
+        uint8_t factor;
+        uint8_t taps;
+        float rateHz;
+        int16_t coeffs[DECIMATION_MAX_TAPS];
+        DspFirDecimatorQ15 fir[DECIMATION_MAX_CHANNELS];
+        int16_t state[DECIMATION_MAX_CHANNELS][DECIMATION_MAX_TAPS - 1 + DECIMATION_BLOCK];
+        int16_t pending[DECIMATION_MAX_CHANNELS][DECIMATION_BLOCK];
+        int16_t output[DECIMATION_MAX_CHANNELS][DECIMATION_BLOCK / 2];
+        int16_t newest[DECIMATION_MAX_CHANNELS];
+        uint16_t fill;
+        uint32_t outputs;
+    };
+
+    void prime(const int16_t* const* in);
+    void push(uint8_t s, const int16_t* const* in, uint16_t n);
+
+    DecimationConfig config;
+    float inputRateHz;
+    uint8_t channels;
+    bool active;
+    bool primed;
+    Stage stage[DECIMATION_MAX_STAGES];
+};
+
+#endif
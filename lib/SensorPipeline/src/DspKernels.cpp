@@ -0,0 +1,190 @@
+#include "DspKernels.h"
+#include <math.h>
+
+#define DSP_PI 3.14159265f
+
+int64_t dspDotQ15(const int16_t* a, const int16_t* b, uint16_t n) {
+    int64_t acc0 = 0, acc1 = 0;
+    uint16_t i = 0;
+    // Two accumulators so consecutive SMLALDs don't wait on each other
+    for (; i + 4 <= n; i += 4) {
+        acc0 = dspSmlald(dspRead2(a + i), dspRead2(b + i), acc0);
+        acc1 = dspSmlald(dspRead2(a + i + 2), dspRead2(b + i + 2), acc1);
+    }
+    for (; i + 2 <= n; i += 2) {
+        acc0 = dspSmlald(dspRead2(a + i), dspRead2(b + i), acc0);
+    }
+    if (i < n) acc1 += (int32_t)a[i] * b[i];
+    return acc0 + acc1;
+}
+
+void dspAddQ15(const int16_t* a, const int16_t* b, int16_t* out, uint16_t n) {
+    uint16_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        dspWrite2(out + i, dspQadd16(dspRead2(a + i), dspRead2(b + i)));
+    }
+    if (i < n) out[i] = dspSsat16((int32_t)a[i] + b[i]);
+}
+
+// floor(sqrt(v)). VSQRT on the M4F is one instruction against 16 rounds bit by bit.
+// Rounding v to float and the root back lands at most one off either way for the
+// sums here (up to 3·2^30), so one integer step makes it exact.
+static uint32_t isqrt32(uint32_t v) {
+    uint32_t root = (uint32_t)sqrtf((float)v);
+    if (root * root > v) root--;
+    else if ((root + 1) * (root + 1) <= v) root++;
+    return root;
+}
+
+void dspMagnitude3Q15(const int16_t* x, const int16_t* y, const int16_t* z, int16_t* out, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        // x² + y² reaches 2^31, so the SMUAD result is read as unsigned; with z² the
+        // sum stays below 3·2^30
+        uint32_t xy = dspPack(x[i], y[i]);
+        uint32_t sum = dspSmuad(xy, xy) + (uint32_t)((int32_t)z[i] * z[i]);
+        uint32_t root = isqrt32(sum);
+        out[i] = (int16_t)(root > 32767 ? 32767 : root);
+    }
+}
+
+void dspMovingSumInit(DspMovingSumQ15& m, int16_t* buffer, uint16_t length) {
+    m.buffer = buffer;
+    m.length = length;
+    m.head = 0;
+    m.sum = 0;
+    memset(buffer, 0, length * sizeof(int16_t));
+}
+
+void dspMovingSumQ15(DspMovingSumQ15& m, const int16_t* in, int32_t* out, uint16_t n) {
+    // One add and one subtract per sample; packing buys nothing here
+    int32_t sum = m.sum;
+    uint16_t head = m.head;
+    for (uint16_t i = 0; i < n; i++) {
+        sum += (int32_t)in[i] - m.buffer[head];
+        m.buffer[head] = in[i];
+        if (++head >= m.length) head = 0;
+        out[i] = sum;
+    }
+    m.sum = sum;
+    m.head = head;
+}
+
+void dspBiquadInit(DspBiquadQ15& f, uint8_t stages, const int16_t* coeffs, int16_t* state, uint8_t postShift) {
+    f.coeffs = coeffs;
+    f.state = state;
+    f.stages = stages;
+    f.postShift = postShift;
+    memset(state, 0, stages * DSP_BIQUAD_STATE * sizeof(int16_t));
+}
+
+void dspBiquadQ15(DspBiquadQ15& f, const int16_t* in, int16_t* out, uint16_t n) {
+    uint8_t shift = 15 - f.postShift;
+    const int16_t* src = in;
+    for (uint8_t s = 0; s < f.stages; s++) {
+        const int16_t* c = f.coeffs + s * DSP_BIQUAD_COEFFS;
+        int16_t* st = f.state + s * DSP_BIQUAD_STATE;
+        int16_t b0 = c[0];
+        uint32_t b12 = dspRead2(c + 1);
+        uint32_t a12 = dspRead2(c + 3);
+        uint32_t x12 = dspRead2(st);          // x[n-1] low, x[n-2] high
+        uint32_t y12 = dspRead2(st + 2);
+
+        for (uint16_t i = 0; i < n; i++) {
+            int16_t x0 = src[i];
+            int64_t acc = (int32_t)b0 * x0;
+            acc = dspSmlald(b12, x12, acc);
+            acc = dspSmlald(a12, y12, acc);
+            int16_t y0 = dspSsat16((int32_t)(acc >> shift));
+            x12 = dspPack(x0, dspLo(x12));
+            y12 = dspPack(y0, dspLo(y12));
+            out[i] = y0;
+        }
+
+        dspWrite2(st, x12);
+        dspWrite2(st + 2, y12);
+        src = out;
+    }
+}
+
+bool dspFirDecimateInit(DspFirDecimatorQ15& f, uint16_t numTaps, uint8_t factor, const int16_t* coeffs,
+                        int16_t* state, uint16_t maxBlock) {
+    if (numTaps == 0 || factor == 0 || maxBlock % factor != 0) return false;
+    f.coeffs = coeffs;
+    f.state = state;
+    f.numTaps = numTaps;
+    f.factor = factor;
+    f.maxBlock = maxBlock;
+    memset(state, 0, (numTaps - 1 + maxBlock) * sizeof(int16_t));
+    return true;
+}
+
+uint16_t dspFirDecimateQ15(DspFirDecimatorQ15& f, const int16_t* in, int16_t* out, uint16_t n) {
+    if (n > f.maxBlock || n % f.factor != 0) return 0;
+    uint16_t history = f.numTaps - 1;
+    memcpy(f.state + history, in, n * sizeof(int16_t));
+
+    uint16_t outputs = n / f.factor;
+    const int16_t* c = f.coeffs;
+    for (uint16_t k = 0; k < outputs; k++) {
+        // Only the kept outputs are computed: the window ending on the last of each
+        // `factor` new samples
+        const int16_t* p = f.state + k * f.factor + f.factor - 1;
+        int64_t acc0 = 0, acc1 = 0;
+        uint16_t j = 0;
+        for (; j + 4 <= f.numTaps; j += 4) {
+            acc0 = dspSmlald(dspRead2(c + j), dspRead2(p + j), acc0);
+            acc1 = dspSmlald(dspRead2(c + j + 2), dspRead2(p + j + 2), acc1);
+        }
+        for (; j + 2 <= f.numTaps; j += 2) {
+            acc0 = dspSmlald(dspRead2(c + j), dspRead2(p + j), acc0);
+        }
+        if (j < f.numTaps) acc1 += (int32_t)c[j] * p[j];
+        out[k] = dspSsat16((int32_t)((acc0 + acc1) >> 15));
+    }
+
+    memmove(f.state, f.state + n, history * sizeof(int16_t));
+    return outputs;
+}
+
+static int16_t quantizeQ15(float v) {
+    float scaled = v * 32768.0f;
+    return dspSat16((int32_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f));
+}
+
+uint8_t dspDesignLowpassBiquad(float cutoffHz, float sampleRateHz, float q, int16_t* coeffs) {
+    float w0 = 2.0f * DSP_PI * cutoffHz / sampleRateHz;
+    float cw = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    float c[DSP_BIQUAD_COEFFS] = {
+        (1.0f - cw) * 0.5f / a0,
+        (1.0f - cw) / a0,
+        (1.0f - cw) * 0.5f / a0,
+        2.0f * cw / a0,                   // a1, negated
+        -(1.0f - alpha) / a0,             // a2, negated
+    };
+
+    float largest = 0.0f;
+    for (uint8_t i = 0; i < DSP_BIQUAD_COEFFS; i++) {
+        if (fabsf(c[i]) > largest) largest = fabsf(c[i]);
+    }
+    uint8_t postShift = largest >= 1.0f ? 1 : 0;
+    for (uint8_t i = 0; i < DSP_BIQUAD_COEFFS; i++) {
+        coeffs[i] = quantizeQ15(c[i] / (1 << postShift));
+    }
+    return postShift;
+}
+
+static float windowedSinc(float fc, uint16_t i, uint16_t numTaps) {
+    float t = i - (numTaps - 1) * 0.5f;
+    float sinc = t == 0.0f ? 2.0f * fc : sinf(2.0f * DSP_PI * fc * t) / (DSP_PI * t);
+    float window = numTaps > 1 ? 0.54f - 0.46f * cosf(2.0f * DSP_PI * i / (numTaps - 1)) : 1.0f;
+    return sinc * window;
+}
+
+void dspDesignLowpassFir(float cutoffHz, float sampleRateHz, uint16_t numTaps, int16_t* coeffs) {
+    float fc = cutoffHz / sampleRateHz;
+    float sum = 0.0f;
+    for (uint16_t i = 0; i < numTaps; i++) sum += windowedSinc(fc, i, numTaps);
+    for (uint16_t i = 0; i < numTaps; i++) coeffs[i] = quantizeQ15(windowedSinc(fc, i, numTaps) / sum);
+}
@@ -0,0 +1,166 @@
+#ifndef DspKernels_H
+#define DspKernels_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Cortex-M4/M7 packed 16-bit multiply-accumulate and saturating arithmetic. Define
+// DSP_USE_SIMD=0 to build the portable path on the device as well.
+#ifndef DSP_USE_SIMD
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define DSP_USE_SIMD 1
+#else
+#define DSP_USE_SIMD 0
+#endif
+#endif
+
+#if DSP_USE_SIMD
+#include "cmsis.h"
+#endif
+
+// Per-stage layout of the biquad coefficient and state arrays
+#define DSP_BIQUAD_COEFFS 5             // b0, b1, b2, a1, a2 per stage
+#define DSP_BIQUAD_STATE 4              // x[n-1], x[n-2], y[n-1], y[n-2] per stage
+
+// ---------------------------------------------------------------------------
+// Packed primitives. On the M4 each is one instruction; the portable versions
+// reproduce the instruction's result bit for bit (the Q flag is not modelled).
+// Two Q15 values share a word: element 0 in the low half, element 1 in the high half.
+// ---------------------------------------------------------------------------
+
+// Two consecutive int16 as one word (unaligned is fine on the M4)
+static inline uint32_t dspRead2(const int16_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void dspWrite2(int16_t* p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline int16_t dspLo(uint32_t v) {
+    return (int16_t)(v & 0xFFFF);
+}
+
+static inline int16_t dspHi(uint32_t v) {
+    return (int16_t)(v >> 16);
+}
+
+// acc + lo(x)*lo(y) + hi(x)*hi(y), 64-bit accumulator
+static inline int64_t dspSmlald(uint32_t x, uint32_t y, int64_t acc) {
+#if DSP_USE_SIMD
+    return (int64_t)__SMLALD(x, y, (uint64_t)acc);
+#else
+    return acc + (int32_t)dspLo(x) * dspLo(y) + (int32_t)dspHi(x) * dspHi(y);
+#endif
+}
+
+// lo(x)*lo(y) + hi(x)*hi(y), wrapped to 32 bits
+static inline uint32_t dspSmuad(uint32_t x, uint32_t y) {
+#if DSP_USE_SIMD
+    return (uint32_t)__SMUAD(x, y);
+#else
+    return (uint32_t)((int32_t)dspLo(x) * dspLo(y)) + (uint32_t)((int32_t)dspHi(x) * dspHi(y));
+#endif
+}
+
+static inline int16_t dspSat16(int32_t v) {
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+// Saturating add on both halves
+static inline uint32_t dspQadd16(uint32_t x, uint32_t y) {
+#if DSP_USE_SIMD
+    return __QADD16(x, y);
+#else
+    return (uint16_t)dspSat16((int32_t)dspLo(x) + dspLo(y)) |
+           ((uint32_t)(uint16_t)dspSat16((int32_t)dspHi(x) + dspHi(y)) << 16);
+#endif
+}
+
+// Two samples into one word, `lo` as element 0
+static inline uint32_t dspPack(int16_t lo, int16_t hi) {
+#if DSP_USE_SIMD
+    return __PKHBT((uint32_t)(uint16_t)lo, (uint32_t)(uint16_t)hi, 16);
+#else
+    return (uint32_t)(uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+#endif
+}
+
+// Clamp to the int16 range
+static inline int16_t dspSsat16(int32_t v) {
+#if DSP_USE_SIMD
+    return (int16_t)__SSAT(v, 16);
+#else
+    return dspSat16(v);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Kernels. Q15 data, Q31/64-bit accumulators; all state is caller-owned.
+// ---------------------------------------------------------------------------
+
+// Sum of a[i]*b[i] in Q30, exact (64-bit accumulator)
+int64_t dspDotQ15(const int16_t* a, const int16_t* b, uint16_t n);
+
+// out[i] = sat(a[i] + b[i])
+void dspAddQ15(const int16_t* a, const int16_t* b, int16_t* out, uint16_t n);
+
+// out[i] = min(sqrt(x[i]² + y[i]² + z[i]²), 32767), floor
+void dspMagnitude3Q15(const int16_t* x, const int16_t* y, const int16_t* z, int16_t* out, uint16_t n);
+
+// Running sum of the last `length` samples, exact in Q15 units (an int32 holds 65536
+// full-scale samples)
+struct DspMovingSumQ15 {
+    int16_t* buffer;                  // `length` samples, caller-owned
+    uint16_t length;
+    uint16_t head;
+    int32_t sum;
+};
+
+void dspMovingSumInit(DspMovingSumQ15& m, int16_t* buffer, uint16_t length);
+void dspMovingSumQ15(DspMovingSumQ15& m, const int16_t* in, int32_t* out, uint16_t n);
+
+// Biquad cascade, direct form I. Coefficients per stage are b0, b1, b2, a1, a2 in Q15
+// scaled down by 2^postShift, with a1/a2 negated (y = b·x + a·y). Rounding is a plain
+// arithmetic shift, as on the CMSIS q15 biquad.
+struct DspBiquadQ15 {
+    const int16_t* coeffs;            // stages * DSP_BIQUAD_COEFFS
+    int16_t* state;                   // stages * DSP_BIQUAD_STATE
+    uint8_t stages;
+    uint8_t postShift;
+};
+
+void dspBiquadInit(DspBiquadQ15& f, uint8_t stages, const int16_t* coeffs, int16_t* state, uint8_t postShift);
+void dspBiquadQ15(DspBiquadQ15& f, const int16_t* in, int16_t* out, uint16_t n);
+
+// Decimating FIR. Coefficients are in time-reversed order (h[numTaps-1] first; a
+// symmetric filter is unaffected). The state buffer holds numTaps - 1 + maxBlock
+// samples; blocks must be a multiple of `factor` and at most maxBlock long.
+struct DspFirDecimatorQ15 {
+    const int16_t* coeffs;
+    int16_t* state;
+    uint16_t numTaps;
+    uint16_t maxBlock;
+    uint8_t factor;
+};
+
+bool dspFirDecimateInit(DspFirDecimatorQ15& f, uint16_t numTaps, uint8_t factor, const int16_t* coeffs,
+                        int16_t* state, uint16_t maxBlock);
+// Returns the number of outputs (n / factor), 0 for a block it cannot take
+uint16_t dspFirDecimateQ15(DspFirDecimatorQ15& f, const int16_t* in, int16_t* out, uint16_t n);
+
+// ---------------------------------------------------------------------------
+// Coefficient design (float, at setup time)
+// ---------------------------------------------------------------------------
+
+// RBJ low-pass for one biquad stage with the given Q; returns the postShift the
+// coefficients needed (0 or 1) and writes DSP_BIQUAD_COEFFS values
+uint8_t dspDesignLowpassBiquad(float cutoffHz, float sampleRateHz, float q, int16_t* coeffs);
+
+// Hamming-windowed sinc low-pass with unity DC gain; symmetric, so usable as-is by the
+// decimator
+void dspDesignLowpassFir(float cutoffHz, float sampleRateHz, uint16_t numTaps, int16_t* coeffs);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef DspReference_H
+#define DspReference_H
+
+#include <math.h>
+#include "DspKernels.h"
+
+// Plain scalar versions of the DspKernels, one element at a time and written from the
+// definitions rather than the packed layout. The kernels must match them bit for bit on
+// either path; tools/bench/dsp_bench checks that on the host. Not used by the firmware.
+
+static inline int64_t dspRefDotQ15(const int16_t* a, const int16_t* b, uint16_t n) {
+    int64_t acc = 0;
+    for (uint16_t i = 0; i < n; i++) acc += (int64_t)a[i] * b[i];
+    return acc;
+}
+
+static inline void dspRefAddQ15(const int16_t* a, const int16_t* b, int16_t* out, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t v = (int32_t)a[i] + b[i];
+        out[i] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+}
+
+static inline void dspRefMagnitude3Q15(const int16_t* x, const int16_t* y, const int16_t* z, int16_t* out,
+                                       uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        double sq = (double)x[i] * x[i] + (double)y[i] * y[i] + (double)z[i] * z[i];
+        double root = floor(sqrt(sq));
+        out[i] = (int16_t)(root > 32767.0 ? 32767 : (int32_t)root);
+    }
+}
+
+// Recomputes every window from the history instead of keeping a running sum
+static inline void dspRefMovingSumQ15(const int16_t* history, uint32_t historyLength, uint16_t length,
+                                      int32_t* out) {
+    for (uint32_t i = 0; i < historyLength; i++) {
+        int32_t sum = 0;
+        for (uint16_t k = 0; k < length && k <= i; k++) sum += history[i - k];
+        out[i] = sum;
+    }
+}
+
+// One stage after another over the whole signal, state as plain variables
+static inline void dspRefBiquadQ15(const int16_t* coeffs, uint8_t stages, uint8_t postShift, const int16_t* in,
+                                   int16_t* out, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) out[i] = in[i];
+    for (uint8_t s = 0; s < stages; s++) {
+        const int16_t* c = coeffs + s * DSP_BIQUAD_COEFFS;
+        int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t x0 = out[i];
+            int64_t acc = (int64_t)c[0] * x0 + (int64_t)c[1] * x1 + (int64_t)c[2] * x2 +
+                          (int64_t)c[3] * y1 + (int64_t)c[4] * y2;
+            int64_t v = acc >> (15 - postShift);
+            int32_t y0 = (int32_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            out[i] = (int16_t)y0;
+        }
+    }
+}
+
+// Direct convolution y[m] = Σ h[k]·x[m·factor + factor - 1 - k] with zero initial
+// history; `coeffs` in the decimator's time-reversed order, so h[k] = coeffs[numTaps-1-k]
+static inline uint32_t dspRefFirDecimateQ15(const int16_t* coeffs, uint16_t numTaps, uint8_t factor,
+                                            const int16_t* in, int16_t* out, uint32_t n) {
+    uint32_t outputs = n / factor;
+    for (uint32_t m = 0; m < outputs; m++) {
+        int64_t acc = 0;
+        int64_t newest = (int64_t)m * factor + factor - 1;
+        for (uint16_t k = 0; k < numTaps; k++) {
+            int64_t idx = newest - k;
+            if (idx >= 0) acc += (int64_t)coeffs[numTaps - 1 - k] * in[idx];
+        }
+        int64_t v = acc >> 15;
+        out[m] = (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+    }
+    return outputs;
+}
+
+#endif
@@ -0,0 +1,274 @@
+#include "FallDetector.h"
+#include <math.h>
+#include <string.h>
+
+#define FALL_STANDARD_GRAVITY 9.80665f
+#define FALL_BASELINE_TAU_S 2.0f        // Rolling |a| mean/variance
+#define FALL_GRAVITY_TAU_S 0.5f         // Gravity direction low-pass
+#define FALL_MIN_STD_G 0.05f            // Floor for the z-score denominator (sensor noise)
+#define FALL_MAX_DT_S 0.5f              // Gaps longer than this do not age the baseline more
+
+// Evidence weights, after the phone detector's scoring (sum is clamped to 1)
+#define FALL_SCORE_IMPACT 0.30f
+#define FALL_SCORE_IMPACT_Z 0.10f
+#define FALL_SCORE_FREE_FALL 0.20f
+#define FALL_SCORE_STILL 0.25f
+#define FALL_SCORE_ANGLE 0.15f
+#define FALL_SCORE_HEIGHT 0.10f
+
+FallDetector::FallDetector() {
+    config.freeFallG = 0.5f;
+    config.freeFallMinMs = 60;
+    config.freeFallMaxMs = 1000;        // ~4.9 m of drop
+    config.impactWindowMs = 600;
+    config.impactG = 2.5f;
+    config.impactZ = 6.0f;
+    config.settleMs = 500;
+    config.stillnessMs = 1500;
+    config.stillStdG = 0.08f;
+    config.stillGyroDps = 30.0f;
+    config.angleChangeDeg = 45.0f;
+    config.heightDropM = 0.4f;
+    config.minConfidence = 0.55f;
+    config.cooldownMs = 15000;
+    height = 0.0f;
+    haveHeight = false;
+    detections = 0;
+    candidates = 0;
+    reset();
+}
+
+void FallDetector::begin(const FallDetectorConfig& config) {
+    this->config = config;
+    reset();
+}
+
+void FallDetector::reset() {
+    phase = FALL_PHASE_IDLE;
+    primed = false;
+    lastUs = 0;
+    meanMag = 1.0f;
+    varMag = 0.0f;
+    gravity[0] = gravity[1] = 0.0f;
+    gravity[2] = FALL_STANDARD_GRAVITY;
+    memcpy(preGravity, gravity, sizeof(preGravity));
+    preMeanMag = 1.0f;
+    preStdMag = 0.0f;
+    preHeight = 0.0f;
+    freeFallStartUs = freeFallEndUs = 0;
+    freeFallEnded = false;
+    freeFallArmed = true;
+    freeFallMs = 0;
+    impactUs = 0;
+    impactPeak = 0.0f;
+    phaseStartUs = 0;
+    stillCount = 0;
+    stillSum = stillSumSq = stillGyroSum = 0.0f;
+    stillAccel[0] = stillAccel[1] = stillAccel[2] = 0.0f;
+    cooldownStartUs = 0;
+    memset(&pendingEvent, 0, sizeof(pendingEvent));
+    pending = false;
+}
+
+void FallDetector::setHeight(float heightM) {
+    height = heightM;
+    haveHeight = true;
+}
+
+void FallDetector::updateBaseline(const float accel[3], float magnitude, float dt) {
+    if (!primed) {
+        meanMag = magnitude;
+        varMag = 0.0f;
+        memcpy(gravity, accel, sizeof(gravity));
+        primed = true;
+        return;
+    }
+    float a = dt / (FALL_BASELINE_TAU_S + dt);
+    float d = magnitude - meanMag;
+    meanMag += a * d;
+    varMag += a * (d * d - varMag);
+
+    float g = dt / (FALL_GRAVITY_TAU_S + dt);
+    for (uint8_t i = 0; i < 3; i++) {
+        gravity[i] += g * (accel[i] - gravity[i]);
+    }
+}
+
+void FallDetector::startCandidate(uint32_t timestampUs) {
+    memcpy(preGravity, gravity, sizeof(preGravity));
+    preMeanMag = meanMag;
+    preStdMag = sqrtf(varMag > 0.0f ? varMag : 0.0f);
+    preHeight = height;
+    freeFallMs = 0;
+    freeFallEnded = false;
+    phaseStartUs = timestampUs;
+}
+
+void FallDetector::enterImpact(float magnitude, uint32_t timestampUs) {
+    impactPeak = magnitude;
+    impactUs = timestampUs;
+    phase = FALL_PHASE_IMPACT;
+    phaseStartUs = timestampUs;
+}
+
+void FallDetector::addSample(const float accel[3], const float gyro[3], uint32_t timestampUs) {
+    float magnitude = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]) / FALL_STANDARD_GRAVITY;
+    float dt = primed ? (float)(timestampUs - lastUs) * 1e-6f : 0.0f;
+    if (dt > FALL_MAX_DT_S) dt = FALL_MAX_DT_S;
+    lastUs = timestampUs;
+
+    switch (phase) {
+    case FALL_PHASE_IDLE:
+        if (primed && magnitude >= config.impactG) {
+            // Impact without a free fall before it (trip, collapse against something)
+            startCandidate(timestampUs);
+            enterImpact(magnitude, timestampUs);
+        } else if (primed && freeFallArmed && magnitude < config.freeFallG) {
+            startCandidate(timestampUs);
+            freeFallStartUs = timestampUs;
+            phase = FALL_PHASE_FREE_FALL;
+        } else {
+            if (magnitude >= config.freeFallG) freeFallArmed = true;
+            updateBaseline(accel, magnitude, dt);
+        }
+        break;
+
+    case FALL_PHASE_FREE_FALL:
+        if (!freeFallEnded) {
+            uint32_t durationMs = (timestampUs - freeFallStartUs) / 1000;
+            if (durationMs > config.freeFallMaxMs) {
+                // Weightless for too long to be a fall; wait for |a| to come back before
+                // another free fall can open, so a stuck reading does not loop here
+                freeFallArmed = false;
+                phase = FALL_PHASE_IDLE;
+                break;
+            }
+            if (magnitude < config.freeFallG) break;
+            if (durationMs < config.freeFallMinMs) {
+                // Too short to be a fall: a bump or sensor glitch
+                phase = FALL_PHASE_IDLE;
+                break;
+            }
+            freeFallMs = durationMs > 0xFFFF ? 0xFFFF : (uint16_t)durationMs;
+            freeFallEnded = true;
+            freeFallEndUs = timestampUs;
+        }
+        if (magnitude >= config.impactG) {
+            enterImpact(magnitude, timestampUs);
+        } else if (timestampUs - freeFallEndUs > (uint32_t)config.impactWindowMs * 1000) {
+            phase = FALL_PHASE_IDLE;
+        }
+        break;
+
+    case FALL_PHASE_IMPACT:
+        if (magnitude > impactPeak) {
+            impactPeak = magnitude;
+            impactUs = timestampUs;
+        }
+        if (timestampUs - phaseStartUs >= (uint32_t)config.settleMs * 1000) {
+            phase = FALL_PHASE_STILLNESS;
+            phaseStartUs = timestampUs;
+            stillCount = 0;
+            stillSum = stillSumSq = stillGyroSum = 0.0f;
+            stillAccel[0] = stillAccel[1] = stillAccel[2] = 0.0f;
+        }
+        break;
+
+    case FALL_PHASE_STILLNESS:
+        stillCount++;
+        stillSum += magnitude;
+        stillSumSq += magnitude * magnitude;
+        stillGyroSum += sqrtf(gyro[0] * gyro[0] + gyro[1] * gyro[1] + gyro[2] * gyro[2]);
+        for (uint8_t i = 0; i < 3; i++) stillAccel[i] += accel[i];
+        if (timestampUs - phaseStartUs >= (uint32_t)config.stillnessMs * 1000) {
+            decide(timestampUs);
+        }
+        break;
+
+    case FALL_PHASE_COOLDOWN:
+        updateBaseline(accel, magnitude, dt);
+        if (timestampUs - cooldownStartUs >= config.cooldownMs * 1000) {
+            phase = FALL_PHASE_IDLE;
+        }
+        break;
+    }
+}
+
+void FallDetector::decide(uint32_t timestampUs) {
+    candidates++;
+
+    float n = stillCount ? (float)stillCount : 1.0f;
+    float mean = stillSum / n;
+    float var = stillSumSq / n - mean * mean;
+    float std = sqrtf(var > 0.0f ? var : 0.0f);
+    bool still = stillCount > 0 && std < config.stillStdG && stillGyroSum / n < config.stillGyroDps;
+
+    // Angle between the gravity direction before the fall and the resting one after it
+    float dot = 0.0f, preNorm = 0.0f, postNorm = 0.0f;
+    for (uint8_t i = 0; i < 3; i++) {
+        dot += preGravity[i] * stillAccel[i];
+        preNorm += preGravity[i] * preGravity[i];
+        postNorm += stillAccel[i] * stillAccel[i];
+    }
+    float angle = 0.0f;
+    if (preNorm > 0.0f && postNorm > 0.0f) {
+        float c = dot / sqrtf(preNorm * postNorm);
+        if (c > 1.0f) c = 1.0f;
+        if (c < -1.0f) c = -1.0f;
+        angle = acosf(c) * (180.0f / 3.14159265f);
+    }
+
+    float std0 = preStdMag > FALL_MIN_STD_G ? preStdMag : FALL_MIN_STD_G;
+    float z = (impactPeak - preMeanMag) / std0;
+    float drop = haveHeight ? preHeight - height : 0.0f;
+
+    float score = FALL_SCORE_IMPACT;
+    if (z >= config.impactZ) score += FALL_SCORE_IMPACT_Z;
+    if (freeFallMs > 0) score += FALL_SCORE_FREE_FALL;
+    if (still) score += FALL_SCORE_STILL;
+    if (angle >= config.angleChangeDeg) score += FALL_SCORE_ANGLE;
+    if (haveHeight && drop >= config.heightDropM) score += FALL_SCORE_HEIGHT;
+    if (score > 1.0f) score = 1.0f;
+
+    // An impact with neither a free fall before it nor a turn is a set-down or a knock,
+    // and a hard landing the wearer walks away from upright is not a fall, however hard
+    bool turned = angle >= config.angleChangeDeg;
+    bool fell = freeFallMs > 0 || turned;
+    bool downed = still || turned;
+    if (!fell || !downed || score < config.minConfidence) {
+        phase = FALL_PHASE_IDLE;
+        return;
+    }
+
+    pendingEvent.timestampUs = impactUs;
+    pendingEvent.confidence = score;
+    pendingEvent.impactG = impactPeak;
+    pendingEvent.impactZ = z;
+    pendingEvent.freeFallMs = freeFallMs;
+    pendingEvent.angleChangeDeg = angle;
+    pendingEvent.heightDropM = drop;
+    pendingEvent.still = still;
+    pending = true;
+    detections++;
+    phase = FALL_PHASE_COOLDOWN;
+    cooldownStartUs = timestampUs;
+}
+
+bool FallDetector::poll(FallEvent& event) {
+    if (!pending) return false;
+    event = pendingEvent;
+    pending = false;
+    return true;
+}
+
+uint8_t FallDetector::getPhase() const {
+    return phase;
+}
+
+uint32_t FallDetector::getDetections() const {
+    return detections;
+}
+
+uint32_t FallDetector::getCandidates() const {
+    return candidates;
+}
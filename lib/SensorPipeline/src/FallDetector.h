@@ -0,0 +1,122 @@
+#ifndef FallDetector_H
+#define FallDetector_H
+
+#include <stdint.h>
+
+// Thresholds for FallDetector; accelerations in g, rates in degrees/s
+struct FallDetectorConfig {
+    float freeFallG;                  // |a| below this counts as free fall...
+    uint16_t freeFallMinMs;           // ...once it lasts this long
+    uint16_t freeFallMaxMs;           // Longer than this is not a fall (stuck sensor, carried in a lift)
+    uint16_t impactWindowMs;          // Impact has to follow the free fall within this
+    float impactG;                    // Peak |a| that counts as an impact
+    float impactZ;                    // Peak z-score against the baseline for the extra score
+    uint16_t settleMs;                // Bounce after the impact; the peak is still tracked
+    uint16_t stillnessMs;             // Window checked for lying still after settling
+    float stillStdG;                  // Standard deviation of |a| below this is "still"
+    float stillGyroDps;               // ...together with a mean |gyro| below this
+    float angleChangeDeg;             // Gravity direction change that means "ended up lying"
+    float heightDropM;                // Barometric height drop counted as supporting evidence
+    float minConfidence;              // Score needed to report a fall
+    uint32_t cooldownMs;              // No new detection this long after one
+};
+
+// One detected fall with the evidence behind it
+struct FallEvent {
+    uint32_t timestampUs;             // Time of the impact peak
+    float confidence;                 // 0..1
+    float impactG;                    // Peak |a|
+    float impactZ;                    // Peak z-score against the pre-fall baseline
+    uint16_t freeFallMs;              // 0 when the impact had no free fall before it
+    float angleChangeDeg;             // Gravity direction before the fall vs while still
+    float heightDropM;                // 0 without barometer data
+    bool still;                       // Lying still after the impact
+};
+
+enum FallPhase {
+    FALL_PHASE_IDLE = 0,
+    FALL_PHASE_FREE_FALL,
+    FALL_PHASE_IMPACT,
+    FALL_PHASE_STILLNESS,
+    FALL_PHASE_COOLDOWN
+};
+
+// Free fall -> impact -> stillness detector, run on every IMU sample.
+//
+// While idle it keeps a rolling baseline of |a| (mean and variance, ~2 s exponential
+// window) and a low-passed gravity vector. A stretch of near-weightlessness followed by
+// a large peak, or a large peak on its own, opens a candidate; after the bounce settles
+// the next stillnessMs decide whether the wearer is lying still and how far the gravity
+// direction turned. The evidence is scored like the phone's statistical detector
+// (impact, z-score, free fall, stillness, angle change, height drop) and reported once
+// above minConfidence. Two gates apply whatever the score: the candidate must show a
+// fall (a free fall before the impact or a turned gravity direction), so a board set
+// down hard and left alone is not one, and the wearer must have ended up still or
+// turned over. O(1) per sample, no heap; samples need not be evenly spaced.
+class FallDetector {
+public:
+    FallDetector();
+    void begin(const FallDetectorConfig& config);
+    void reset();
+
+    // Accelerometer in m/s², gyroscope in degrees/s, wrap-safe microsecond timestamp
+    void addSample(const float accel[3], const float gyro[3], uint32_t timestampUs);
+
+    // Latest barometric height change in metres (optional, any rate)
+    void setHeight(float heightM);
+
+    // Takes the pending detection, if any
+    bool poll(FallEvent& event);
+
+    uint8_t getPhase() const;
+    uint32_t getDetections() const;
+    uint32_t getCandidates() const;   // Impacts that were scored (detected or not)
+
+private:
+    void startCandidate(uint32_t timestampUs);
+    void enterImpact(float magnitude, uint32_t timestampUs);
+    void decide(uint32_t timestampUs);
+    void updateBaseline(const float accel[3], float magnitude, float dt);
+
+    FallDetectorConfig config;
+    uint8_t phase;
+
+    // Baseline (idle only)
+    bool primed;
+    uint32_t lastUs;
+    float meanMag;
+    float varMag;
+    float gravity[3];
+
+    // Candidate
+    float preGravity[3];
+    float preMeanMag;
+    float preStdMag;
+    float preHeight;
+    uint32_t freeFallStartUs;
+    uint32_t freeFallEndUs;
+    bool freeFallEnded;
+    bool freeFallArmed;               // |a| has been back above freeFallG since the last timeout
+    uint16_t freeFallMs;
+    uint32_t impactUs;
+    float impactPeak;
+    uint32_t phaseStartUs;
+
+    // Stillness window
+    uint32_t stillCount;
+    float stillSum;
+    float stillSumSq;
+    float stillGyroSum;
+    float stillAccel[3];
+
+    float height;
+    bool haveHeight;
+    uint32_t cooldownStartUs;
+
+    FallEvent pendingEvent;
+    bool pending;
+    uint32_t detections;
+    uint32_t candidates;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef FixedPoint_H
+#define FixedPoint_H
+
+#include <stdint.h>
+
+// Q16.16 signed fixed point: 16 integer bits, 16 fractional bits
+typedef int32_t q16_t;
+
+#define Q16_ONE 65536
+
+// Compile-time conversions (used to build the scale tables)
+constexpr q16_t q16FromDouble(double v) {
+    return (q16_t)(v * 65536.0 + (v >= 0 ? 0.5 : -0.5));
+}
+
+// Multiplier for a raw sensor count: (raw * mult) >> 16 gives a Q16 value when
+// mult = unitsPerLsb * 2^32. Keeping 32 fractional bits in the multiplier preserves
+// precision for small sensitivities such as 0.061 mg/LSB.
+constexpr int32_t q32ScaleFromDouble(double unitsPerLsb) {
+    return (int32_t)(unitsPerLsb * 4294967296.0 + 0.5);
+}
+
+inline float q16ToFloat(q16_t v) {
+    return v * (1.0f / 65536.0f);
+}
+
+inline q16_t q16FromFloat(float v) {
+    return (q16_t)(v * 65536.0f + (v >= 0 ? 0.5f : -0.5f));
+}
+
+inline q16_t q16Mul(q16_t a, q16_t b) {
+    return (q16_t)(((int64_t)a * b) >> 16);
+}
+
+// Raw 16-bit count to Q16 physical units with a q32ScaleFromDouble() multiplier
+inline q16_t q16ScaleRaw(int16_t raw, int32_t multQ32) {
+    return (q16_t)(((int64_t)raw * multQ32) >> 16);
+}
+
+inline q16_t q16Clamp(q16_t v, q16_t lo, q16_t hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Integer square root (floor) of a 64-bit value, bit-by-bit, no division
+inline uint32_t isqrt64(uint64_t v) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= result + bit) {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+// log2(v) in Q16 for v > 0 (returns 0 for v == 0). Integer part from the leading bit,
+// fraction by repeatedly squaring the normalised mantissa.
+inline uint32_t log2Q16(uint64_t v) {
+    if (v == 0) return 0;
+    uint32_t intPart = 63;
+    while (!(v & ((uint64_t)1 << 63))) {
+        v <<= 1;
+        intPart--;
+    }
+    // Mantissa in [1, 2) with 31 fractional bits
+    uint64_t m = v >> 32;
+    uint32_t frac = 0;
+    for (uint8_t i = 0; i < 16; i++) {
+        m = (m * m) >> 31;
+        frac <<= 1;
+        if (m >= ((uint64_t)2 << 31)) {
+            m >>= 1;
+            frac |= 1;
+        }
+    }
+    return (intPart << 16) | frac;
+}
+
+// 10*log10(v) in Q8 dB: log2 scaled by 10*log10(2)
+inline int32_t powerDbQ8(uint64_t v) {
+    return (int32_t)(((uint64_t)log2Q16(v) * 197283u) >> 24);
+}
+
+// |(x, y, z)| for Q16 components; the Q32 sum of squares has a Q16 root
+inline q16_t q16Magnitude3(q16_t x, q16_t y, q16_t z) {
+    uint64_t sum = (uint64_t)((int64_t)x * x) + (uint64_t)((int64_t)y * y) + (uint64_t)((int64_t)z * z);
+    return (q16_t)isqrt64(sum);
+}
+
+// Precomputed linear calibration: value = offset + (raw - rawOffset) * slope
+struct LinearCalQ16 {
+    int32_t slopeQ24;                 // Units per LSB, 24 fractional bits
+    q16_t offsetQ16;                  // Value at rawOffset
+    int16_t rawOffset;
+};
+
+inline q16_t applyLinearCal(const LinearCalQ16& cal, int16_t raw) {
+    return cal.offsetQ16 + (q16_t)(((int64_t)((int32_t)raw - cal.rawOffset) * cal.slopeQ24) >> 8);
+}
+
+// Two-point calibration from reference values given with `fracBits` fractional bits
+// (e.g. HTS221 stores T in degC x8 -> 3 bits, RH in % x2 -> 1 bit)
+inline LinearCalQ16 makeLinearCal(int32_t value0, int32_t value1, uint8_t fracBits, int16_t raw0, int16_t raw1) {
+    LinearCalQ16 cal;
+    int32_t span = (int32_t)raw1 - raw0;
+    if (span == 0) span = 1;
+    cal.slopeQ24 = (int32_t)((int64_t)(value1 - value0) * (1 << (24 - fracBits)) / span);
+    cal.offsetQ16 = value0 * (1 << (16 - fracBits));
+    cal.rawOffset = raw0;
+    return cal;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "ImuAcquisition.h"
+
+ImuAcquisition::ImuAcquisition() {
+    reader = nullptr;
+    readerCtx = nullptr;
+    interruptCount.store(0);
+    servicedCount.store(0);
+    lastInterruptUs.store(0);
+    sourceOverruns.store(0);
+    reportedLosses = 0;
+}
+
+void ImuAcquisition::begin(ReadFn reader, void* ctx) {
+    this->reader = reader;
+    this->readerCtx = ctx;
+}
+
+void ImuAcquisition::onInterrupt(uint32_t timestampUs) {
+    lastInterruptUs.store(timestampUs, std::memory_order_relaxed);
+    interruptCount.fetch_add(1, std::memory_order_release);
+}
+
+bool ImuAcquisition::hasPendingInterrupt() const {
+    return interruptCount.load(std::memory_order_acquire) != servicedCount.load(std::memory_order_relaxed);
+}
+
+uint16_t ImuAcquisition::service() {
+    if (reader == nullptr) return 0;
+
+    // Several edges may have fired since the last service; one read catches up on all
+    // of them because the sensor reports everything it has buffered.
+    servicedCount.store(interruptCount.load(std::memory_order_acquire), std::memory_order_relaxed);
+    uint32_t irqTime = lastInterruptUs.load(std::memory_order_relaxed);
+
+    uint16_t total = 0;
+    uint16_t got;
+    do {
+        got = reader(readerCtx, batch, IMU_ACQUISITION_BATCH, irqTime);
+        for (uint16_t i = 0; i < got; i++) {
+            ring.push(batch[i]);
+        }
+        total += got;
+    } while (got == IMU_ACQUISITION_BATCH);
+
+    return total;
+}
+
+void ImuAcquisition::noteSourceOverrun() {
+    sourceOverruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ImuAcquisition::pop(ImuSample& sample) {
+    return ring.pop(sample);
+}
+
+uint16_t ImuAcquisition::drain(ImuSample* out, uint16_t maxSamples) {
+    return (uint16_t)ring.popMany(out, maxSamples);
+}
+
+uint32_t ImuAcquisition::available() const {
+    return ring.size();
+}
+
+bool ImuAcquisition::takeOverrun() {
+    uint32_t losses = ring.droppedCount() + sourceOverruns.load(std::memory_order_relaxed);
+    bool lost = losses != reportedLosses;
+    reportedLosses = losses;
+    return lost;
+}
+
+uint32_t ImuAcquisition::getInterruptCount() const {
+    return interruptCount.load(std::memory_order_relaxed);
+}
+
+uint32_t ImuAcquisition::getDroppedSamples() const {
+    return ring.droppedCount();
+}
+
+uint32_t ImuAcquisition::getSourceOverruns() const {
+    return sourceOverruns.load(std::memory_order_relaxed);
+}
+
+bool ImuAcquisition::isActive() const {
+    return reader != nullptr;
+}
+
+#ifndef ARDUINO
+SimulatedImuInterrupt::SimulatedImuInterrupt(ImuAcquisition& acquisition, uint32_t periodUs,
+                                             uint16_t samplesPerInterrupt)
+    : acquisition(acquisition), periodUs(periodUs), samplesPerInterrupt(samplesPerInterrupt),
+      clockUs(0), nextFireUs(periodUs * samplesPerInterrupt), sequence(0) {
+    acquisition.begin(&SimulatedImuInterrupt::read, this);
+}
+
+void SimulatedImuInterrupt::advance(uint32_t elapsedUs) {
+    uint32_t target = clockUs + elapsedUs;
+    while ((int32_t)(target - nextFireUs) >= 0) {
+        clockUs = nextFireUs;
+        acquisition.onInterrupt(clockUs);
+        nextFireUs += periodUs * samplesPerInterrupt;
+    }
+    clockUs = target;
+}
+
+uint32_t SimulatedImuInterrupt::nowUs() const {
+    return clockUs;
+}
+
+uint16_t SimulatedImuInterrupt::read(void* ctx, ImuSample* out, uint16_t maxSamples, uint32_t irqTimestampUs) {
+    SimulatedImuInterrupt* self = static_cast<SimulatedImuInterrupt*>(ctx);
+
+    // Samples due up to the interrupt time that have not been handed out yet
+    uint32_t due = irqTimestampUs / self->periodUs;
+    uint32_t n = (due > self->sequence) ? due - self->sequence : 0;
+    if (n > maxSamples) n = maxSamples;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t seq = self->sequence + i;
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            out[i].gyro[axis] = (int16_t)(seq + axis);
+            out[i].accel[axis] = (int16_t)(seq * 3 + axis);
+        }
+        out[i].accel[2] += 16393; // 1g at ±2g full scale
+        out[i].timestampUs = (seq + 1) * self->periodUs;
+    }
+    self->sequence += n;
+    return (uint16_t)n;
+}
+#endif
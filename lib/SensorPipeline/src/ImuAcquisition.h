@@ -0,0 +1,95 @@
+#ifndef ImuAcquisition_H
+#define ImuAcquisition_H
+
+#include <stdint.h>
+#include <atomic>
+#include "SpscRing.h"
+
+// Ring capacity in samples (must be a power of two). 512 samples is ~5s at 104Hz.
+#ifndef IMU_RING_CAPACITY
+#define IMU_RING_CAPACITY 512
+#endif
+
+// Largest number of samples pulled from the sensor per interrupt
+#ifndef IMU_ACQUISITION_BATCH
+#define IMU_ACQUISITION_BATCH 32
+#endif
+
+// One raw accel+gyro sample as it comes off the sensor
+struct ImuSample {
+    int16_t gyro[3];                  // Raw gyroscope X, Y, Z
+    int16_t accel[3];                 // Raw accelerometer X, Y, Z
+    uint32_t timestampUs;             // Microsecond timestamp at which the sample was taken
+};
+
+// Interrupt-driven IMU acquisition.
+//
+// onInterrupt() is called from the INT1 ISR (data-ready or FIFO watermark). It only
+// records the edge, so it is safe in interrupt context. service() runs in the
+// acquisition context (a high-priority thread on the device, the test driver on a
+// host), reads whatever the sensor has through the reader callback and pushes raw
+// samples into a lock-free SPSC ring. loop() drains the ring with pop()/drain()
+// whenever it gets around to it, so network stalls no longer shift sample timing.
+class ImuAcquisition {
+public:
+    // Reads up to maxSamples from the sensor into out, returns the number read.
+    // irqTimestampUs is the time of the interrupt that triggered the read.
+    typedef uint16_t (*ReadFn)(void* ctx, ImuSample* out, uint16_t maxSamples, uint32_t irqTimestampUs);
+
+    ImuAcquisition();
+    void begin(ReadFn reader, void* ctx);
+
+    // Interrupt context
+    void onInterrupt(uint32_t timestampUs);
+
+    // Acquisition context
+    bool hasPendingInterrupt() const;
+    uint16_t service();
+    void noteSourceOverrun();         // The sensor reported lost samples (FIFO overrun)
+
+    // Consumer (loop) context
+    bool pop(ImuSample& sample);
+    uint16_t drain(ImuSample* out, uint16_t maxSamples);
+    uint32_t available() const;
+    bool takeOverrun();               // Sensor or ring lost samples since the last call
+
+    uint32_t getInterruptCount() const;
+    uint32_t getDroppedSamples() const;
+    uint32_t getSourceOverruns() const;
+    bool isActive() const;
+
+private:
+    SpscRing<ImuSample, IMU_RING_CAPACITY> ring;
+    ReadFn reader;
+    void* readerCtx;
+    std::atomic<uint32_t> interruptCount;
+    std::atomic<uint32_t> servicedCount;
+    std::atomic<uint32_t> lastInterruptUs;
+    std::atomic<uint32_t> sourceOverruns;
+    uint32_t reportedLosses;          // Consumer side: drops + overruns already reported
+    ImuSample batch[IMU_ACQUISITION_BATCH];
+};
+
+#ifndef ARDUINO
+// Host-side stand-in for the INT1 line: advance() fires the interrupt at a fixed
+// sample period and the reader hands out a deterministic ramp, so the acquisition
+// path can be exercised on Linux without hardware.
+class SimulatedImuInterrupt {
+public:
+    SimulatedImuInterrupt(ImuAcquisition& acquisition, uint32_t periodUs, uint16_t samplesPerInterrupt);
+    void advance(uint32_t elapsedUs);
+    uint32_t nowUs() const;
+
+    static uint16_t read(void* ctx, ImuSample* out, uint16_t maxSamples, uint32_t irqTimestampUs);
+
+private:
+    ImuAcquisition& acquisition;
+    uint32_t periodUs;
+    uint16_t samplesPerInterrupt;
+    uint32_t clockUs;
+    uint32_t nextFireUs;
+    uint32_t sequence;
+};
+#endif
+
+#endif
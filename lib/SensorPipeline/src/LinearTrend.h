@@ -0,0 +1,154 @@
+#ifndef LinearTrend_H
+#define LinearTrend_H
+
+#include <stdint.h>
+
+// Least-squares line through the samples of the last `spanMs` (at most N samples).
+//
+// Keeps the running means of t and x and the centred sums of (t-mt)^2, (x-mx)^2 and
+// (t-mt)(x-mx); adding a sample and evicting the oldest are O(1) Welford steps, and
+// slope / R^2 come straight from the sums. Times and values are taken relative to the
+// oldest sample at the last rebuild (once per N pushes), which together with centring
+// keeps float precision on millis() timestamps and on channels like pressure (~1013 hPa
+// with 0.01 hPa changes). A step leaving the window also triggers a rebuild, since
+// removing it cancels nearly all of the value spread. N must be a power of two.
+template <uint32_t N>
+class LinearTrend {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "LinearTrend size must be a power of two");
+
+public:
+    LinearTrend() {
+        spanMs = 0xFFFFFFFFu;
+        clear();
+    }
+
+    // Samples older than this are evicted (0xFFFFFFFF = only the capacity limits the window)
+    void setSpan(uint32_t spanMs) {
+        this->spanMs = spanMs;
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+        pushes = 0;
+        refMs = 0;
+        refValue = 0.0f;
+        resetSums();
+    }
+
+    // Timestamps must not go backwards (wrap-safe)
+    void add(uint32_t nowMs, float value) {
+        while (count > 0 && (count == N || nowMs - times[head & MASK] > spanMs)) {
+            evict();
+        }
+        if (count == 0) {
+            refMs = nowMs;
+            refValue = value;
+            resetSums();
+        }
+
+        uint32_t slot = (head + count) & MASK;
+        times[slot] = nowMs;
+        values[slot] = value;
+        count++;
+        accumulate(seconds(nowMs), value - refValue);
+
+        if ((++pushes & MASK) == 0 || stale) {
+            resync();
+        }
+    }
+
+    uint32_t size() const { return count; }
+
+    // Units of value per second; 0 until two distinct timestamps are in the window
+    float slope() const {
+        if (count < 2 || ctt <= 0.0f) return 0.0f;
+        return ctx / ctt;
+    }
+
+    // Fraction of the variance explained by the line (0..1); 0 for a flat or short window
+    float rSquared() const {
+        if (count < 3 || ctt <= 0.0f || cxx <= 0.0f) return 0.0f;
+        float r2 = (ctx * ctx) / (ctt * cxx);
+        return r2 > 1.0f ? 1.0f : r2;
+    }
+
+private:
+    static const uint32_t MASK = N - 1;
+
+    float seconds(uint32_t ms) const {
+        return (float)(int32_t)(ms - refMs) * 0.001f;
+    }
+
+    void resetSums() {
+        n = 0;
+        stale = false;
+        meanT = meanX = 0.0f;
+        ctt = cxx = ctx = 0.0f;
+    }
+
+    void accumulate(float t, float x) {
+        float dt = t - meanT;
+        float dx = x - meanX;
+        n++;
+        meanT += dt / n;
+        meanX += dx / n;
+        ctt += dt * (t - meanT);
+        cxx += dx * (x - meanX);
+        ctx += dx * (t - meanT);
+    }
+
+    void evict() {
+        uint32_t slot = head & MASK;
+        head++;
+        count--;
+        if (count == 0) {
+            resetSums();
+            return;
+        }
+        // Inverse of accumulate(): undo the means first, then the centred sums
+        float t = seconds(times[slot]);
+        float x = values[slot] - refValue;
+        float dt = t - meanT;
+        float dx = x - meanX;
+        float cxxBefore = cxx;
+        n--;
+        meanT -= dt / n;
+        meanX -= dx / n;
+        ctt -= dt * (t - meanT);
+        cxx -= dx * (x - meanX);
+        ctx -= dx * (t - meanT);
+        if (ctt < 0.0f) ctt = 0.0f;
+        if (cxx < 0.0f) cxx = 0.0f;
+        // A step leaving the window cancels most of cxx and its rounding with it
+        if (cxx < cxxBefore * (1.0f / 256.0f)) stale = true;
+    }
+
+    // Re-anchor on the oldest sample and rebuild the sums from the stored samples
+    void resync() {
+        refMs = times[head & MASK];
+        refValue = values[head & MASK];
+        resetSums();
+        stale = false;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t slot = (head + i) & MASK;
+            accumulate(seconds(times[slot]), values[slot] - refValue);
+        }
+    }
+
+    uint32_t times[N];
+    float values[N];
+    uint32_t head;
+    uint32_t count;
+    uint32_t pushes;
+    uint32_t spanMs;
+
+    uint32_t refMs;
+    float refValue;
+    uint32_t n;
+    bool stale;
+    float meanT, meanX;
+    float ctt, cxx, ctx;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "MicCapture.h"
+
+MicCapture::MicCapture() {
+    source = nullptr;
+    sampleRateHz = 0;
+    notify = nullptr;
+    notifyCtx = nullptr;
+    running = false;
+    readyMask.store(0);
+    completed.store(0);
+    overruns.store(0);
+    halfSequence[0] = halfSequence[1] = 0;
+    halfTimestampUs[0] = halfTimestampUs[1] = 0;
+    held.store(-1);
+}
+
+bool MicCapture::begin(MicDmaSource* source, uint32_t sampleRateHz) {
+    this->source = source;
+    this->sampleRateHz = sampleRateHz;
+    readyMask.store(0);
+    held.store(-1);
+    running = source != nullptr && source->start(this, buffer, 2 * MIC_BLOCK_SAMPLES, sampleRateHz);
+    return running;
+}
+
+void MicCapture::end() {
+    if (source != nullptr && running) {
+        source->stop();
+    }
+    running = false;
+}
+
+void MicCapture::setNotify(NotifyFn notify, void* ctx) {
+    notifyCtx = ctx;
+    this->notify = notify;
+}
+
+void MicCapture::onHalfComplete(uint32_t timestampUs) {
+    halfReady(0, timestampUs);
+}
+
+void MicCapture::onComplete(uint32_t timestampUs) {
+    halfReady(1, timestampUs);
+}
+
+void MicCapture::halfReady(uint8_t half, uint32_t timestampUs) {
+    uint8_t bit = (uint8_t)(1u << half);
+
+    // Still unconsumed (or being read right now): the DMA has written over it
+    if ((readyMask.load(std::memory_order_acquire) & bit) || held.load(std::memory_order_relaxed) == (int8_t)half) {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    halfSequence[half] = completed.load(std::memory_order_relaxed);
+    halfTimestampUs[half] = timestampUs;
+    completed.fetch_add(1, std::memory_order_relaxed);
+    readyMask.fetch_or(bit, std::memory_order_release);
+
+    if (notify != nullptr) {
+        notify(notifyCtx);
+    }
+}
+
+bool MicCapture::acquire(MicBlock& block) {
+    if (held.load(std::memory_order_relaxed) >= 0) return false; // release() the previous block first
+
+    uint8_t mask = readyMask.load(std::memory_order_acquire);
+    if (mask == 0) return false;
+
+    uint8_t half;
+    if (mask == 0x03) {
+        half = (halfSequence[0] < halfSequence[1]) ? 0 : 1;
+    } else {
+        half = (mask & 0x01) ? 0 : 1;
+    }
+
+    held.store((int8_t)half, std::memory_order_relaxed);
+    block.samples = &buffer[half * MIC_BLOCK_SAMPLES];
+    block.count = MIC_BLOCK_SAMPLES;
+    block.sequence = halfSequence[half];
+    block.timestampUs = halfTimestampUs[half];
+    return true;
+}
+
+void MicCapture::release() {
+    int8_t half = held.load(std::memory_order_relaxed);
+    if (half < 0) return;
+    readyMask.fetch_and((uint8_t)~(1u << half), std::memory_order_release);
+    held.store(-1, std::memory_order_relaxed);
+}
+
+uint32_t MicCapture::getSampleRateHz() const {
+    return sampleRateHz;
+}
+
+uint32_t MicCapture::getBlockCount() const {
+    return completed.load(std::memory_order_relaxed);
+}
+
+uint32_t MicCapture::getOverrunCount() const {
+    return overruns.load(std::memory_order_relaxed);
+}
+
+bool MicCapture::isRunning() const {
+    return running;
+}
@@ -0,0 +1,81 @@
+#ifndef MicCapture_H
+#define MicCapture_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Microphone sample rate and samples per ping-pong half (32ms blocks at 8kHz)
+#ifndef MIC_SAMPLE_RATE_HZ
+#define MIC_SAMPLE_RATE_HZ 8000
+#endif
+#ifndef MIC_BLOCK_SAMPLES
+#define MIC_BLOCK_SAMPLES 256
+#endif
+
+class MicCapture;
+
+// One completed half of the DMA buffer
+struct MicBlock {
+    const uint16_t* samples;          // Raw ADC codes
+    uint16_t count;
+    uint32_t sequence;                // Blocks completed before this one
+    uint32_t timestampUs;             // Time the last sample of the block was converted
+};
+
+// Hardware (or simulated) converter that fills a circular buffer at a fixed rate and
+// calls MicCapture::onHalfComplete()/onComplete() as each half fills up
+class MicDmaSource {
+public:
+    virtual ~MicDmaSource() {}
+    virtual bool start(MicCapture* capture, uint16_t* buffer, uint16_t totalSamples, uint32_t sampleRateHz) = 0;
+    virtual void stop() = 0;
+};
+
+// Continuous microphone capture into ping-pong buffers.
+//
+// The source converts into one circular buffer of two halves. When a half fills, the
+// DMA interrupt marks it ready and calls the notify hook (e.g. to wake a processing
+// thread); the consumer takes whole blocks with acquire()/release() while the other
+// half is being filled. A half that fills again before it was released counts as an
+// overrun. No sample is ever read with a blocking call.
+class MicCapture {
+public:
+    typedef void (*NotifyFn)(void* ctx);
+
+    MicCapture();
+    bool begin(MicDmaSource* source, uint32_t sampleRateHz);
+    void end();
+    void setNotify(NotifyFn notify, void* ctx);
+
+    // DMA interrupt context
+    void onHalfComplete(uint32_t timestampUs);
+    void onComplete(uint32_t timestampUs);
+
+    // Consumer context: oldest ready block first
+    bool acquire(MicBlock& block);
+    void release();
+
+    uint32_t getSampleRateHz() const;
+    uint32_t getBlockCount() const;
+    uint32_t getOverrunCount() const;
+    bool isRunning() const;
+
+private:
+    void halfReady(uint8_t half, uint32_t timestampUs);
+
+    uint16_t buffer[2 * MIC_BLOCK_SAMPLES];
+    MicDmaSource* source;
+    uint32_t sampleRateHz;
+    NotifyFn notify;
+    void* notifyCtx;
+    bool running;
+
+    std::atomic<uint8_t> readyMask;   // Bit n set = half n holds an unconsumed block
+    std::atomic<uint32_t> completed;
+    std::atomic<uint32_t> overruns;
+    uint32_t halfSequence[2];
+    uint32_t halfTimestampUs[2];
+    std::atomic<int8_t> held;         // Half handed out by acquire(), -1 when none
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include "MicSources.h"
+
+#if defined(ARDUINO) && defined(TARGET_STM32F4)
+#include "Arduino.h"
+#include "pinmap.h"
+#include "PeripheralPins.h"
+
+Stm32AdcDmaSource* Stm32AdcDmaSource::instance = nullptr;
+
+Stm32AdcDmaSource::Stm32AdcDmaSource(PinName pin) : pin(pin), capture(nullptr) {}
+
+bool Stm32AdcDmaSource::start(MicCapture* capture, uint16_t* buffer, uint16_t totalSamples, uint32_t sampleRateHz) {
+    // DMA2 Stream0 / Channel0 is hard-wired to ADC1
+    if ((ADCName)pinmap_peripheral(pin, PinMap_ADC) != ADC_1) return false;
+    uint32_t channel = STM_PIN_CHANNEL(pinmap_function(pin, PinMap_ADC));
+    pinmap_pinout(pin, PinMap_ADC);
+
+    this->capture = capture;
+    instance = this;
+
+    __HAL_RCC_ADC1_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    MIC_ADC_TIMER_CLK_ENABLE();
+
+    // Timer update at the sample rate; APB1 timers run at 2x PCLK1 when it is divided
+    uint32_t timerClock = HAL_RCC_GetPCLK1Freq();
+    if ((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1) timerClock *= 2;
+    timer.Instance = MIC_ADC_TIMER;
+    timer.Init.Prescaler = 0;
+    timer.Init.CounterMode = TIM_COUNTERMODE_UP;
+    timer.Init.Period = timerClock / sampleRateHz - 1;
+    timer.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    timer.Init.RepetitionCounter = 0;
+    if (HAL_TIM_Base_Init(&timer) != HAL_OK) return false;
+    TIM_MasterConfigTypeDef master;
+    master.MasterOutputTrigger = TIM_TRGO_UPDATE;
+    master.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+    HAL_TIMEx_MasterConfigSynchronization(&timer, &master);
+
+    dma.Instance = DMA2_Stream0;
+    dma.Init.Channel = DMA_CHANNEL_0;
+    dma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    dma.Init.PeriphInc = DMA_PINC_DISABLE;
+    dma.Init.MemInc = DMA_MINC_ENABLE;
+    dma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    dma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    dma.Init.Mode = DMA_CIRCULAR;
+    dma.Init.Priority = DMA_PRIORITY_HIGH;
+    dma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&dma) != HAL_OK) return false;
+    __HAL_LINKDMA(&adc, DMA_Handle, dma);
+
+    // One regular channel, converted on each timer trigger
+    adc.Instance = ADC1;
+    adc.Init.ClockPrescaler = ADC_CLOCK_SYNC_PCLK_DIV4;
+    adc.Init.Resolution = ADC_RESOLUTION_12B;
+    adc.Init.ScanConvMode = DISABLE;
+    adc.Init.ContinuousConvMode = DISABLE;
+    adc.Init.DiscontinuousConvMode = DISABLE;
+    adc.Init.ExternalTrigConvEdge = ADC_EXTERNALTRIGCONVEDGE_RISING;
+    adc.Init.ExternalTrigConv = MIC_ADC_TRIGGER;
+    adc.Init.DataAlign = ADC_DATAALIGN_RIGHT;
+    adc.Init.NbrOfConversion = 1;
+    adc.Init.DMAContinuousRequests = ENABLE;
+    adc.Init.EOCSelection = ADC_EOC_SINGLE_CONV;
+    if (HAL_ADC_Init(&adc) != HAL_OK) return false;
+
+    ADC_ChannelConfTypeDef config;
+    config.Channel = channel;
+    config.Rank = 1;
+    config.SamplingTime = ADC_SAMPLETIME_84CYCLES;
+    config.Offset = 0;
+    if (HAL_ADC_ConfigChannel(&adc, &config) != HAL_OK) return false;
+
+    NVIC_SetVector(DMA2_Stream0_IRQn, (uint32_t)&Stm32AdcDmaSource::dmaIrq);
+    HAL_NVIC_SetPriority(DMA2_Stream0_IRQn, 2, 0);
+    HAL_NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    if (HAL_ADC_Start_DMA(&adc, (uint32_t*)buffer, totalSamples) != HAL_OK) return false;
+    return HAL_TIM_Base_Start(&timer) == HAL_OK;
+}
+
+void Stm32AdcDmaSource::stop() {
+    HAL_TIM_Base_Stop(&timer);
+    HAL_ADC_Stop_DMA(&adc);
+    HAL_NVIC_DisableIRQ(DMA2_Stream0_IRQn);
+}
+
+void Stm32AdcDmaSource::onHalfTransfer() {
+    capture->onHalfComplete(micros());
+}
+
+void Stm32AdcDmaSource::onTransferComplete() {
+    capture->onComplete(micros());
+}
+
+void Stm32AdcDmaSource::dmaIrq() {
+    if (instance != nullptr) {
+        HAL_DMA_IRQHandler(&instance->dma);
+    }
+}
+
+bool Stm32AdcDmaSource::dispatchHalfTransfer(ADC_HandleTypeDef* hadc) {
+    if (instance == nullptr || hadc != &instance->adc) return false;
+    instance->onHalfTransfer();
+    return true;
+}
+
+bool Stm32AdcDmaSource::dispatchTransferComplete(ADC_HandleTypeDef* hadc) {
+    if (instance == nullptr || hadc != &instance->adc) return false;
+    instance->onTransferComplete();
+    return true;
+}
+
+#if MIC_ADC_HAL_CALLBACKS
+// Strong definitions of the HAL's weak hooks (see MIC_ADC_HAL_CALLBACKS). Events from
+// any other ADC handle are ignored here rather than taken for microphone blocks.
+extern "C" void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc) {
+    Stm32AdcDmaSource::dispatchHalfTransfer(hadc);
+}
+
+extern "C" void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
+    Stm32AdcDmaSource::dispatchTransferComplete(hadc);
+}
+#endif
+#endif
+
+#ifndef ARDUINO
+#include <math.h>
+
+MockMicDmaSource::MockMicDmaSource() {
+    capture = nullptr;
+    buffer = nullptr;
+    totalSamples = 0;
+    periodUs = 0;
+    clockUs = 0;
+    residueUs = 0;
+    position = 0;
+    sampleIndex = 0;
+    noiseState = 0x12345678;
+    sampleRateHz = 0.0f;
+    dcLevel = 2048;
+    toneAmplitude = 0;
+    toneHz = 1000.0f;
+    noiseAmplitude = 8;
+    running = false;
+}
+
+void MockMicDmaSource::setSignal(uint16_t dcLevel, uint16_t toneAmplitude, float toneHz, uint16_t noiseAmplitude) {
+    this->dcLevel = dcLevel;
+    this->toneAmplitude = toneAmplitude;
+    this->toneHz = toneHz;
+    this->noiseAmplitude = noiseAmplitude;
+}
+
+bool MockMicDmaSource::start(MicCapture* capture, uint16_t* buffer, uint16_t totalSamples, uint32_t sampleRateHz) {
+    if (sampleRateHz == 0 || totalSamples < 2) return false;
+    this->capture = capture;
+    this->buffer = buffer;
+    this->totalSamples = totalSamples;
+    this->sampleRateHz = (float)sampleRateHz;
+    periodUs = 1000000 / sampleRateHz;
+    position = 0;
+    residueUs = 0;
+    running = true;
+    return true;
+}
+
+void MockMicDmaSource::stop() {
+    running = false;
+}
+
+uint16_t MockMicDmaSource::nextSample() {
+    float t = sampleIndex / sampleRateHz;
+    float value = dcLevel + toneAmplitude * sinf(6.2831853f * toneHz * t);
+
+    // LCG noise, uniform in [-noiseAmplitude, noiseAmplitude]
+    noiseState = noiseState * 1664525u + 1013904223u;
+    if (noiseAmplitude > 0) {
+        value += (int32_t)(noiseState >> 16) % (2 * noiseAmplitude + 1) - noiseAmplitude;
+    }
+    sampleIndex++;
+
+    if (value < 0.0f) value = 0.0f;
+    if (value > 4095.0f) value = 4095.0f;
+    return (uint16_t)value;
+}
+
+void MockMicDmaSource::advance(uint32_t elapsedUs) {
+    if (!running) {
+        clockUs += elapsedUs;
+        return;
+    }
+
+    residueUs += elapsedUs;
+    while (residueUs >= periodUs) {
+        residueUs -= periodUs;
+        clockUs += periodUs;
+        buffer[position++] = nextSample();
+
+        if (position == totalSamples / 2) {
+            capture->onHalfComplete(clockUs);
+        } else if (position == totalSamples) {
+            position = 0;
+            capture->onComplete(clockUs);
+        }
+    }
+}
+
+uint32_t MockMicDmaSource::nowUs() const {
+    return clockUs + residueUs;
+}
+#endif
@@ -0,0 +1,90 @@
+#ifndef MicSources_H
+#define MicSources_H
+
+#include <stdint.h>
+#include "MicCapture.h"
+
+#if defined(ARDUINO) && defined(TARGET_STM32F4)
+#include "mbed.h"
+
+// Timer used to pace the ADC (TRGO on update); must not be claimed by PWM pins
+#ifndef MIC_ADC_TIMER
+#define MIC_ADC_TIMER TIM3
+#define MIC_ADC_TIMER_CLK_ENABLE() __HAL_RCC_TIM3_CLK_ENABLE()
+#define MIC_ADC_TRIGGER ADC_EXTERNALTRIGCONV_T3_TRGO
+#endif
+
+// The HAL reports ADC DMA half/complete events through HAL_ADC_ConvHalfCpltCallback and
+// HAL_ADC_ConvCpltCallback, one global pair for every ADC. MicSources.cpp defines them,
+// which overrides the HAL's weak defaults for the whole image. If another module needs
+// them too, build with MIC_ADC_HAL_CALLBACKS=0 and call dispatchHalfTransfer() /
+// dispatchTransferComplete() from that module's definitions.
+#ifndef MIC_ADC_HAL_CALLBACKS
+#define MIC_ADC_HAL_CALLBACKS 1
+#endif
+
+// ADC1 conversions triggered by a hardware timer, moved by DMA2 Stream0 into the
+// circular buffer. Half-transfer and transfer-complete interrupts report the halves.
+// The pin must be routed to ADC1; analogRead() must not be used on ADC1 while running.
+class Stm32AdcDmaSource : public MicDmaSource {
+public:
+    explicit Stm32AdcDmaSource(PinName pin);
+    bool start(MicCapture* capture, uint16_t* buffer, uint16_t totalSamples, uint32_t sampleRateHz) override;
+    void stop() override;
+
+    // Called from the HAL ADC callbacks; false when the event belongs to another ADC handle
+    static bool dispatchHalfTransfer(ADC_HandleTypeDef* hadc);
+    static bool dispatchTransferComplete(ADC_HandleTypeDef* hadc);
+    void onHalfTransfer();
+    void onTransferComplete();
+    static Stm32AdcDmaSource* instance;
+
+private:
+    static void dmaIrq();
+
+    PinName pin;
+    MicCapture* capture;
+    ADC_HandleTypeDef adc;
+    DMA_HandleTypeDef dma;
+    TIM_HandleTypeDef timer;
+};
+#endif
+
+#ifndef ARDUINO
+// Host stand-in for the ADC+DMA pair: synthesises a DC level, a tone and noise at the
+// configured rate and fires the half/complete callbacks as simulated time advances,
+// so block processing can be exercised and timed on a workstation.
+class MockMicDmaSource : public MicDmaSource {
+public:
+    MockMicDmaSource();
+    void setSignal(uint16_t dcLevel, uint16_t toneAmplitude, float toneHz, uint16_t noiseAmplitude);
+
+    bool start(MicCapture* capture, uint16_t* buffer, uint16_t totalSamples, uint32_t sampleRateHz) override;
+    void stop() override;
+
+    // Convert every sample due in the next elapsedUs, firing callbacks on the way
+    void advance(uint32_t elapsedUs);
+    uint32_t nowUs() const;
+
+private:
+    uint16_t nextSample();
+
+    MicCapture* capture;
+    uint16_t* buffer;
+    uint16_t totalSamples;
+    uint32_t periodUs;
+    uint32_t clockUs;
+    uint32_t residueUs;
+    uint16_t position;
+    uint32_t sampleIndex;
+    uint32_t noiseState;
+    float sampleRateHz;
+    uint16_t dcLevel;
+    uint16_t toneAmplitude;
+    float toneHz;
+    uint16_t noiseAmplitude;
+    bool running;
+};
+#endif
+
+#endif
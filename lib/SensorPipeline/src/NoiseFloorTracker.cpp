@@ -0,0 +1,88 @@
+#include "NoiseFloorTracker.h"
+
+// Level smoothing before the minimum search: y += (x - y) / 4 per block
+#define NOISE_FLOOR_SMOOTHING_SHIFT 2
+
+NoiseFloorTracker::NoiseFloorTracker() {
+    subwindowMs = 1000;
+    subwindows = 8;
+    biasDbQ8 = 0;
+    smoothedQ8 = 0;
+    primed = false;
+    currentMin = INT32_MAX;
+    subwindowStartMs = 0;
+    minimaCount = 0;
+    minimaIndex = 0;
+    floorDbQ8.store(0);
+    converged.store(false);
+    seeded.store(false);
+}
+
+void NoiseFloorTracker::begin(uint32_t subwindowMs, uint8_t subwindows, int32_t biasDbQ8) {
+    this->subwindowMs = subwindowMs ? subwindowMs : 1;
+    if (subwindows < 1) subwindows = 1;
+    if (subwindows > NOISE_FLOOR_MAX_SUBWINDOWS) subwindows = NOISE_FLOOR_MAX_SUBWINDOWS;
+    this->subwindows = subwindows;
+    this->biasDbQ8 = biasDbQ8;
+    primed = false;
+    currentMin = INT32_MAX;
+    minimaCount = 0;
+    minimaIndex = 0;
+    converged.store(false);
+    seeded.store(false);
+}
+
+void NoiseFloorTracker::seed(int32_t floorDbQ8) {
+    // Fill the history with the stored floor; fresh minima age it out within one window
+    minimaCount = 0;
+    minimaIndex = 0;
+    for (uint8_t i = 0; i < subwindows; i++) {
+        pushMinimum(floorDbQ8 - biasDbQ8);
+    }
+    this->floorDbQ8.store(floorDbQ8, std::memory_order_relaxed);
+    seeded.store(true, std::memory_order_relaxed);
+    converged.store(true, std::memory_order_release);
+}
+
+void NoiseFloorTracker::update(int32_t levelDbQ8, uint32_t nowMs) {
+    if (!primed) {
+        smoothedQ8 = levelDbQ8;
+        subwindowStartMs = nowMs;
+        primed = true;
+    } else {
+        smoothedQ8 += (levelDbQ8 - smoothedQ8) >> NOISE_FLOOR_SMOOTHING_SHIFT;
+    }
+    if (smoothedQ8 < currentMin) currentMin = smoothedQ8;
+
+    if (nowMs - subwindowStartMs >= subwindowMs) {
+        pushMinimum(currentMin);
+        currentMin = smoothedQ8;
+        subwindowStartMs = nowMs;
+        converged.store(true, std::memory_order_release);
+    }
+
+    // The running sub-window counts too, so a quieter room shows up immediately
+    int32_t floor = currentMin;
+    for (uint8_t i = 0; i < minimaCount; i++) {
+        if (minima[i] < floor) floor = minima[i];
+    }
+    floorDbQ8.store(floor + biasDbQ8, std::memory_order_relaxed);
+}
+
+void NoiseFloorTracker::pushMinimum(int32_t minimum) {
+    minima[minimaIndex] = minimum;
+    minimaIndex = (minimaIndex + 1) % subwindows;
+    if (minimaCount < subwindows) minimaCount++;
+}
+
+int32_t NoiseFloorTracker::getFloorDbQ8() const {
+    return floorDbQ8.load(std::memory_order_relaxed);
+}
+
+bool NoiseFloorTracker::isConverged() const {
+    return converged.load(std::memory_order_acquire);
+}
+
+bool NoiseFloorTracker::isSeeded() const {
+    return seeded.load(std::memory_order_relaxed);
+}
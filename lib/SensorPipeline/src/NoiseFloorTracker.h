@@ -0,0 +1,56 @@
+#ifndef NoiseFloorTracker_H
+#define NoiseFloorTracker_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Upper bound on sub-windows kept for the running minimum
+#ifndef NOISE_FLOOR_MAX_SUBWINDOWS
+#define NOISE_FLOOR_MAX_SUBWINDOWS 16
+#endif
+
+// Background noise floor by minimum statistics.
+//
+// Block levels (Q8 dB) are smoothed over a few blocks and the minimum is tracked per
+// sub-window; the floor is the smallest of the last `subwindows` minima plus a bias
+// correction, because the minimum of a fluctuating level sits below its mean. Speech
+// and transients rarely hold a sub-window's minimum, so the estimate follows the
+// background: it drops at once when the room gets quieter and rises after at most
+// subwindows * subwindowMs when it gets louder. O(1) per block, never blocks.
+class NoiseFloorTracker {
+public:
+    NoiseFloorTracker();
+    void begin(uint32_t subwindowMs, uint8_t subwindows, int32_t biasDbQ8);
+
+    // Warm start, e.g. from a stored floor: counts as converged until real data replaces it
+    void seed(int32_t floorDbQ8);
+
+    // One block level; timestamps only need to be monotonic (wrap-safe)
+    void update(int32_t levelDbQ8, uint32_t nowMs);
+
+    int32_t getFloorDbQ8() const;
+    bool isConverged() const;
+    bool isSeeded() const;
+
+private:
+    void pushMinimum(int32_t minimum);
+
+    uint32_t subwindowMs;
+    uint8_t subwindows;
+    int32_t biasDbQ8;
+
+    int32_t smoothedQ8;
+    bool primed;
+    int32_t currentMin;
+    uint32_t subwindowStartMs;
+
+    int32_t minima[NOISE_FLOOR_MAX_SUBWINDOWS];
+    uint8_t minimaCount;
+    uint8_t minimaIndex;
+
+    std::atomic<int32_t> floorDbQ8;
+    std::atomic<bool> converged;
+    std::atomic<bool> seeded;
+};
+
+#endif
@@ -0,0 +1,298 @@
+#include "OrientationFilter.h"
+#include <math.h>
+#include <string.h>
+
+static const float RAD_TO_DEG_F = 57.2957795f;
+static const float DEG_TO_RAD_F = 0.0174532925f;
+
+float fastInvSqrt(float x) {
+    float halfX = 0.5f * x;
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5F3759DF - (bits >> 1);
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - halfX * y * y);
+    return y * (1.5f - halfX * y * y);
+}
+
+float tiltCompensatedHeading(float mx, float my, float mz, float rollDeg, float pitchDeg) {
+    float roll = rollDeg * DEG_TO_RAD_F;
+    float pitch = pitchDeg * DEG_TO_RAD_F;
+    float sinRoll = sinf(roll), cosRoll = cosf(roll);
+    float sinPitch = sinf(pitch), cosPitch = cosf(pitch);
+
+    // Rotate the field back into the horizontal plane before taking the angle
+    float xh = mx * cosPitch + my * sinRoll * sinPitch + mz * cosRoll * sinPitch;
+    float yh = my * cosRoll - mz * sinRoll;
+
+    float heading = atan2f(-yh, xh) * RAD_TO_DEG_F;
+    return (heading < 0.0f) ? heading + 360.0f : heading;
+}
+
+OrientationFilter::OrientationFilter() {
+    samplePeriod = 0.01f;
+    beta = AHRS_MADGWICK_BETA;
+    kp = AHRS_MAHONY_KP;
+    ki = AHRS_MAHONY_KI;
+    reset();
+}
+
+void OrientationFilter::begin(float sampleRateHz) {
+    if (sampleRateHz > 0.0f) samplePeriod = 1.0f / sampleRateHz;
+    reset();
+}
+
+void OrientationFilter::setSamplePeriod(float seconds) {
+    samplePeriod = seconds;
+}
+
+void OrientationFilter::setGains(float beta, float kp, float ki) {
+    this->beta = beta;
+    this->kp = kp;
+    this->ki = ki;
+}
+
+void OrientationFilter::reset() {
+    q0 = 1.0f;
+    q1 = q2 = q3 = 0.0f;
+    integralX = integralY = integralZ = 0.0f;
+    initialized = false;
+}
+
+void OrientationFilter::initialize(float ax, float ay, float az, float mx, float my, float mz, bool hasMag) {
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+    float yaw = hasMag ? tiltCompensatedHeading(mx, my, mz, roll * RAD_TO_DEG_F, pitch * RAD_TO_DEG_F) * DEG_TO_RAD_F
+                       : 0.0f;
+
+    // Z-Y-X Euler -> quaternion
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    float cy = cosf(yaw * 0.5f), sy = sinf(yaw * 0.5f);
+    q0 = cr * cp * cy + sr * sp * sy;
+    q1 = sr * cp * cy - cr * sp * sy;
+    q2 = cr * sp * cy + sr * cp * sy;
+    q3 = cr * cp * sy - sr * sp * cy;
+    integralX = integralY = integralZ = 0.0f;
+    initialized = true;
+}
+
+void OrientationFilter::update(float gx, float gy, float gz, float ax, float ay, float az) {
+#if AHRS_ALGORITHM == AHRS_MAHONY
+    mahony(gx, gy, gz, ax, ay, az, 0.0f, 0.0f, 0.0f, false);
+#else
+    madgwickImu(gx, gy, gz, ax, ay, az);
+#endif
+}
+
+void OrientationFilter::update(float gx, float gy, float gz, float ax, float ay, float az,
+                               float mx, float my, float mz) {
+    // A zero field (sensor missing or saturated) cannot give a heading
+    if (mx == 0.0f && my == 0.0f && mz == 0.0f) {
+        update(gx, gy, gz, ax, ay, az);
+        return;
+    }
+#if AHRS_ALGORITHM == AHRS_MAHONY
+    mahony(gx, gy, gz, ax, ay, az, mx, my, mz, true);
+#else
+    madgwickMarg(gx, gy, gz, ax, ay, az, mx, my, mz);
+#endif
+}
+
+bool OrientationFilter::isInitialized() const {
+    return initialized;
+}
+
+Quaternion OrientationFilter::getQuaternion() const {
+    Quaternion q = {q0, q1, q2, q3};
+    return q;
+}
+
+EulerAngles OrientationFilter::getEuler() const {
+    EulerAngles e;
+    e.roll = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD_TO_DEG_F;
+
+    float sinPitch = 2.0f * (q0 * q2 - q3 * q1);
+    if (sinPitch > 1.0f) sinPitch = 1.0f;
+    if (sinPitch < -1.0f) sinPitch = -1.0f;
+    e.pitch = asinf(sinPitch) * RAD_TO_DEG_F;
+
+    e.yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * RAD_TO_DEG_F;
+    if (e.yaw < 0.0f) e.yaw += 360.0f;
+    return e;
+}
+
+void OrientationFilter::integrateRate(float qDot0, float qDot1, float qDot2, float qDot3) {
+    q0 += qDot0 * samplePeriod;
+    q1 += qDot1 * samplePeriod;
+    q2 += qDot2 * samplePeriod;
+    q3 += qDot3 * samplePeriod;
+
+    float norm = fastInvSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= norm;
+    q1 *= norm;
+    q2 *= norm;
+    q3 *= norm;
+    initialized = true;
+}
+
+// Madgwick, "An efficient orientation filter for inertial and inertial/magnetic
+// sensor arrays" (2010) - gradient-descent correction towards gravity
+void OrientationFilter::madgwickImu(float gx, float gy, float gz, float ax, float ay, float az) {
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    // Free fall / no accelerometer: integrate the gyro alone
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float norm = fastInvSqrt(ax * ax + ay * ay + az * az);
+        ax *= norm;
+        ay *= norm;
+        az *= norm;
+
+        float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+        float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+        float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+        float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+        float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+        float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 + _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+        float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 + _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+        float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+        float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sNorm > 0.0f) {
+            sNorm = fastInvSqrt(sNorm);
+            qDot0 -= beta * s0 * sNorm;
+            qDot1 -= beta * s1 * sNorm;
+            qDot2 -= beta * s2 * sNorm;
+            qDot3 -= beta * s3 * sNorm;
+        }
+    }
+
+    integrateRate(qDot0, qDot1, qDot2, qDot3);
+}
+
+void OrientationFilter::madgwickMarg(float gx, float gy, float gz, float ax, float ay, float az,
+                                     float mx, float my, float mz) {
+    if (ax == 0.0f && ay == 0.0f && az == 0.0f) {
+        madgwickImu(gx, gy, gz, ax, ay, az);
+        return;
+    }
+
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+    float norm = fastInvSqrt(ax * ax + ay * ay + az * az);
+    ax *= norm;
+    ay *= norm;
+    az *= norm;
+    norm = fastInvSqrt(mx * mx + my * my + mz * mz);
+    mx *= norm;
+    my *= norm;
+    mz *= norm;
+
+    float _2q0mx = 2.0f * q0 * mx, _2q0my = 2.0f * q0 * my, _2q0mz = 2.0f * q0 * mz, _2q1mx = 2.0f * q1 * mx;
+    float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+    float _2q0q2 = 2.0f * q0 * q2, _2q2q3 = 2.0f * q2 * q3;
+    float q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    float q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    float q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+
+    // Earth-frame field direction, flattened to [bx, 0, bz]
+    float hx = mx * q0q0 - _2q0my * q3 + _2q0mz * q2 + mx * q1q1 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+    float hy = _2q0mx * q3 + my * q0q0 - _2q0mz * q1 + _2q1mx * q2 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+    float _2bx = sqrtf(hx * hx + hy * hy);
+    float _2bz = -_2q0mx * q2 + _2q0my * q1 + mz * q0q0 + _2q1mx * q3 - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+    float _4bx = 2.0f * _2bx;
+    float _4bz = 2.0f * _2bz;
+
+    float s0 = -_2q2 * (2.0f * q1q3 - _2q0q2 - ax) + _2q1 * (2.0f * q0q1 + _2q2q3 - ay)
+             - _2bz * q2 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+             + (-_2bx * q3 + _2bz * q1) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+             + _2bx * q2 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+    float s1 = _2q3 * (2.0f * q1q3 - _2q0q2 - ax) + _2q0 * (2.0f * q0q1 + _2q2q3 - ay)
+             - 4.0f * q1 * (1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az)
+             + _2bz * q3 * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+             + (_2bx * q2 + _2bz * q0) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+             + (_2bx * q3 - _4bz * q1) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+    float s2 = -_2q0 * (2.0f * q1q3 - _2q0q2 - ax) + _2q3 * (2.0f * q0q1 + _2q2q3 - ay)
+             - 4.0f * q2 * (1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az)
+             + (-_4bx * q2 - _2bz * q0) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+             + (_2bx * q1 + _2bz * q3) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+             + (_2bx * q0 - _4bz * q2) * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+    float s3 = _2q1 * (2.0f * q1q3 - _2q0q2 - ax) + _2q2 * (2.0f * q0q1 + _2q2q3 - ay)
+             + (-_4bx * q3 + _2bz * q1) * (_2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx)
+             + (-_2bx * q0 + _2bz * q2) * (_2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my)
+             + _2bx * q1 * (_2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz);
+    float sNorm = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    if (sNorm > 0.0f) {
+        sNorm = fastInvSqrt(sNorm);
+        qDot0 -= beta * s0 * sNorm;
+        qDot1 -= beta * s1 * sNorm;
+        qDot2 -= beta * s2 * sNorm;
+        qDot3 -= beta * s3 * sNorm;
+    }
+
+    integrateRate(qDot0, qDot1, qDot2, qDot3);
+}
+
+// Mahony, "Nonlinear complementary filters on the special orthogonal group" (2008) -
+// PI feedback of the cross product between measured and estimated directions
+void OrientationFilter::mahony(float gx, float gy, float gz, float ax, float ay, float az,
+                               float mx, float my, float mz, bool useMag) {
+    if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+        float norm = fastInvSqrt(ax * ax + ay * ay + az * az);
+        ax *= norm;
+        ay *= norm;
+        az *= norm;
+
+        // Estimated gravity direction in the body frame
+        float vx = 2.0f * (q1 * q3 - q0 * q2);
+        float vy = 2.0f * (q0 * q1 + q2 * q3);
+        float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (useMag) {
+            norm = fastInvSqrt(mx * mx + my * my + mz * mz);
+            mx *= norm;
+            my *= norm;
+            mz *= norm;
+
+            // Reference field in the earth frame, then back into the body frame
+            float hx = 2.0f * (mx * (0.5f - q2 * q2 - q3 * q3) + my * (q1 * q2 - q0 * q3) + mz * (q1 * q3 + q0 * q2));
+            float hy = 2.0f * (mx * (q1 * q2 + q0 * q3) + my * (0.5f - q1 * q1 - q3 * q3) + mz * (q2 * q3 - q0 * q1));
+            float bx = sqrtf(hx * hx + hy * hy);
+            float bz = 2.0f * (mx * (q1 * q3 - q0 * q2) + my * (q2 * q3 + q0 * q1) + mz * (0.5f - q1 * q1 - q2 * q2));
+            float wx = 2.0f * (bx * (0.5f - q2 * q2 - q3 * q3) + bz * (q1 * q3 - q0 * q2));
+            float wy = 2.0f * (bx * (q1 * q2 - q0 * q3) + bz * (q0 * q1 + q2 * q3));
+            float wz = 2.0f * (bx * (q0 * q2 + q1 * q3) + bz * (0.5f - q1 * q1 - q2 * q2));
+            ex += my * wz - mz * wy;
+            ey += mz * wx - mx * wz;
+            ez += mx * wy - my * wx;
+        }
+
+        if (ki > 0.0f) {
+            integralX += ki * ex * samplePeriod;
+            integralY += ki * ey * samplePeriod;
+            integralZ += ki * ez * samplePeriod;
+            gx += integralX;
+            gy += integralY;
+            gz += integralZ;
+        }
+        gx += kp * ex;
+        gy += kp * ey;
+        gz += kp * ez;
+    }
+
+    float qDot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+    float qDot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+    float qDot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+    float qDot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+    integrateRate(qDot0, qDot1, qDot2, qDot3);
+}
@@ -0,0 +1,85 @@
+#ifndef OrientationFilter_H
+#define OrientationFilter_H
+
+#include <stdint.h>
+
+// Fusion algorithm used by OrientationFilter
+#define AHRS_MADGWICK 0
+#define AHRS_MAHONY 1
+
+#ifndef AHRS_ALGORITHM
+#define AHRS_ALGORITHM AHRS_MADGWICK
+#endif
+
+#ifndef AHRS_MADGWICK_BETA
+#define AHRS_MADGWICK_BETA 0.1f         // Gradient-descent step (higher = trusts accel/mag more)
+#endif
+#ifndef AHRS_MAHONY_KP
+#define AHRS_MAHONY_KP 1.0f             // Proportional feedback gain
+#endif
+#ifndef AHRS_MAHONY_KI
+#define AHRS_MAHONY_KI 0.0f             // Integral (gyro bias) feedback gain
+#endif
+
+struct Quaternion {
+    float w, x, y, z;
+};
+
+// Degrees. yaw is 0..360 and grows counter-clockwise seen from above.
+struct EulerAngles {
+    float roll, pitch, yaw;
+};
+
+// 1/sqrt(x) from the bit-level estimate plus two Newton steps (~5e-6 relative error,
+// small enough not to bias the filter's steady state), no divide and no sqrt
+float fastInvSqrt(float x);
+
+// Tilt-compensated heading (degrees, 0..360) from a magnetic field vector and
+// roll/pitch in degrees, counter-clockwise seen from above like a positive gyro Z rate
+float tiltCompensatedHeading(float mx, float my, float mz, float rollDeg, float pitchDeg);
+
+// Quaternion attitude estimator (Madgwick or Mahony).
+//
+// Each update() integrates one gyro sample over a fixed period taken from the sensor
+// ODR and corrects it towards the accelerometer (and magnetometer when one is given).
+// The state stays a unit quaternion, so there is no gimbal lock at ±90° pitch and no
+// trigonometry per sample; getEuler() converts only when a result is reported.
+// Frame: x forward, z up (accelerometer reads +1g on z when flat); angular rates in
+// rad/s, accelerometer and magnetometer in any consistent units.
+class OrientationFilter {
+public:
+    OrientationFilter();
+
+    void begin(float sampleRateHz);
+    void setSamplePeriod(float seconds);
+    void setGains(float beta, float kp, float ki);
+    void reset();
+
+    // Snap straight to the attitude given by gravity (and the field, if hasMag)
+    void initialize(float ax, float ay, float az, float mx, float my, float mz, bool hasMag);
+
+    void update(float gx, float gy, float gz, float ax, float ay, float az);
+    void update(float gx, float gy, float gz, float ax, float ay, float az,
+                float mx, float my, float mz);
+
+    bool isInitialized() const;
+    Quaternion getQuaternion() const;
+    EulerAngles getEuler() const;
+
+private:
+    float q0, q1, q2, q3;             // Attitude, body -> earth
+    float samplePeriod;               // Seconds per update()
+    float beta;                       // Madgwick gain
+    float kp, ki;                     // Mahony gains
+    float integralX, integralY, integralZ;
+    bool initialized;
+
+    void madgwickImu(float gx, float gy, float gz, float ax, float ay, float az);
+    void madgwickMarg(float gx, float gy, float gz, float ax, float ay, float az,
+                      float mx, float my, float mz);
+    void mahony(float gx, float gy, float gz, float ax, float ay, float az,
+                float mx, float my, float mz, bool useMag);
+    void integrateRate(float qDot0, float qDot1, float qDot2, float qDot3);
+};
+
+#endif
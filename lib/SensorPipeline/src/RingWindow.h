@@ -0,0 +1,127 @@
+#ifndef RingWindow_H
+#define RingWindow_H
+
+#include <stdint.h>
+
+// Sliding window over the last N values of one channel (structure of arrays: use one
+// window per channel rather than one window of structs).
+//
+// N must be a power of two so slots are found with a mask. Every statistic costs O(1)
+// per push (amortised) whatever N is:
+//   - mean/variance: sliding Welford update (add the new value, remove the evicted one),
+//     recomputed exactly once per N pushes so float rounding cannot drift for weeks;
+//   - min/max: monotonic deques of sequence numbers, each value enters and leaves once.
+template <typename T, uint32_t N>
+class RingWindow {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "RingWindow size must be a power of two");
+
+public:
+    RingWindow() {
+        clear();
+    }
+
+    void clear() {
+        pushes = 0;
+        count = 0;
+        meanValue = 0.0f;
+        m2 = 0.0f;
+        minHead = minTail = 0;
+        maxHead = maxTail = 0;
+    }
+
+    void push(const T& value) {
+        uint32_t seq = pushes;
+        float x = (float)value;
+
+        // Retire the value that is about to be overwritten from the deques
+        if (count == N) {
+            uint32_t evicted = seq - N;
+            if (minHead != minTail && minSeq[minHead & MASK] == evicted) minHead++;
+            if (maxHead != maxTail && maxSeq[maxHead & MASK] == evicted) maxHead++;
+
+            // Sliding Welford: replace the evicted value in place
+            float old = (float)values[seq & MASK];
+            float oldMean = meanValue;
+            meanValue += (x - old) / N;
+            m2 += (x - old) * (x - meanValue + old - oldMean);
+        } else {
+            count++;
+            float delta = x - meanValue;
+            meanValue += delta / count;
+            m2 += delta * (x - meanValue);
+        }
+        values[seq & MASK] = value;
+        pushes = seq + 1;
+
+        while (minTail != minHead && !(values[minSeq[(minTail - 1) & MASK] & MASK] < value)) minTail--;
+        minSeq[minTail++ & MASK] = seq;
+        while (maxTail != maxHead && !(value < values[maxSeq[(maxTail - 1) & MASK] & MASK])) maxTail--;
+        maxSeq[maxTail++ & MASK] = seq;
+
+        if ((pushes & MASK) == 0) {
+            resync();
+        }
+    }
+
+    // Fill every slot with one value (e.g. a known starting point)
+    void fill(const T& value) {
+        clear();
+        for (uint32_t i = 0; i < N; i++) push(value);
+    }
+
+    uint32_t size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    bool isFull() const { return count == N; }
+    static uint32_t capacity() { return N; }
+
+    // Total values ever pushed (sequence number of the next one)
+    uint32_t totalPushed() const { return pushes; }
+
+    // age 0 = newest, size() - 1 = oldest
+    const T& at(uint32_t age) const { return values[(pushes - 1 - age) & MASK]; }
+    const T& newest() const { return at(0); }
+    const T& oldest() const { return at(count - 1); }
+
+    float mean() const { return meanValue; }
+
+    // Population variance of the values in the window
+    float variance() const {
+        if (count < 2) return 0.0f;
+        float v = m2 / count;
+        return v > 0.0f ? v : 0.0f;
+    }
+
+    // Only meaningful when !isEmpty()
+    const T& min() const { return values[minSeq[minHead & MASK] & MASK]; }
+    const T& max() const { return values[maxSeq[maxHead & MASK] & MASK]; }
+
+private:
+    static const uint32_t MASK = N - 1;
+
+    // Exact two-pass mean/M2 over the window; runs once per N pushes
+    void resync() {
+        float sum = 0.0f;
+        for (uint32_t i = 0; i < count; i++) sum += (float)at(i);
+        meanValue = sum / count;
+        float acc = 0.0f;
+        for (uint32_t i = 0; i < count; i++) {
+            float d = (float)at(i) - meanValue;
+            acc += d * d;
+        }
+        m2 = acc;
+    }
+
+    T values[N];
+    uint32_t pushes;
+    uint32_t count;
+    float meanValue;
+    float m2;
+
+    // Deques hold sequence numbers; values are read back through the main buffer
+    uint32_t minSeq[N];
+    uint32_t maxSeq[N];
+    uint32_t minHead, minTail;
+    uint32_t maxHead, maxTail;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef SensorScales_H
+#define SensorScales_H
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+// Gravity used for accelerometer scaling (matches the 9.81 used by the motion code)
+#define SENSOR_GRAVITY_MPS2 9.81
+
+// ----------------------------------------------------------------------------
+// LSM6DS3 sensitivities, indexed by the register field value, as Q32 multipliers
+// for q16ScaleRaw(). Output units: m/s² (accelerometer) and degrees/s (gyroscope).
+// ----------------------------------------------------------------------------
+
+// CTRL1_XL FS_XL[1:0]: 00 = ±2g, 01 = ±16g, 10 = ±4g, 11 = ±8g
+constexpr int32_t LSM6DS3_ACCEL_SCALE_Q32[4] = {
+    q32ScaleFromDouble(0.061e-3 * SENSOR_GRAVITY_MPS2),
+    q32ScaleFromDouble(0.488e-3 * SENSOR_GRAVITY_MPS2),
+    q32ScaleFromDouble(0.122e-3 * SENSOR_GRAVITY_MPS2),
+    q32ScaleFromDouble(0.244e-3 * SENSOR_GRAVITY_MPS2)
+};
+
+// CTRL2_G FS_G[1:0]: 00 = 245dps, 01 = 500dps, 10 = 1000dps, 11 = 2000dps;
+// entry 4 is the FS_125 bit (125dps)
+constexpr int32_t LSM6DS3_GYRO_SCALE_Q32[5] = {
+    q32ScaleFromDouble(8.75e-3),
+    q32ScaleFromDouble(17.50e-3),
+    q32ScaleFromDouble(35.0e-3),
+    q32ScaleFromDouble(70.0e-3),
+    q32ScaleFromDouble(4.375e-3)
+};
+
+#define LSM6DS3_GYRO_FS_125 4
+
+constexpr int32_t lsm6ds3AccelScaleQ32(uint8_t fsCode) {
+    return LSM6DS3_ACCEL_SCALE_Q32[fsCode & 0x03];
+}
+
+constexpr int32_t lsm6ds3GyroScaleQ32(uint8_t fsCode) {
+    return LSM6DS3_GYRO_SCALE_Q32[fsCode > LSM6DS3_GYRO_FS_125 ? 0 : fsCode];
+}
+
+// Full-scale code -> range ordering must hold or the tables are mis-keyed
+static_assert(LSM6DS3_ACCEL_SCALE_Q32[0] < LSM6DS3_ACCEL_SCALE_Q32[2] &&
+              LSM6DS3_ACCEL_SCALE_Q32[2] < LSM6DS3_ACCEL_SCALE_Q32[3] &&
+              LSM6DS3_ACCEL_SCALE_Q32[3] < LSM6DS3_ACCEL_SCALE_Q32[1],
+              "LSM6DS3 accel scale table out of FS_XL order");
+static_assert(LSM6DS3_GYRO_SCALE_Q32[4] < LSM6DS3_GYRO_SCALE_Q32[0] &&
+              LSM6DS3_GYRO_SCALE_Q32[0] < LSM6DS3_GYRO_SCALE_Q32[1] &&
+              LSM6DS3_GYRO_SCALE_Q32[1] < LSM6DS3_GYRO_SCALE_Q32[2] &&
+              LSM6DS3_GYRO_SCALE_Q32[2] < LSM6DS3_GYRO_SCALE_Q32[3],
+              "LSM6DS3 gyro scale table out of FS_G order");
+
+// Full-scale raw count at ±16g must stay inside Q16 (|v| < 32768)
+static_assert((int64_t)32767 * LSM6DS3_ACCEL_SCALE_Q32[1] / 65536 < ((int64_t)1 << 31),
+              "LSM6DS3 ±16g does not fit Q16.16");
+static_assert((int64_t)32767 * LSM6DS3_GYRO_SCALE_Q32[3] / 65536 < ((int64_t)1 << 31),
+              "LSM6DS3 2000dps does not fit Q16.16");
+
+// LIS2MDL: fixed 1.5 mgauss/LSB = 0.15 µT/LSB (±49.15 gauss full scale)
+constexpr int32_t LIS2MDL_SCALE_Q32 = q32ScaleFromDouble(0.15);
+
+constexpr q16_t GRAVITY_Q16 = q16FromDouble(SENSOR_GRAVITY_MPS2);
+
+#endif
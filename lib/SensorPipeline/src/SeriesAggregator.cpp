@@ -0,0 +1,159 @@
+#include "SeriesAggregator.h"
+#include <math.h>
+
+void SeriesStats::clear() {
+    count = 0;
+    min = 0.0f;
+    max = 0.0f;
+    mean = 0.0f;
+    m2 = 0.0f;
+}
+
+void SeriesStats::add(float x) {
+    if (count == 0) {
+        min = max = x;
+    } else {
+        if (x < min) min = x;
+        if (x > max) max = x;
+    }
+    count++;
+    float delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+}
+
+void SeriesStats::merge(const SeriesStats& other) {
+    if (other.count == 0) return;
+    if (count == 0) {
+        *this = other;
+        return;
+    }
+    uint32_t total = count + other.count;
+    float delta = other.mean - mean;
+    float weight = (float)other.count / total;
+    mean += delta * weight;
+    m2 += other.m2 + delta * delta * count * weight;
+    if (other.min < min) min = other.min;
+    if (other.max > max) max = other.max;
+    count = total;
+}
+
+float SeriesStats::variance() const {
+    if (count < 2) return 0.0f;
+    float v = m2 / count;
+    return v > 0.0f ? v : 0.0f;
+}
+
+float SeriesStats::stddev() const {
+    return sqrtf(variance());
+}
+
+SeriesAggregator::SeriesAggregator() {
+    channels = 0;
+    periodMs[0] = 1000;
+    periodMs[1] = 10000;
+    periodMs[2] = 60000;
+    reset();
+}
+
+void SeriesAggregator::begin(uint8_t channels, uint32_t basePeriodMs, uint8_t tier1Periods, uint8_t tier2Periods) {
+    if (channels > SERIES_MAX_CHANNELS) channels = SERIES_MAX_CHANNELS;
+    this->channels = channels;
+    periodMs[0] = basePeriodMs ? basePeriodMs : 1;
+    periodMs[1] = periodMs[0] * (tier1Periods ? tier1Periods : 1);
+    periodMs[2] = periodMs[1] * (tier2Periods ? tier2Periods : 1);
+    reset();
+}
+
+void SeriesAggregator::reset() {
+    for (uint8_t t = 0; t < SERIES_TIERS; t++) {
+        open[t] = false;
+        openIndex[t] = 0;
+        closedStartMs[t] = 0;
+        closedCount[t] = 0;
+        for (uint8_t c = 0; c < SERIES_MAX_CHANNELS; c++) {
+            pending[t][c].clear();
+            closed[t][c].clear();
+        }
+    }
+}
+
+void SeriesAggregator::add(const float* values, uint32_t nowMs) {
+    advance(nowMs);
+    for (uint8_t c = 0; c < channels; c++) {
+        if (isnan(values[c])) continue;
+        pending[0][c].add(values[c]);
+    }
+}
+
+void SeriesAggregator::addSummary(uint8_t channel, const SeriesStats& summary, uint32_t nowMs) {
+    if (channel >= channels) return;
+    advance(nowMs);
+    pending[0][channel].merge(summary);
+}
+
+void SeriesAggregator::advance(uint32_t nowMs) {
+    // Close every tier whose period has ended, lowest first so each feeds the next
+    for (uint8_t t = 0; t < SERIES_TIERS; t++) {
+        if (open[t] && nowMs / periodMs[t] != openIndex[t]) {
+            close(t);
+        }
+    }
+
+    if (!open[0]) {
+        open[0] = true;
+        openIndex[0] = nowMs / periodMs[0];
+    }
+}
+
+void SeriesAggregator::close(uint8_t tier) {
+    uint32_t startMs = openIndex[tier] * periodMs[tier];
+    for (uint8_t c = 0; c < channels; c++) {
+        closed[tier][c] = pending[tier][c];
+    }
+    closedStartMs[tier] = startMs;
+    closedCount[tier]++;
+
+    uint8_t up = tier + 1;
+    if (up < SERIES_TIERS) {
+        // A summary always lands in the upper period that contains its start
+        uint32_t upIndex = startMs / periodMs[up];
+        if (open[up] && upIndex != openIndex[up]) {
+            close(up);
+        }
+        if (!open[up]) {
+            open[up] = true;
+            openIndex[up] = upIndex;
+        }
+        for (uint8_t c = 0; c < channels; c++) {
+            pending[up][c].merge(pending[tier][c]);
+        }
+    }
+
+    for (uint8_t c = 0; c < channels; c++) {
+        pending[tier][c].clear();
+    }
+    open[tier] = false;
+}
+
+uint8_t SeriesAggregator::getChannelCount() const {
+    return channels;
+}
+
+uint32_t SeriesAggregator::getPeriodMs(uint8_t tier) const {
+    return tier < SERIES_TIERS ? periodMs[tier] : 0;
+}
+
+uint32_t SeriesAggregator::getClosedCount(uint8_t tier) const {
+    return tier < SERIES_TIERS ? closedCount[tier] : 0;
+}
+
+const SeriesStats& SeriesAggregator::getSummary(uint8_t tier, uint8_t channel) const {
+    if (tier >= SERIES_TIERS) tier = SERIES_TIERS - 1;
+    if (channel >= SERIES_MAX_CHANNELS) channel = 0;
+    return closed[tier][channel];
+}
+
+uint32_t SeriesAggregator::getSummaryStartMs(uint8_t tier) const {
+    return tier < SERIES_TIERS ? closedStartMs[tier] : 0;
+}
@@ -0,0 +1,77 @@
+#ifndef SeriesAggregator_H
+#define SeriesAggregator_H
+
+#include <stdint.h>
+
+// Upper bound on channels summarised side by side
+#ifndef SERIES_MAX_CHANNELS
+#define SERIES_MAX_CHANNELS 8
+#endif
+
+// Tier 0 summarises raw samples, each higher tier summarises the one below
+#define SERIES_TIERS 3
+
+// min/max/mean/variance of a run of samples. Two summaries merge exactly (Chan et al.
+// pairwise update), so a tier never has to see the raw samples of the one below.
+struct SeriesStats {
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+    float m2;                         // Sum of squared deviations from the mean
+
+    void clear();
+    void add(float x);
+    void merge(const SeriesStats& other);
+    float variance() const;           // Population variance
+    float stddev() const;
+};
+
+// Cascading time-series summaries for several channels.
+//
+// Samples go into tier 0; when a tier's period ends its summary is published and merged
+// into the tier above, which closes the same way on its own, longer period. Periods are
+// aligned to multiples of the period on the millisecond clock, and a tier closes on the
+// first sample after its period ends, so stalled callers just produce fewer, wider
+// summaries. Spikes survive every tier through min/max. O(channels) per sample; no heap.
+class SeriesAggregator {
+public:
+    SeriesAggregator();
+
+    // Tier 0 period, then how many periods of the tier below make tiers 1 and 2
+    void begin(uint8_t channels, uint32_t basePeriodMs, uint8_t tier1Periods, uint8_t tier2Periods);
+    void reset();
+
+    // One value per channel; timestamps only need to be monotonic. A NaN value means
+    // the channel has no reading this time and is left out (its count stays lower)
+    void add(const float* values, uint32_t nowMs);
+    // Every sample one channel took since the last call, summarised by the caller (a
+    // channel read much faster than add() is called). Lands in the period open at nowMs.
+    void addSummary(uint8_t channel, const SeriesStats& summary, uint32_t nowMs);
+
+    uint8_t getChannelCount() const;
+    uint32_t getPeriodMs(uint8_t tier) const;
+
+    // Latest closed summary of a tier; getClosedCount() changes every time one closes
+    uint32_t getClosedCount(uint8_t tier) const;
+    const SeriesStats& getSummary(uint8_t tier, uint8_t channel) const;
+    uint32_t getSummaryStartMs(uint8_t tier) const;
+
+private:
+    void advance(uint32_t nowMs);
+    void close(uint8_t tier);
+
+    uint8_t channels;
+    uint32_t periodMs[SERIES_TIERS];
+
+    // Open period per tier: index = startMs / periodMs
+    uint32_t openIndex[SERIES_TIERS];
+    bool open[SERIES_TIERS];
+    SeriesStats pending[SERIES_TIERS][SERIES_MAX_CHANNELS];
+
+    SeriesStats closed[SERIES_TIERS][SERIES_MAX_CHANNELS];
+    uint32_t closedStartMs[SERIES_TIERS];
+    uint32_t closedCount[SERIES_TIERS];
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "SoundActivity.h"
+
+SoundActivityDetector::SoundActivityDetector() {
+    config.onMarginDbQ8 = 6 * 256;
+    config.offMarginDbQ8 = 3 * 256;
+    config.strongMarginDbQ8 = 15 * 256;
+    config.onsetBlocks = 2;
+    config.hangoverMs = 800;
+    config.voiceMinHz = 80;
+    config.voiceMaxHz = 1500;
+    config.noiseMinHz = 1800;
+    sampleRateHz = 8000;
+    onsetCount = 0;
+    lastActiveMs = 0;
+    activeState = false;
+    active.store(false);
+    voice.store(false);
+    activations.store(0);
+}
+
+void SoundActivityDetector::begin(const SoundActivityConfig& config, uint32_t sampleRateHz) {
+    this->config = config;
+    this->sampleRateHz = sampleRateHz;
+    onsetCount = 0;
+    activeState = false;
+    active.store(false);
+    voice.store(false);
+}
+
+void SoundActivityDetector::update(int32_t levelDbQ8, int32_t floorDbQ8, uint16_t zeroCrossings, uint16_t samples, uint32_t nowMs) {
+    if (samples == 0) return;
+
+    int32_t margin = levelDbQ8 - floorDbQ8;
+    // Two crossings per period of the dominant component
+    uint32_t zcrHz = (uint32_t)zeroCrossings * sampleRateHz / (2u * samples);
+
+    bool strong = margin >= config.strongMarginDbQ8;
+    bool loudEnough = margin >= (activeState ? config.offMarginDbQ8 : config.onMarginDbQ8);
+    bool blockActive = strong || (loudEnough && zcrHz < config.noiseMinHz);
+
+    if (blockActive) {
+        if (onsetCount < 255) onsetCount++;
+        if (activeState || strong || onsetCount >= config.onsetBlocks) {
+            if (!activeState) {
+                activeState = true;
+                activations.fetch_add(1, std::memory_order_relaxed);
+            }
+            lastActiveMs = nowMs;
+            voice.store(zcrHz >= config.voiceMinHz && zcrHz <= config.voiceMaxHz, std::memory_order_relaxed);
+        }
+    } else {
+        onsetCount = 0;
+        if (activeState && nowMs - lastActiveMs > config.hangoverMs) {
+            activeState = false;
+            voice.store(false, std::memory_order_relaxed);
+        }
+    }
+    active.store(activeState, std::memory_order_release);
+}
+
+bool SoundActivityDetector::isActive() const {
+    return active.load(std::memory_order_acquire);
+}
+
+bool SoundActivityDetector::isVoice() const {
+    return voice.load(std::memory_order_relaxed);
+}
+
+uint32_t SoundActivityDetector::getActivations() const {
+    return activations.load(std::memory_order_relaxed);
+}
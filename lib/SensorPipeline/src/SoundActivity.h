@@ -0,0 +1,54 @@
+#ifndef SoundActivity_H
+#define SoundActivity_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Thresholds for SoundActivityDetector, levels relative to the noise floor in Q8 dB
+struct SoundActivityConfig {
+    int32_t onMarginDbQ8;             // Block counts as active this far above the floor
+    int32_t offMarginDbQ8;            // ... and stays active down to this margin
+    int32_t strongMarginDbQ8;         // Active on the first block whatever its ZCR (impacts)
+    uint8_t onsetBlocks;              // Consecutive active blocks needed otherwise
+    uint32_t hangoverMs;              // Stay active this long after the last active block
+    uint16_t voiceMinHz;              // ZCR-implied frequency range of voiced sound
+    uint16_t voiceMaxHz;
+    uint16_t noiseMinHz;              // Above this a block is hiss-like, needs the strong margin
+};
+
+// Energy + zero-crossing-rate activity detector with hangover.
+//
+// Each block's level is compared with the tracked noise floor and its zero-crossing
+// count turned into an implied frequency (crossings / 2 per second). Blocks well above
+// the floor are active unless they look like broadband hiss; onset needs a couple of
+// blocks unless the jump is large, and a hangover bridges the pauses between words.
+// "Voice" marks activity whose ZCR sits in the voiced-speech range. Written by the
+// audio thread, read from any.
+class SoundActivityDetector {
+public:
+    SoundActivityDetector();
+    void begin(const SoundActivityConfig& config, uint32_t sampleRateHz);
+
+    // One block: level and noise floor in Q8 dB, zero crossings over `samples`
+    void update(int32_t levelDbQ8, int32_t floorDbQ8, uint16_t zeroCrossings, uint16_t samples, uint32_t nowMs);
+
+    bool isActive() const;
+    bool isVoice() const;
+
+    // Inactive -> active transitions so far
+    uint32_t getActivations() const;
+
+private:
+    SoundActivityConfig config;
+    uint32_t sampleRateHz;
+
+    uint8_t onsetCount;
+    uint32_t lastActiveMs;
+    bool activeState;
+
+    std::atomic<bool> active;
+    std::atomic<bool> voice;
+    std::atomic<uint32_t> activations;
+};
+
+#endif
@@ -0,0 +1,140 @@
+#include "SoundLevel.h"
+#include "FixedPoint.h"
+
+SoundLevelMeter::SoundLevelMeter() {
+    sampleRateHz = 0;
+    alphaQ15 = 32767;
+    refRmsDbQ8 = 0;
+    refPeakDbQ8 = 0;
+    offsetDbQ8 = 0;
+    fast.length = 1;
+    leq.length = 1;
+    reset();
+}
+
+void SoundLevelMeter::begin(uint32_t sampleRateHz, uint8_t adcBits, uint16_t highPassHz, uint16_t fastMs, uint16_t leqMs) {
+    this->sampleRateHz = sampleRateHz;
+
+    // a = 1 - 2*pi*fc/fs, fine for fc well below fs
+    int32_t drop = (int32_t)((uint64_t)205887 * highPassHz / (sampleRateHz ? sampleRateHz : 1));  // 2*pi in Q15
+    alphaQ15 = 32768 - drop;
+    if (alphaQ15 > 32767) alphaQ15 = 32767;
+    if (alphaQ15 < 0) alphaQ15 = 0;
+
+    // Full-scale peak is half the code range; a full-scale sine has half its square as mean
+    uint32_t fullScale = (uint32_t)1 << (adcBits - 1);
+    refPeakDbQ8 = powerDbQ8((uint64_t)fullScale * fullScale);
+    refRmsDbQ8 = powerDbQ8(((uint64_t)fullScale * fullScale) >> 1);
+
+    fast.length = (uint32_t)((uint64_t)sampleRateHz * fastMs / 1000);
+    leq.length = (uint32_t)((uint64_t)sampleRateHz * leqMs / 1000);
+    if (fast.length == 0) fast.length = 1;
+    if (leq.length == 0) leq.length = 1;
+    reset();
+}
+
+void SoundLevelMeter::reset() {
+    x1 = 0;
+    y1Q8 = 0;
+    primed = false;
+    negative = false;
+    fast.sumSquares = 0;
+    fast.samples = 0;
+    fast.peak = 0;
+    leq.sumSquares = 0;
+    leq.samples = 0;
+    leq.peak = 0;
+    int32_t floorQ8 = SOUND_DB_Q8(SOUND_LEVEL_FLOOR_DB) + offsetDbQ8;
+    blockDbQ8.store(floorQ8);
+    fastDbQ8.store(floorQ8);
+    leqDbQ8.store(floorQ8);
+    peakDbQ8.store(floorQ8);
+    leqCount.store(0);
+    blockCrossings.store(0);
+}
+
+void SoundLevelMeter::setReferenceDb(int16_t fullScaleDb) {
+    offsetDbQ8 = SOUND_DB_Q8(fullScaleDb);
+}
+
+void SoundLevelMeter::process(const uint16_t* samples, uint16_t count, uint8_t shift) {
+    if (count == 0) return;
+    if (!primed) {
+        // Start the filter on the first sample's DC level instead of a zero step
+        x1 = (int32_t)samples[0] << shift;
+        primed = true;
+    }
+
+    uint64_t blockSum = 0;
+    uint16_t crossings = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        int32_t x = (int32_t)samples[i] << shift;
+        y1Q8 = ((x - x1) << 8) + (int32_t)(((int64_t)alphaQ15 * y1Q8) >> 15);
+        x1 = x;
+
+        int32_t y = y1Q8 >> 8;
+        uint32_t sq = (uint32_t)(y * y);
+        uint16_t mag = (uint16_t)(y < 0 ? -y : y);
+        blockSum += sq;
+        if ((y < 0) != negative) {
+            negative = y < 0;
+            crossings++;
+        }
+
+        fast.sumSquares += sq;
+        if (mag > fast.peak) fast.peak = mag;
+        if (++fast.samples >= fast.length) closeWindow(fast, fastDbQ8);
+
+        leq.sumSquares += sq;
+        if (mag > leq.peak) leq.peak = mag;
+        if (++leq.samples >= leq.length) {
+            peakDbQ8.store(leq.peak ? powerDbQ8((uint64_t)leq.peak * leq.peak) - refPeakDbQ8 + offsetDbQ8
+                                    : SOUND_DB_Q8(SOUND_LEVEL_FLOOR_DB) + offsetDbQ8, std::memory_order_relaxed);
+            closeWindow(leq, leqDbQ8);
+            leqCount.fetch_add(1, std::memory_order_release);
+        }
+    }
+    blockDbQ8.store(energyToDbQ8(blockSum, count), std::memory_order_relaxed);
+    blockCrossings.store(crossings, std::memory_order_relaxed);
+}
+
+void SoundLevelMeter::closeWindow(Window& w, std::atomic<int32_t>& level) {
+    level.store(energyToDbQ8(w.sumSquares, w.samples), std::memory_order_relaxed);
+    w.sumSquares = 0;
+    w.samples = 0;
+    w.peak = 0;
+}
+
+int32_t SoundLevelMeter::energyToDbQ8(uint64_t sumSquares, uint32_t samples) const {
+    if (sumSquares == 0 || samples == 0) {
+        return SOUND_DB_Q8(SOUND_LEVEL_FLOOR_DB) + offsetDbQ8;
+    }
+    // 10*log10(sum/n) = 10*log10(sum) - 10*log10(n): no division needed
+    int32_t db = powerDbQ8(sumSquares) - powerDbQ8(samples) - refRmsDbQ8 + offsetDbQ8;
+    int32_t floorQ8 = SOUND_DB_Q8(SOUND_LEVEL_FLOOR_DB) + offsetDbQ8;
+    return db < floorQ8 ? floorQ8 : db;
+}
+
+int32_t SoundLevelMeter::getBlockDbQ8() const {
+    return blockDbQ8.load(std::memory_order_relaxed);
+}
+
+int32_t SoundLevelMeter::getFastDbQ8() const {
+    return fastDbQ8.load(std::memory_order_relaxed);
+}
+
+int32_t SoundLevelMeter::getLeqDbQ8() const {
+    return leqDbQ8.load(std::memory_order_relaxed);
+}
+
+int32_t SoundLevelMeter::getPeakDbQ8() const {
+    return peakDbQ8.load(std::memory_order_relaxed);
+}
+
+uint16_t SoundLevelMeter::getBlockZeroCrossings() const {
+    return blockCrossings.load(std::memory_order_relaxed);
+}
+
+uint32_t SoundLevelMeter::getLeqCount() const {
+    return leqCount.load(std::memory_order_acquire);
+}
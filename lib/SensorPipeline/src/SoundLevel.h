@@ -0,0 +1,84 @@
+#ifndef SoundLevel_H
+#define SoundLevel_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Levels are Q8 dB (1/256 dB). 0 dB is a full-scale sine (RMS) or a full-scale peak,
+// shifted by the reference offset so a calibrated offset yields dB SPL.
+#define SOUND_DB_Q8(db) ((int32_t)((db) * 256))
+
+// Reported when a window holds no energy at all
+#ifndef SOUND_LEVEL_FLOOR_DB
+#define SOUND_LEVEL_FLOOR_DB -120
+#endif
+
+// Block sound level meter working on raw ADC codes, integer-only per sample.
+//
+// Each sample passes a one-pole DC-blocking high-pass, y = x - x1 + a*y1, and its
+// square is summed in integers. Block RMS, a short "fast" Leq and a longer Leq with the
+// peak held over the same window are published as Q8 dB; the logarithm is taken once
+// per block/window, never per sample. Written by one thread, read from any.
+class SoundLevelMeter {
+public:
+    SoundLevelMeter();
+
+    // adcBits: resolution of the codes fed to process() (sets 0 dBFS).
+    // fastMs/leqMs: integration windows for getFastDbQ8()/getLeqDbQ8().
+    void begin(uint32_t sampleRateHz, uint8_t adcBits, uint16_t highPassHz, uint16_t fastMs, uint16_t leqMs);
+    void reset();
+
+    // dB added to every level, e.g. the SPL of a full-scale sine for the mic front end
+    void setReferenceDb(int16_t fullScaleDb);
+
+    // Raw unsigned codes; `shift` scales them up to adcBits (e.g. 2 for 10-bit reads)
+    void process(const uint16_t* samples, uint16_t count, uint8_t shift = 0);
+
+    int32_t getBlockDbQ8() const;
+    int32_t getFastDbQ8() const;
+    int32_t getLeqDbQ8() const;
+    int32_t getPeakDbQ8() const;
+
+    // Sign changes of the filtered signal in the last block (zero-crossing rate)
+    uint16_t getBlockZeroCrossings() const;
+
+    // Completed Leq windows, so readers can tell a fresh value from a stale one
+    uint32_t getLeqCount() const;
+
+    // Q8 dB of a mean square (sum / samples) against the meter's reference
+    int32_t energyToDbQ8(uint64_t sumSquares, uint32_t samples) const;
+
+private:
+    struct Window {
+        uint64_t sumSquares;
+        uint32_t samples;
+        uint32_t length;
+        uint16_t peak;
+    };
+
+    void closeWindow(Window& w, std::atomic<int32_t>& level);
+
+    uint32_t sampleRateHz;
+    int32_t alphaQ15;                 // High-pass pole
+    int32_t refRmsDbQ8;               // 10*log10(full-scale sine mean square)
+    int32_t refPeakDbQ8;              // 10*log10(full-scale peak squared)
+    int32_t offsetDbQ8;
+
+    // High-pass state; y1 carries 8 extra fractional bits
+    int32_t x1;
+    int32_t y1Q8;
+    bool primed;
+    bool negative;                    // Sign of the previous filtered sample
+
+    Window fast;
+    Window leq;
+
+    std::atomic<int32_t> blockDbQ8;
+    std::atomic<int32_t> fastDbQ8;
+    std::atomic<int32_t> leqDbQ8;
+    std::atomic<int32_t> peakDbQ8;
+    std::atomic<uint16_t> blockCrossings;
+    std::atomic<uint32_t> leqCount;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "SpectrumAnalyzer.h"
+#include "FixedPoint.h"
+#include "SoundLevel.h"
+#include <math.h>
+#include <string.h>
+
+#if SPECTRUM_USE_DSP
+#include "cmsis.h"
+#endif
+
+// Normalise blocks to 14 bits; accumulated powers are scaled to the largest shift
+#define SPECTRUM_MAX_SHIFT 14
+#define SPECTRUM_INPUT_MAX 16383
+// Bits dropped from accumulated powers so SPECTRUM_REPORT_FRAMES * N * P fits 64 bits
+#define SPECTRUM_ACC_DROP 8
+
+// Lower band edges in Hz; the last band runs to Nyquist
+static const uint16_t BAND_EDGES_HZ[SPECTRUM_BANDS] = {63, 125, 250, 500, 1000, 1500, 2000, 3000};
+
+static inline uint32_t packComplex(int32_t re, int32_t im) {
+    return ((uint32_t)(uint16_t)re) | ((uint32_t)(uint16_t)im << 16);
+}
+
+static inline int16_t realPart(uint32_t z) {
+    return (int16_t)(z & 0xFFFF);
+}
+
+static inline int16_t imagPart(uint32_t z) {
+    return (int16_t)(z >> 16);
+}
+
+// w * b for w = cos - j*sin packed as (cos, sin), Q15
+static inline uint32_t twiddleMul(uint32_t w, uint32_t b) {
+#if SPECTRUM_USE_DSP
+    int32_t re = __SMUAD(w, b) >> 15;
+    int32_t im = __SMUSDX(w, b) >> 15;
+#else
+    int32_t c = realPart(w), s = imagPart(w);
+    int32_t br = realPart(b), bi = imagPart(b);
+    int32_t re = (c * br + s * bi) >> 15;
+    int32_t im = (c * bi - s * br) >> 15;
+#endif
+    return packComplex(re, im);
+}
+
+// (a + b) / 2 and (a - b) / 2 on both halves
+static inline uint32_t halvingAdd(uint32_t a, uint32_t b) {
+#if SPECTRUM_USE_DSP
+    return __SHADD16(a, b);
+#else
+    return packComplex((realPart(a) + realPart(b)) >> 1, (imagPart(a) + imagPart(b)) >> 1);
+#endif
+}
+
+static inline uint32_t halvingSub(uint32_t a, uint32_t b) {
+#if SPECTRUM_USE_DSP
+    return __SHSUB16(a, b);
+#else
+    return packComplex((realPart(a) - realPart(b)) >> 1, (imagPart(a) - imagPart(b)) >> 1);
+#endif
+}
+
+static uint16_t bitReverse(uint16_t v, uint8_t bits) {
+    uint16_t r = 0;
+    for (uint8_t i = 0; i < bits; i++) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+    return r;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer() {
+    sampleRateHz = 0;
+    refDbQ8 = 0;
+    offsetDbQ8 = 0;
+    memset(window, 0, sizeof(window));
+    memset(twiddle, 0, sizeof(twiddle));
+    publishSeq.store(0);
+    reset();
+}
+
+void SpectrumAnalyzer::begin(uint32_t sampleRateHz, int16_t referenceDb) {
+    this->sampleRateHz = sampleRateHz;
+    offsetDbQ8 = SOUND_DB_Q8(referenceDb);
+
+    // Tables are built once; the per-sample path never touches floating point
+    const float twoPi = 6.28318531f;
+    for (uint16_t n = 0; n < SPECTRUM_FFT_SIZE; n++) {
+        float w = 0.5f - 0.5f * cosf(twoPi * n / SPECTRUM_FFT_SIZE);
+        int32_t q = (int32_t)(w * 32767.0f + 0.5f);
+        window[n] = (int16_t)(q > 32767 ? 32767 : q);
+    }
+    for (uint16_t k = 0; k < HALF; k++) {
+        float angle = twoPi * k / SPECTRUM_FFT_SIZE;
+        twiddle[k] = packComplex((int32_t)lrintf(cosf(angle) * 32767.0f), (int32_t)lrintf(sinf(angle) * 32767.0f));
+    }
+
+    // One-sided power of a full-scale Hann-windowed sine after the 1/(N/2) FFT scaling:
+    // (2048 * 2^14)^2 * 3/8, less the dropped accumulator bits
+    refDbQ8 = powerDbQ8((uint64_t)3 << (50 - 3 - SPECTRUM_ACC_DROP));
+    reset();
+}
+
+void SpectrumAnalyzer::reset() {
+    memset(binPower, 0, sizeof(binPower));
+    framesInReport = 0;
+    frameCount = 0;
+}
+
+bool SpectrumAnalyzer::process(const uint16_t* samples, uint16_t count) {
+    if (count < SPECTRUM_FFT_SIZE || sampleRateHz == 0) return false;
+
+    int32_t sum = 0;
+    for (uint16_t n = 0; n < SPECTRUM_FFT_SIZE; n++) sum += samples[n];
+    int32_t mean = sum / SPECTRUM_FFT_SIZE;
+
+    int32_t peak = 0;
+    for (uint16_t n = 0; n < SPECTRUM_FFT_SIZE; n++) {
+        int32_t d = (int32_t)samples[n] - mean;
+        if (d < 0) d = -d;
+        if (d > peak) peak = d;
+    }
+
+    frameCount++;
+    if (peak > 0) {
+        // Block floating point: use the full 14 bits whatever the input level
+        uint8_t shift = 0;
+        while (shift < SPECTRUM_MAX_SHIFT && (peak << (shift + 1)) <= SPECTRUM_INPUT_MAX) shift++;
+
+        // Even samples real, odd samples imaginary, stored in bit-reversed order
+        uint8_t bits = 0;
+        while ((1u << bits) < HALF) bits++;
+        for (uint16_t k = 0; k < HALF; k++) {
+            int32_t xr = ((((int32_t)samples[2 * k] - mean) << shift) * window[2 * k]) >> 15;
+            int32_t xi = ((((int32_t)samples[2 * k + 1] - mean) << shift) * window[2 * k + 1]) >> 15;
+            work[bitReverse(k, bits)] = packComplex(xr, xi);
+        }
+
+        fft(work);
+
+        // Split the N/2 complex bins into N/2 real-input bins (DC skipped)
+        int8_t accShift = 2 * (SPECTRUM_MAX_SHIFT - shift) - SPECTRUM_ACC_DROP;
+        for (uint16_t k = 1; k < HALF; k++) {
+            uint32_t zk = work[k];
+            uint32_t zm = work[HALF - k];
+            int32_t evenRe = (realPart(zk) + realPart(zm)) >> 1;
+            int32_t evenIm = (imagPart(zk) - imagPart(zm)) >> 1;
+            int32_t oddRe = (imagPart(zk) + imagPart(zm)) >> 1;
+            int32_t oddIm = (realPart(zm) - realPart(zk)) >> 1;
+
+            int32_t c = realPart(twiddle[k]), s = imagPart(twiddle[k]);
+            int32_t re = evenRe + ((c * oddRe + s * oddIm) >> 15);
+            int32_t im = evenIm + ((c * oddIm - s * oddRe) >> 15);
+
+            uint64_t power = (uint64_t)((int64_t)re * re) + (uint64_t)((int64_t)im * im);
+            binPower[k] += (accShift >= 0) ? (power << accShift) : (power >> -accShift);
+        }
+    }
+
+    if (++framesInReport >= SPECTRUM_REPORT_FRAMES) {
+        publish();
+        memset(binPower, 0, sizeof(binPower));
+        framesInReport = 0;
+    }
+    return true;
+}
+
+// In-place radix-2 decimation-in-time FFT on bit-reversed input, scaled by 1/2 per
+// stage so magnitudes never grow past the 14-bit input's sqrt(2) * 16383
+void SpectrumAnalyzer::fft(uint32_t* data) const {
+    for (uint16_t span = 2; span <= HALF; span <<= 1) {
+        uint16_t half = span >> 1;
+        uint16_t step = SPECTRUM_FFT_SIZE / span;
+        for (uint16_t group = 0; group < HALF; group += span) {
+            for (uint16_t j = 0; j < half; j++) {
+                uint32_t a = data[group + j];
+                uint32_t t = twiddleMul(twiddle[j * step], data[group + j + half]);
+                data[group + j] = halvingAdd(a, t);
+                data[group + j + half] = halvingSub(a, t);
+            }
+        }
+    }
+}
+
+void SpectrumAnalyzer::publish() {
+    SpectrumFeatures next;
+    const int32_t floorQ8 = SOUND_DB_Q8(SOUND_LEVEL_FLOOR_DB) + offsetDbQ8;
+    const int32_t framesDbQ8 = powerDbQ8(framesInReport);
+
+    uint16_t firstBin = 0;
+    for (uint8_t b = 0; b < SPECTRUM_BANDS; b++) {
+        uint16_t lo = (uint16_t)((uint32_t)BAND_EDGES_HZ[b] * SPECTRUM_FFT_SIZE / sampleRateHz);
+        uint16_t hi = (b + 1 < SPECTRUM_BANDS)
+            ? (uint16_t)((uint32_t)BAND_EDGES_HZ[b + 1] * SPECTRUM_FFT_SIZE / sampleRateHz) : HALF;
+        if (lo < 1) lo = 1;
+        if (hi > HALF) hi = HALF;
+        if (b == 0) firstBin = lo;
+
+        uint64_t energy = 0;
+        for (uint16_t k = lo; k < hi; k++) energy += binPower[k];
+        int32_t db = energy ? powerDbQ8(energy) - framesDbQ8 - refDbQ8 + offsetDbQ8 : floorQ8;
+        if (db < floorQ8) db = floorQ8;
+        next.bandDb[b] = (int16_t)((db >= 0) ? (db + 128) >> 8 : -((-db + 128) >> 8));
+    }
+
+    // Centroid and flatness over the analysed range, once per report
+    float weighted = 0.0f, total = 0.0f;
+    uint64_t sum = 0;
+    uint64_t sumLog2Q16 = 0;
+    uint16_t bins = 0;
+    for (uint16_t k = firstBin; k < HALF; k++) {
+        uint64_t p = binPower[k];
+        weighted += (float)k * (float)p;
+        total += (float)p;
+        sum += p;
+        sumLog2Q16 += log2Q16(p ? p : 1);
+        bins++;
+    }
+    float binHz = (float)sampleRateHz / SPECTRUM_FFT_SIZE;
+    next.centroidHz = (total > 0.0f) ? (uint16_t)(weighted / total * binHz + 0.5f) : 0;
+
+    float flatness = 0.0f;
+    if (sum > 0 && bins > 0) {
+        int32_t meanLog = (int32_t)(sumLog2Q16 / bins);
+        int32_t logMean = (int32_t)log2Q16(sum / bins ? sum / bins : 1);
+        flatness = exp2f((meanLog - logMean) / 65536.0f);
+        if (flatness > 1.0f) flatness = 1.0f;
+    }
+    next.flatnessQ15 = (uint16_t)(flatness * 32767.0f + 0.5f);
+    next.frames = framesInReport;
+
+    uint32_t seq = publishSeq.load(std::memory_order_relaxed);
+    next.sequence = seq >> 1;
+    publishSeq.store(seq + 1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    published = next;
+    publishSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool SpectrumAnalyzer::getFeatures(SpectrumFeatures& out) const {
+    uint32_t before, after;
+    do {
+        before = publishSeq.load(std::memory_order_acquire);
+        out = published;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = publishSeq.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return before != 0;
+}
+
+uint32_t SpectrumAnalyzer::getFrameCount() const {
+    return frameCount;
+}
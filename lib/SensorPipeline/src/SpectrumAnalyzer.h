@@ -0,0 +1,83 @@
+#ifndef SpectrumAnalyzer_H
+#define SpectrumAnalyzer_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Real FFT length (samples per analysed block, power of two)
+#ifndef SPECTRUM_FFT_SIZE
+#define SPECTRUM_FFT_SIZE 256
+#endif
+
+// Frames averaged into one published feature set (8 x 32ms at 8kHz)
+#ifndef SPECTRUM_REPORT_FRAMES
+#define SPECTRUM_REPORT_FRAMES 8
+#endif
+
+// Octave-ish bands from 62Hz to Nyquist, see SpectrumAnalyzer.cpp for the edges
+#define SPECTRUM_BANDS 8
+
+static_assert((SPECTRUM_FFT_SIZE & (SPECTRUM_FFT_SIZE - 1)) == 0 && SPECTRUM_FFT_SIZE >= 16,
+              "SPECTRUM_FFT_SIZE must be a power of two");
+
+// Cortex-M4/M7 packed 16-bit multiply-accumulate and halving add/subtract
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+#define SPECTRUM_USE_DSP 1
+#else
+#define SPECTRUM_USE_DSP 0
+#endif
+
+// Averaged spectrum summary for one report period
+struct SpectrumFeatures {
+    int16_t bandDb[SPECTRUM_BANDS];   // Band energy, same dB reference as SoundLevelMeter
+    uint16_t centroidHz;              // Power-weighted mean frequency
+    uint16_t flatnessQ15;             // Geometric / arithmetic mean power: 0 tonal .. 1 noise
+    uint16_t frames;                  // Frames averaged (0 = nothing published yet)
+    uint32_t sequence;                // Reports published before this one
+};
+
+// Fixed-point spectral analysis of microphone blocks.
+//
+// Each block has its mean removed and is normalised to 14 bits (block floating
+// point), Hann windowed and transformed with a Q15 real FFT: an N/2-point complex
+// radix-2 FFT scaled by 1/2 per stage, then the split step to N/2 real bins. Bin
+// powers are accumulated in integers; band energies, centroid and flatness are
+// derived once per SPECTRUM_REPORT_FRAMES and published for readers on other threads.
+class SpectrumAnalyzer {
+public:
+    SpectrumAnalyzer();
+    void begin(uint32_t sampleRateHz, int16_t referenceDb);
+    void reset();
+
+    // Transform the first SPECTRUM_FFT_SIZE raw 12-bit codes; shorter blocks are ignored
+    bool process(const uint16_t* samples, uint16_t count);
+
+    // Latest published features; false until the first report
+    bool getFeatures(SpectrumFeatures& out) const;
+
+    uint32_t getFrameCount() const;
+
+private:
+    static const uint16_t HALF = SPECTRUM_FFT_SIZE / 2;
+
+    void fft(uint32_t* data) const;
+    void publish();
+
+    uint32_t sampleRateHz;
+    int32_t refDbQ8;                  // Full-scale sine power in accumulator units
+    int32_t offsetDbQ8;
+
+    int16_t window[SPECTRUM_FFT_SIZE];    // Hann, Q15
+    uint32_t twiddle[HALF];               // exp(-2*pi*j*k/N): cos low, sin high, Q15
+    uint32_t work[HALF];                  // Packed complex re low / im high
+
+    uint64_t binPower[HALF];
+    uint16_t framesInReport;
+    uint32_t frameCount;
+
+    // Seqlock around the published copy: odd while the mic thread writes it
+    SpectrumFeatures published;
+    std::atomic<uint32_t> publishSeq;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SpscRing_H
+#define SpscRing_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Fixed-size lock-free single-producer/single-consumer ring.
+// The producer (ISR or acquisition thread) only writes `head`, the consumer (loop())
+// only writes `tail`, so no locking is needed as long as there is one of each.
+// N must be a power of two; one slot is never left empty because head/tail run freely
+// and are masked on access.
+template <typename T, uint32_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), dropped(0) {}
+
+    // Producer side. Returns false (and counts a drop) when the ring is full.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t >= N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        if (h == t) return false;
+        item = buffer[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies up to maxItems into out and returns how many were copied.
+    uint32_t popMany(T* out, uint32_t maxItems) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        uint32_t n = h - t;
+        if (n > maxItems) n = maxItems;
+        for (uint32_t i = 0; i < n; i++) {
+            out[i] = buffer[(t + i) & (N - 1)];
+        }
+        tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    uint32_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    uint32_t capacity() const {
+        return N;
+    }
+
+    // Items rejected because the consumer fell behind
+    uint32_t droppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    T buffer[N];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif
@@ -1,97 +1,151 @@
 #include <Arduino.h>
+#include <malloc.h>
+#include <type_traits>
+#include <atomic>
 #include "AZ3166WiFi.h"
 #include "Wire.h"
 #include "MXChipFirebase.h"
+#include "ImuAcquisition.h"
+#include "SensorBus.h"
+#include "I2CAsyncEngine.h"
+#include "I2CBackends.h"
+#include "FixedPoint.h"
+#include "SensorScales.h"
+#include "SensorRegisters.h"
+#include "OrientationFilter.h"
+#include "MicCapture.h"
+#include "MicSources.h"
+#include "SoundLevel.h"
+#include "SpectrumAnalyzer.h"
+#include "NoiseFloorTracker.h"
+#include "SoundActivity.h"
+#include "RingWindow.h"
+#include "SeriesAggregator.h"
+#include "LinearTrend.h"
+#include "AlertRules.h"
+#include "BandStateMachine.h"
+#include "FallDetector.h"
+#include "ActivityFeatures.h"
+#include "DecimationChain.h"
 
 // ============================================================================
 // DIRECT HARDWARE SENSOR IMPLEMENTATION
 // ============================================================================
 
+// Addresses below alias the compile-time register maps in SensorRegisters.h, which
+// also describe bit fields, reset values and auto-increment ranges for each part
+
 // I2C Addresses for Built-in Sensors
-#define HTS221_ADDR        0x5F    // Temperature & Humidity
-#define LSM6DS3_ADDR       0x6A    // Accelerometer & Gyroscope  
-#define LPS22HB_ADDR       0x5C    // Barometric Pressure
-#define LIS2MDL_ADDR       0x1E    // Magnetometer
+#define HTS221_ADDR        HTS221Map::i2cAddress    // Temperature & Humidity
+#define LPS22HB_ADDR       LPS22HBMap::i2cAddress    // Barometric Pressure
+#define LIS2MDL_ADDR       LIS2MDLMap::i2cAddress    // Magnetometer
 
 // HTS221 Register Map (Temperature & Humidity)
-#define HTS221_WHO_AM_I        0x0F
-#define HTS221_CTRL_REG1       0x20
-#define HTS221_CTRL_REG2       0x21
-#define HTS221_CTRL_REG3       0x22
-#define HTS221_STATUS_REG      0x27
-#define HTS221_TEMP_OUT_L      0x2A
-#define HTS221_TEMP_OUT_H      0x2B
-#define HTS221_HUMIDITY_OUT_L  0x28
-#define HTS221_HUMIDITY_OUT_H  0x29
-#define HTS221_CALIB_T0_DEGC_X8    0x32
-#define HTS221_CALIB_T1_DEGC_X8    0x33
-#define HTS221_CALIB_T0_T1_MSB     0x35
-#define HTS221_CALIB_T0_OUT_L      0x3C
-#define HTS221_CALIB_T0_OUT_H      0x3D
-#define HTS221_CALIB_T1_OUT_L      0x3E
-#define HTS221_CALIB_T1_OUT_H      0x3F
-#define HTS221_CALIB_H0_RH_X2      0x30
-#define HTS221_CALIB_H1_RH_X2      0x31
-#define HTS221_CALIB_H0_T0_OUT_L   0x36
-#define HTS221_CALIB_H0_T0_OUT_H   0x37
-#define HTS221_CALIB_H1_T0_OUT_L   0x3A
-#define HTS221_CALIB_H1_T0_OUT_H   0x3B
+#define HTS221_WHO_AM_I        HTS221Map::WHO_AM_I::address
+#define HTS221_CTRL_REG1       HTS221Map::CTRL_REG1::address
+#define HTS221_STATUS_REG      HTS221Map::STATUS_REG::address
+#define HTS221_TEMP_OUT_L      HTS221Map::TEMP_OUT_L::address
+#define HTS221_HUMIDITY_OUT_L  HTS221Map::HUMIDITY_OUT_L::address
+#define HTS221_CALIB_T0_DEGC_X8    HTS221Map::T0_DEGC_X8::address
+#define HTS221_CALIB_T1_DEGC_X8    HTS221Map::T1_DEGC_X8::address
+#define HTS221_CALIB_T0_T1_MSB     HTS221Map::T1_T0_MSB::address
+#define HTS221_CALIB_T0_OUT_L      HTS221Map::T0_OUT_L::address
+#define HTS221_CALIB_T1_OUT_L      HTS221Map::T1_OUT_L::address
+#define HTS221_CALIB_H0_RH_X2      HTS221Map::H0_RH_X2::address
+#define HTS221_CALIB_H1_RH_X2      HTS221Map::H1_RH_X2::address
+#define HTS221_CALIB_H0_T0_OUT_L   HTS221Map::H0_T0_OUT_L::address
+#define HTS221_CALIB_H1_T0_OUT_L   HTS221Map::H1_T0_OUT_L::address
+#define HTS221_CALIB_BLOCK_LEN     HTS221Map::CalibrationRead::length  // 0x30..0x3F
+#define HTS221_SMOOTHING_SAMPLES   4   // Moving average per channel (power of two)
 
 // LSM6DS3 Register Map (Accelerometer & Gyroscope)
-#define LSM6DS3_WHO_AM_I       0x0F
-#define LSM6DS3_CTRL1_XL       0x10
-#define LSM6DS3_CTRL2_G        0x11
-#define LSM6DS3_CTRL3_C        0x12
-#define LSM6DS3_CTRL4_C        0x13
-#define LSM6DS3_CTRL5_C        0x14
-#define LSM6DS3_CTRL6_C        0x15
-#define LSM6DS3_CTRL7_G        0x16
-#define LSM6DS3_CTRL8_XL       0x17
-#define LSM6DS3_CTRL9_XL       0x18
-#define LSM6DS3_CTRL10_C       0x19
-#define LSM6DS3_OUTX_L_XL      0x28
-#define LSM6DS3_OUTX_H_XL      0x29
-#define LSM6DS3_OUTY_L_XL      0x2A
-#define LSM6DS3_OUTY_H_XL      0x2B
-#define LSM6DS3_OUTZ_L_XL      0x2C
-#define LSM6DS3_OUTZ_H_XL      0x2D
-#define LSM6DS3_OUTX_L_G       0x22
-#define LSM6DS3_OUTX_H_G       0x23
-#define LSM6DS3_OUTY_L_G       0x24
-#define LSM6DS3_OUTY_H_G       0x25
-#define LSM6DS3_OUTZ_L_G       0x26
-#define LSM6DS3_OUTZ_H_G       0x27
+#define LSM6DS3_WHO_AM_I       LSM6DS3Map::WHO_AM_I::address
+#define LSM6DS3_CTRL1_XL       LSM6DS3Map::CTRL1_XL::address
+#define LSM6DS3_CTRL2_G        LSM6DS3Map::CTRL2_G::address
+#define LSM6DS3_CTRL3_C        LSM6DS3Map::CTRL3_C::address
+#define LSM6DS3_CTRL10_C       LSM6DS3Map::CTRL10_C::address
+#define LSM6DS3_INT1_CTRL      LSM6DS3Map::INT1_CTRL::address
+#define LSM6DS3_FIFO_CTRL1     LSM6DS3Map::FIFO_CTRL1::address
+#define LSM6DS3_FIFO_CTRL2     LSM6DS3Map::FIFO_CTRL2::address
+#define LSM6DS3_FIFO_CTRL3     LSM6DS3Map::FIFO_CTRL3::address
+#define LSM6DS3_FIFO_CTRL4     LSM6DS3Map::FIFO_CTRL4::address
+#define LSM6DS3_FIFO_CTRL5     LSM6DS3Map::FIFO_CTRL5::address
+#define LSM6DS3_FIFO_DATA_OUT_L LSM6DS3Map::FIFO_DATA_OUT_L::address
+#define LSM6DS3_TAP_CFG         LSM6DS3Map::TAP_CFG::address
+#define LSM6DS3_TAP_THS_6D      LSM6DS3Map::TAP_THS_6D::address
+#define LSM6DS3_WAKE_UP_THS     LSM6DS3Map::WAKE_UP_THS::address
+#define LSM6DS3_WAKE_UP_DUR     LSM6DS3Map::WAKE_UP_DUR::address
+#define LSM6DS3_FREE_FALL       LSM6DS3Map::FREE_FALL::address
+#define LSM6DS3_MD1_CFG         LSM6DS3Map::MD1_CFG::address
 
 // LPS22HB Register Map (Pressure)
-#define LPS22HB_WHO_AM_I       0x0F
-#define LPS22HB_CTRL_REG1      0x10
-#define LPS22HB_CTRL_REG2      0x11
-#define LPS22HB_CTRL_REG3      0x12
-#define LPS22HB_STATUS_REG     0x27
-#define LPS22HB_PRESS_OUT_XL   0x28
-#define LPS22HB_PRESS_OUT_L    0x29
-#define LPS22HB_PRESS_OUT_H    0x2A
-#define LPS22HB_TEMP_OUT_L     0x2B
-#define LPS22HB_TEMP_OUT_H     0x2C
+#define LPS22HB_WHO_AM_I       LPS22HBMap::WHO_AM_I::address
+#define LPS22HB_CTRL_REG1      LPS22HBMap::CTRL_REG1::address
+#define LPS22HB_CTRL_REG2      LPS22HBMap::CTRL_REG2::address
 
 // LIS2MDL Register Map (Magnetometer)
-#define LIS2MDL_WHO_AM_I       0x4F
-#define LIS2MDL_CFG_REG_A      0x60
-#define LIS2MD3_CFG_REG_C      0x62
-#define LIS2MDL_STATUS_REG     0x67
-#define LIS2MDL_OUTX_L_REG     0x68
-#define LIS2MDL_OUTX_H_REG     0x69
-#define LIS2MDL_OUTY_L_REG     0x6A
-#define LIS2MDL_OUTY_H_REG     0x6B
-#define LIS2MDL_OUTZ_L_REG     0x6C
-#define LIS2MDL_OUTZ_H_REG     0x6D
+#define LIS2MDL_WHO_AM_I       LIS2MDLMap::WHO_AM_I::address
+#define LIS2MDL_CFG_REG_A      LIS2MDLMap::CFG_REG_A::address
+#define LIS2MDL_CFG_REG_C      LIS2MDLMap::CFG_REG_C::address
+
+// LSM6DS3 interrupt line (INT1 - data-ready / FIFO watermark)
+#ifndef LSM6DS3_INT1_PIN
+#define LSM6DS3_INT1_PIN D4
+#endif
+#define LSM6DS3_INT1_DRDY_XL   RegisterValue<LSM6DS3Map::INT1_CTRL>().set<LSM6DS3Map::INT1_DRDY_XL>(1).value
+#define LSM6DS3_INT1_FTH       RegisterValue<LSM6DS3Map::INT1_CTRL>().set<LSM6DS3Map::INT1_FTH>(1).value
 
 // Microphone Pin (Analog)
 #define MIC_PIN A3
 
-// Sound Calibration Parameters
-#define SOUND_BASELINE_SAMPLES 50    // Samples to take for baseline calibration
-#define SOUND_BASELINE_THRESHOLD 5   // Minimum change from baseline to register as sound
+// Continuous microphone capture: timer-paced ADC + DMA into ping-pong blocks
+#ifndef MIC_USE_DMA
+#if defined(TARGET_STM32F4)
+#define MIC_USE_DMA 1
+#else
+#define MIC_USE_DMA 0
+#endif
+#endif
+#define MIC_BLOCK_WAIT_MS 100        // Processing thread wakes at least this often
+
+// Sound level meter (integer RMS, reported in dB)
+#define MIC_ADC_BITS 12              // DMA code width; 0 dBFS = full-scale sine
+#define MIC_POLL_SHIFT 2             // 10-bit analogRead() codes -> 12-bit scale
+#define MIC_HIGHPASS_HZ 20           // DC-blocking corner
+#define MIC_FAST_WINDOW_MS 125       // "Fast" Leq reported every loop
+#define MIC_LEQ_WINDOW_MS 1000       // Leq and peak-hold window
+#define MIC_POLL_SAMPLES 64          // Block size when falling back to analogRead()
+#define MIC_POLL_INTERVAL_US 125     // ~8kHz polling
+#define MIC_POLL_PER_PASS 16         // analogRead()s per loop() pass (~2ms); a block spans passes
+#ifndef MIC_SPL_AT_FULL_SCALE
+#define MIC_SPL_AT_FULL_SCALE 120    // dB SPL of a full-scale sine at the ADC (mic sensitivity + gain)
+#endif
+
+// Background noise floor (minimum statistics, tracked continuously)
+#define MIC_FLOOR_SUBWINDOW_MS 1000  // Minimum kept per sub-window
+#define MIC_FLOOR_SUBWINDOWS 8       // Floor may rise after at most 8s of louder background
+#define MIC_FLOOR_BIAS_DB 1.5f       // Minimum of the smoothed level sits this far below its mean
+#ifndef MIC_FLOOR_PERSIST
+#define MIC_FLOOR_PERSIST 1          // Keep the last floor in the secure element for warm boots
+#endif
+#define MIC_FLOOR_ZONE_IDX 0x00      // EEPROMInterface zone, unused by the WiFi/IoT Hub settings
+#define MIC_FLOOR_MAGIC 0x4E464C31   // "NFL1"
+#define MIC_FLOOR_SAVE_INTERVAL_MS 600000UL  // At most one write per 10 minutes
+#define MIC_FLOOR_SAVE_DELTA_DB 2    // Only rewrite when the floor moved this much
+#if MIC_FLOOR_PERSIST
+#include "EEPROMInterface.h"
+#endif
+
+// Sound activity detection (energy above the floor + zero-crossing rate); spectral
+// analysis and the extra upload detail only run while it reports activity
+#define VAD_ON_MARGIN_DB 6           // Above the floor to start
+#define VAD_OFF_MARGIN_DB 3          // ... and to stay active
+#define VAD_STRONG_MARGIN_DB 15      // Immediate onset (impacts, shouts)
+#define VAD_ONSET_BLOCKS 2           // ~64ms of sound otherwise
+#define VAD_HANGOVER_MS 800          // Bridges pauses between words
+#define VAD_VOICE_MIN_HZ 80          // ZCR/2 range of voiced sound
+#define VAD_VOICE_MAX_HZ 1500
+#define VAD_NOISE_MIN_HZ 1800        // Hiss-like blocks (white noise sits near fs/4) need the strong margin
 
 // Configuration - prefer project `src/config.h` but provide safe defaults
 // Copy `src/config.h.example` -> `src/config.h` and fill your values.
@@ -125,162 +179,450 @@
 #ifndef FIREBASE_UPDATE_INTERVAL_MS
 #define FIREBASE_UPDATE_INTERVAL_MS 2000
 #endif
+// Raw accel/gyro/angle fields in each snapshot. Motion is uploaded as per-window activity
+// features; the phone's live view still reads these, so they stay on by default.
+#ifndef UPLOAD_MOTION_SNAPSHOT
+#define UPLOAD_MOTION_SNAPSHOT 1
+#endif
+
+// Interrupt-driven IMU acquisition: INT1 wakes a high-priority thread that reads the
+// sensor, so the bus is shared with loop() and every transaction takes the bus lock
+#ifndef IMU_USE_INT1
+#define IMU_USE_INT1 1
+#endif
+
+#if IMU_USE_INT1
+#include "mbed.h"
+Mutex i2cBusMutex;
+#define I2C_BUS_LOCK()   i2cBusMutex.lock()
+#define I2C_BUS_UNLOCK() i2cBusMutex.unlock()
+#else
+#define I2C_BUS_LOCK()
+#define I2C_BUS_UNLOCK()
+#endif
 
 // ============================================================================
 // DIRECT I2C COMMUNICATION FUNCTIONS
 // ============================================================================
 
+#define I2C_BUS_CLOCK_HZ 100000          // Standard-mode SCL
+
+// Register-level bus shared by all sensors (burst reads + per-sensor traffic counters).
+// Every transfer is queued on the async engine; blocking helpers submit and wait.
+WireTransport wireTransport;
+I2CAsyncEngine i2cEngine;
+SensorBus sensorBus;
+
+#if defined(DEVICE_I2C_ASYNCH)
+#include "mbed.h"
+HalAsyncI2CBackend i2cBackend(I2C_SDA, I2C_SCL, I2C_BUS_CLOCK_HZ);  // Interrupt-driven transfers
+
+// Blocked bus callers sleep on a semaphore the completion interrupt releases, so the
+// CPU (and the INT1 thread's priority) is free while bytes are on the wire
+class RtosI2CWaiter : public I2CWaiter {
+public:
+    RtosI2CWaiter() : completions(0) {}
+    uint32_t nowMs() override { return millis(); }
+    void sleep(uint32_t maxMs) override { completions.wait(maxMs); }
+    void wake() override { completions.release(); }
+
+private:
+    Semaphore completions;
+};
+RtosI2CWaiter i2cWaiter;
+#else
+SyncI2CBackend i2cBackend(&wireTransport);                          // Blocking Wire fallback
+#endif
+
+#define I2C_PROBE_REG 0x0F               // WHO_AM_I on every ST sensor on the board
+
+// Bring up the I2C peripheral exactly once, with a single owner: the HAL backend when
+// transfers are interrupt-driven (Wire is never started, so the two drivers cannot
+// reprogram the same block underneath each other), Wire for the blocking build. All
+// other code reaches the bus through sensorBus, so sensor begin() calls may run this
+// again safely.
+void i2cBusBegin() {
+    static bool started = false;
+    if (started) return;
+    started = true;
+#if defined(DEVICE_I2C_ASYNCH)
+    i2cBackend.begin();
+#else
+    Wire.begin();
+#endif
+    i2cEngine.begin(&i2cBackend);
+#if defined(DEVICE_I2C_ASYNCH)
+    i2cEngine.setWaiter(&i2cWaiter);
+#endif
+    sensorBus.begin(&i2cEngine);
+    sensorBus.attachEngine(&i2cEngine);
+}
+
+// True when a device ACKs its address (scan and presence checks go through the engine too)
+bool i2cProbe(uint8_t deviceAddr) {
+    I2C_BUS_LOCK();
+    bool present = sensorBus.probe(deviceAddr, I2C_PROBE_REG);
+    I2C_BUS_UNLOCK();
+    return present;
+}
+#define HTS221_AUTO_INCREMENT  HTS221Map::autoIncrementFlag   // Sub-address MSB enables auto-increment
+#define LSM6DS3_AUTO_INCREMENT LSM6DS3Map::autoIncrementFlag  // IF_INC in CTRL3_C handles auto-increment
+
 // Direct I2C Write - Single Register
 void i2cWriteRegister(uint8_t deviceAddr, uint8_t reg, uint8_t value) {
-    Wire.beginTransmission(deviceAddr);
-    Wire.write(reg);
-    Wire.write(value);
-    Wire.endTransmission();
+    I2C_BUS_LOCK();
+    sensorBus.writeRegister(deviceAddr, reg, value);
+    I2C_BUS_UNLOCK();
 }
 
 // Direct I2C Read - Single Register
 uint8_t i2cReadRegister(uint8_t deviceAddr, uint8_t reg) {
-    Wire.beginTransmission(deviceAddr);
-    Wire.write(reg);
-    Wire.endTransmission(false);
-    Wire.requestFrom(deviceAddr, (uint8_t)1);
-    return Wire.read();
+    I2C_BUS_LOCK();
+    uint8_t value = sensorBus.readRegister(deviceAddr, reg);
+    I2C_BUS_UNLOCK();
+    return value;
   }
 
-// Direct I2C Read - Multiple Registers
+// Direct I2C Read - Multiple Registers (one burst transaction)
 void i2cReadRegisters(uint8_t deviceAddr, uint8_t reg, uint8_t* data, uint8_t length) {
-    Wire.beginTransmission(deviceAddr);
-    Wire.write(reg);
-    Wire.endTransmission(false);
-    Wire.requestFrom(deviceAddr, length);
-    for (uint8_t i = 0; i < length; i++) {
-        data[i] = Wire.read();
-    }
+    I2C_BUS_LOCK();
+    sensorBus.readRegisters(deviceAddr, reg, data, length);
+    I2C_BUS_UNLOCK();
+}
+
+// Direct I2C Read - Planned register block (one burst transaction)
+void i2cReadPlan(const BusReadPlan &plan, uint8_t* data) {
+    I2C_BUS_LOCK();
+    sensorBus.execute(plan, data);
+    I2C_BUS_UNLOCK();
 }
 
 // Direct I2C Read - 16-bit Value
 int16_t i2cRead16Bit(uint8_t deviceAddr, uint8_t regL, uint8_t regH) {
-    uint8_t low = i2cReadRegister(deviceAddr, regL);
-    uint8_t high = i2cReadRegister(deviceAddr, regH);
-    return (int16_t)((high << 8) | low);
+    uint8_t bytes[2];
+    if (regH == regL + 1) {
+        // Adjacent registers: one 2-byte burst instead of two round trips
+        i2cReadRegisters(deviceAddr, regL, bytes, 2);
+    } else {
+        bytes[0] = i2cReadRegister(deviceAddr, regL);
+        bytes[1] = i2cReadRegister(deviceAddr, regH);
+    }
+    return (int16_t)((bytes[1] << 8) | bytes[0]);
   }
 
+// For drivers that reach the bus outside SensorBus (the secure element behind
+// EEPROMInterface): take the lock and let queued transfers finish before handing over
+void i2cBusLockExclusive() {
+    I2C_BUS_LOCK();
+    i2cEngine.waitIdle();
+}
+
+// Queue a planned block read and return immediately (see BusAsyncRead)
+bool i2cSubmitPlan(const BusReadPlan &plan, BusAsyncRead &read) {
+    I2C_BUS_LOCK();
+    bool queued = sensorBus.submit(plan, read);
+    I2C_BUS_UNLOCK();
+    return queued;
+}
+
+// Wait for a submitted read to finish; returns true when it delivered data
+bool i2cAwait(BusAsyncRead &read) {
+    if (read.isBusy()) i2cEngine.wait(&read.request);
+    return read.isDone();
+}
+
+// Little-endian 16-bit value at register regL inside a burst that started at baseReg
+int16_t blockRead16(const uint8_t* block, uint8_t baseReg, uint8_t regL) {
+    return (int16_t)((block[regL - baseReg + 1] << 8) | block[regL - baseReg]);
+}
+
+// Print per-sensor bus traffic since boot
+void printBusStats() {
+    Serial.println("I2C bus traffic:");
+    for (uint8_t i = 0; i < sensorBus.getDeviceCount(); i++) {
+        const BusStats* stats = sensorBus.getStatsByIndex(i);
+        Serial.print("  "); Serial.print(sensorBus.getDeviceName(i));
+        Serial.print(": "); Serial.print(stats->transactions);
+        Serial.print(" txn, "); Serial.print(stats->bytesRead);
+        Serial.print(" B read, "); Serial.print(stats->bytesWritten);
+        Serial.print(" B written, "); Serial.print(stats->errors);
+        Serial.println(" errors");
+    }
+    Serial.print("  Transfers aborted on timeout: "); Serial.println(i2cEngine.getTimeoutCount());
+}
+
 // ============================================================================
 // SOUND SENSOR CALIBRATION SYSTEM
 // ============================================================================
 
+// Last noise floor as stored in the secure element
+struct StoredNoiseFloor {
+    uint32_t magic;
+    int32_t floorDbQ8;
+    int16_t referenceDb;    // MIC_SPL_AT_FULL_SCALE at the time; other values invalidate it
+    uint16_t check;
+};
+
 class SoundCalibrator {
 private:
-    int baselineValue;
-    int baselinePeakToPeak;  // Natural variation in quiet room
-    bool isCalibrated;
-    float smoothedValue;
+    SoundLevelMeter meter;
+    NoiseFloorTracker noiseFloor;
+    SoundActivityDetector activity;
+    bool started;
     
-    // Sensitivity settings
-    const float SMOOTHING = 0.80f;  // 80% old, 20% new (stable but responsive)
-    const float SENSITIVITY = 2.0f;  // Amplify variations for distant sounds
+    // Block mode: levels are computed from whole DMA blocks on the mic thread
+    bool blockMode;
+    
+    // Polled fallback: the block being filled, MIC_POLL_PER_PASS samples per pass
+    uint16_t pollSamples[MIC_POLL_SAMPLES];
+    uint16_t pollCount;
+    
+    // Persisted floor
+    int32_t savedFloorDbQ8;
+    bool haveSaved;
+    unsigned long lastSaveTime;
+    
+    static int roundDb(int32_t dbQ8) {
+        return (dbQ8 >= 0) ? (dbQ8 + 128) >> 8 : -((-dbQ8 + 128) >> 8);
+    }
+    
+    static uint16_t recordCheck(const StoredNoiseFloor& rec) {
+        return (uint16_t)((rec.magic ^ (uint32_t)rec.floorDbQ8 ^ (uint32_t)(uint16_t)rec.referenceDb) * 2654435761u >> 16);
+    }
+    
+    // Read the next slice of a block with analogRead() when no DMA capture is running.
+    // A call costs at most MIC_POLL_PER_PASS reads; the block is measured once it is
+    // full, and the level holds until the next one is.
+    void pollBlock() {
+        for (int i = 0; i < MIC_POLL_PER_PASS && pollCount < MIC_POLL_SAMPLES; i++) {
+            if (i > 0) delayMicroseconds(MIC_POLL_INTERVAL_US);
+            pollSamples[pollCount++] = analogRead(MIC_PIN);
+        }
+        if (pollCount < MIC_POLL_SAMPLES) return;
+        pollCount = 0;
+        meter.process(pollSamples, MIC_POLL_SAMPLES, MIC_POLL_SHIFT);
+        trackBlock(MIC_POLL_SAMPLES, millis());
+    }
+    
+    // Floor and activity follow every block level
+    void trackBlock(uint16_t count, uint32_t nowMs) {
+        int32_t level = meter.getBlockDbQ8();
+        noiseFloor.update(level, nowMs);
+        activity.update(level, noiseFloor.getFloorDbQ8(), meter.getBlockZeroCrossings(), count, nowMs);
+    }
+    
+    bool loadFloor(int32_t& floorDbQ8) {
+#if MIC_FLOOR_PERSIST
+        StoredNoiseFloor rec;
+        EEPROMInterface eeprom;
+        i2cBusLockExclusive();
+        int got = eeprom.read((uint8_t*)&rec, sizeof(rec), 0, MIC_FLOOR_ZONE_IDX);
+        I2C_BUS_UNLOCK();
+        if (got != (int)sizeof(rec)) {
+            return false;
+        }
+        if (rec.magic != MIC_FLOOR_MAGIC || rec.referenceDb != MIC_SPL_AT_FULL_SCALE || rec.check != recordCheck(rec)) {
+            return false;
+        }
+        floorDbQ8 = rec.floorDbQ8;
+        return true;
+#else
+        return false;
+#endif
+    }
+    
+    bool saveFloor(int32_t floorDbQ8) {
+#if MIC_FLOOR_PERSIST
+        StoredNoiseFloor rec;
+        rec.magic = MIC_FLOOR_MAGIC;
+        rec.floorDbQ8 = floorDbQ8;
+        rec.referenceDb = MIC_SPL_AT_FULL_SCALE;
+        rec.check = recordCheck(rec);
+        EEPROMInterface eeprom;
+        i2cBusLockExclusive();
+        int result = eeprom.write((uint8_t*)&rec, sizeof(rec), MIC_FLOOR_ZONE_IDX);
+        I2C_BUS_UNLOCK();
+        return result == 0;
+#else
+        return false;
+#endif
+    }
     
 public:
     SoundCalibrator() {
-        baselineValue = 0;
-        baselinePeakToPeak = 0;
-        isCalibrated = false;
-        smoothedValue = 0.0f;
+        started = false;
+        blockMode = false;
+        pollCount = 0;
+        savedFloorDbQ8 = 0;
+        haveSaved = false;
+        lastSaveTime = 0;
+        meter.begin(MIC_SAMPLE_RATE_HZ, MIC_ADC_BITS, MIC_HIGHPASS_HZ, MIC_FAST_WINDOW_MS, MIC_LEQ_WINDOW_MS);
+        meter.setReferenceDb(MIC_SPL_AT_FULL_SCALE);
     }
     
-    // Calibrate baseline during quiet period
-    void calibrate() {
-        Serial.println("🎤 Sound Sensor: Starting baseline calibration...");
-        Serial.println("🎤 Please keep quiet for 3 seconds...");
+    // Start floor tracking; a stored floor from the last run makes the start warm.
+    // Nothing here waits for the room to be quiet.
+    void begin() {
+        noiseFloor.begin(MIC_FLOOR_SUBWINDOW_MS, MIC_FLOOR_SUBWINDOWS, SOUND_DB_Q8(MIC_FLOOR_BIAS_DB));
         
-        long sumAvg = 0;
-        long sumPeak = 0;
-        int samples = 30;
+        SoundActivityConfig vad;
+        vad.onMarginDbQ8 = SOUND_DB_Q8(VAD_ON_MARGIN_DB);
+        vad.offMarginDbQ8 = SOUND_DB_Q8(VAD_OFF_MARGIN_DB);
+        vad.strongMarginDbQ8 = SOUND_DB_Q8(VAD_STRONG_MARGIN_DB);
+        vad.onsetBlocks = VAD_ONSET_BLOCKS;
+        vad.hangoverMs = VAD_HANGOVER_MS;
+        vad.voiceMinHz = VAD_VOICE_MIN_HZ;
+        vad.voiceMaxHz = VAD_VOICE_MAX_HZ;
+        vad.noiseMinHz = VAD_NOISE_MIN_HZ;
+        activity.begin(vad, MIC_SAMPLE_RATE_HZ);
         
-        for (int i = 0; i < samples; i++) {
-            // Measure average
-            int val = analogRead(MIC_PIN);
-            sumAvg += val;
-            
-            // Measure peak-to-peak variation
-            int minVal = 1023, maxVal = 0;
-            for (int j = 0; j < 10; j++) {
-                int reading = analogRead(MIC_PIN);
-                if (reading < minVal) minVal = reading;
-                if (reading > maxVal) maxVal = reading;
-                delayMicroseconds(100);
-            }
-            sumPeak += (maxVal - minVal);
-            
-            delay(100);
-            
-            if (i % 10 == 0) {
-                Serial.print("🎤 Calibrating... ");
-                Serial.print((i * 100) / samples);
-                Serial.println("%");
-            }
+        int32_t stored;
+        if (loadFloor(stored)) {
+            noiseFloor.seed(stored);
+            savedFloorDbQ8 = stored;
+            haveSaved = true;
+            Serial.print("🎤 Noise floor: ");
+            Serial.print(stored / 256.0f, 1);
+            Serial.println(" dB (stored, tracking continues)");
+        } else {
+            Serial.println("🎤 Noise floor: learning in the background (~1s)");
         }
-        
-        baselineValue = sumAvg / samples;
-        baselinePeakToPeak = sumPeak / samples;
-        smoothedValue = 0.0f;
-        isCalibrated = true;
-        
-        Serial.print("🎤 Baseline (average): ");
-        Serial.print(baselineValue);
-        Serial.print(" | Natural variation: ");
-        Serial.println(baselinePeakToPeak);
-        Serial.println("🎤 Sound sensor ready! (Quiet room should read 0-10)");
+        lastSaveTime = millis();
+        started = true;
+    }
+    
+    // Switch to block processing once the DMA capture is running
+    void useBlocks(bool enabled) {
+        blockMode = enabled;
+    }
+    
+    // Mic thread: filter, square and accumulate one DMA block, then update the floor
+    // and activity. Returns whether sound activity is present.
+    bool processBlock(const uint16_t* samples, uint16_t count, uint32_t timestampMs) {
+        meter.process(samples, count);
+        if (started) {
+            trackBlock(count, timestampMs);
+        }
+        return activity.isActive();
     }
     
-    // Get calibrated sound level - sensitive to distant sounds
+    // Sound level in dB (SPL with MIC_SPL_AT_FULL_SCALE set for the mic). In block mode
+    // this is the newest fast Leq, so loop() never waits on the ADC.
     int getCalibratedSoundLevel() {
-        if (!isCalibrated) {
-            return analogRead(MIC_PIN);
+        if (!blockMode) {
+            pollBlock();
+            return roundDb(meter.getBlockDbQ8());
         }
-        
-        // Method 1: Average reading (for loud sounds)
-        int rawAvg = analogRead(MIC_PIN);
-        int avgDiff = abs(rawAvg - baselineValue);
-        
-        // Method 2: Peak-to-peak (for distant sounds - more sensitive)
-        int minVal = 1023, maxVal = 0;
-        for (int i = 0; i < 15; i++) {
-            int reading = analogRead(MIC_PIN);
-            if (reading < minVal) minVal = reading;
-            if (reading > maxVal) maxVal = reading;
-            delayMicroseconds(100);
+        return roundDb(meter.getFastDbQ8());
+    }
+    
+    // Called from loop(): stores the floor when it has moved, rate limited for the EEPROM
+    void maintain() {
+        if (!noiseFloor.isConverged() || millis() - lastSaveTime < MIC_FLOOR_SAVE_INTERVAL_MS) {
+            return;
+        }
+        lastSaveTime = millis();
+        int32_t floorDbQ8 = noiseFloor.getFloorDbQ8();
+        int32_t moved = floorDbQ8 - savedFloorDbQ8;
+        if (moved < 0) moved = -moved;
+        if (haveSaved && moved < SOUND_DB_Q8(MIC_FLOOR_SAVE_DELTA_DB)) {
+            return;
+        }
+        if (saveFloor(floorDbQ8)) {
+            savedFloorDbQ8 = floorDbQ8;
+            haveSaved = true;
         }
-        int peakToPeak = maxVal - minVal;
-        
-        // Subtract natural variation
-        int relativePeak = peakToPeak - baselinePeakToPeak;
-        if (relativePeak < 0) relativePeak = 0;
-        
-        // Amplify variations for sensitivity to distant sounds
-        int amplifiedPeak = (int)(relativePeak * SENSITIVITY);
-        
-        // Combine: use larger of the two methods
-        int combined = (avgDiff > amplifiedPeak) ? avgDiff : amplifiedPeak;
-        
-        // Apply smoothing for stability
-        smoothedValue = SMOOTHING * smoothedValue + (1.0f - SMOOTHING) * combined;
-        
-        return (int)smoothedValue;
     }
     
-    bool isReady() {
-        return isCalibrated;
+    // Leq and peak over the last MIC_LEQ_WINDOW_MS
+    float getLeqDb() {
+        return meter.getLeqDbQ8() / 256.0f;
+    }
+    
+    float getPeakDb() {
+        return meter.getPeakDbQ8() / 256.0f;
     }
     
-    int getBaseline() {
-        return baselineValue;
+    bool isSoundActive() {
+        return activity.isActive();
+    }
+    
+    bool isVoice() {
+        return activity.isVoice();
+    }
+    
+    float getNoiseFloorDb() {
+        return noiseFloor.getFloorDbQ8() / 256.0f;
+    }
+    
+    // True once the floor comes from measurements (or a stored value)
+    bool isReady() {
+        return noiseFloor.isConverged();
     }
 };
 
 // Global sound calibrator
 SoundCalibrator soundCalibrator;
 
+// ============================================================================
+// MICROPHONE CAPTURE (ADC + DMA)
+// ============================================================================
+
+MicCapture micCapture;
+SpectrumAnalyzer micSpectrum;    // Band energies, centroid and flatness for the upload
+
+#if MIC_USE_DMA
+#define MIC_SIGNAL_BLOCK 0x01
+
+Stm32AdcDmaSource micDma((PinName)MIC_PIN);
+Thread micThread(osPriorityAboveNormal, 2048);
+
+// DMA interrupt: a half of the ping-pong buffer is full
+void micBlockReady(void* ctx) {
+    micThread.signal_set(MIC_SIGNAL_BLOCK);
+}
+
+// Processing thread: turns every completed block into a sound level
+void micProcessingTask() {
+    bool spectrumRunning = false;
+    while (true) {
+        Thread::signal_wait(MIC_SIGNAL_BLOCK, MIC_BLOCK_WAIT_MS);
+        MicBlock block;
+        while (micCapture.acquire(block)) {
+            // millis(), not timestampUs / 1000: the microsecond clock wraps every 71 minutes
+            // and its millisecond quotient would jump back, stalling the floor and VAD timers
+            bool active = soundCalibrator.processBlock(block.samples, block.count, millis());
+            // The FFT only runs while there is something to describe
+            if (active) {
+                micSpectrum.process(block.samples, block.count);
+            } else if (spectrumRunning) {
+                micSpectrum.reset();
+            }
+            spectrumRunning = active;
+            micCapture.release();
+        }
+    }
+}
+
+bool beginMicCapture() {
+    micSpectrum.begin(MIC_SAMPLE_RATE_HZ, MIC_SPL_AT_FULL_SCALE);
+    micCapture.setNotify(micBlockReady, nullptr);
+    if (!micCapture.begin(&micDma, MIC_SAMPLE_RATE_HZ)) {
+        Serial.println("🎤 ADC/DMA capture unavailable - using polled analogRead()");
+        return false;
+    }
+    micThread.start(micProcessingTask);
+    soundCalibrator.useBlocks(true);
+    
+    Serial.print("🎤 Continuous capture at ");
+    Serial.print(MIC_SAMPLE_RATE_HZ);
+    Serial.print("Hz, ");
+    Serial.print(MIC_BLOCK_SAMPLES);
+    Serial.println("-sample blocks");
+    return true;
+}
+#endif
+
 // ============================================================================
 // HTS221 TEMPERATURE & HUMIDITY SENSOR
 // ============================================================================
@@ -290,88 +632,266 @@ struct HTS221_Calibration {
     int16_t T0_out, T1_out;
     float H0_rh, H1_rh;
     int16_t H0_T0_out, H1_T0_out;
+    LinearCalQ16 tempQ;               // Precomputed fixed-point slope/offset (degC)
+    LinearCalQ16 humQ;                // Precomputed fixed-point slope/offset (%RH)
 };
 
 class HTS221_Direct {
 private:
     uint8_t address;
     HTS221_Calibration calib;
-    float tempBuffer[5] = {0};
-    float humBuffer[5] = {0};
-    uint8_t bufferIndex = 0;
-
-    float smoothData(float* buffer, float newValue) {
-        buffer[bufferIndex] = newValue;
-        bufferIndex = (bufferIndex + 1) % 5;
-    
-    float sum = 0;
-        for (uint8_t i = 0; i < 5; i++) {
-      sum += buffer[i];
-    }
-        return sum / 5.0f;
-  }
+    BusReadPlan samplePlan;
+    BusAsyncRead pendingRead;
+    // Moving average, one window per channel
+    RingWindow<float, HTS221_SMOOTHING_SAMPLES> tempWindow;
+    RingWindow<float, HTS221_SMOOTHING_SAMPLES> humWindow;
 
 public:
     HTS221_Direct(uint8_t addr = HTS221_ADDR) : address(addr) {}
 
   bool begin() {
-    Wire.begin();
+    i2cBusBegin();
+        sensorBus.registerDevice(address, "HTS221", HTS221_AUTO_INCREMENT);
     
         // Check device ID
-        if (i2cReadRegister(address, HTS221_WHO_AM_I) != 0xBC) {
+        if (i2cReadRegister(address, HTS221_WHO_AM_I) != HTS221Map::whoAmI) {
             Serial.println("HTS221: Device not found!");
       return false;
     }
 
-        // Power on and set data rate
-        i2cWriteRegister(address, HTS221_CTRL_REG1, 0x85); // 12.5Hz, BDU=1, ODR=01
+        // Power on and set data rate: active, BDU=1, ODR=01 (1Hz - matches the 1s loop)
+        const uint8_t ctrl1 = RegisterValue<HTS221Map::CTRL_REG1>()
+            .set<HTS221Map::PD>(1).set<HTS221Map::BDU>(1).set<HTS221Map::ODR>(1).value;
+        i2cWriteRegister(address, HTS221_CTRL_REG1, ctrl1);
         
         // Wait for sensor to stabilize
         delay(100);
 
-    // Read calibration data
-        uint8_t T0_degC_x8 = i2cReadRegister(address, HTS221_CALIB_T0_DEGC_X8);
-        uint8_t T1_degC_x8 = i2cReadRegister(address, HTS221_CALIB_T1_DEGC_X8);
-        uint8_t T0_T1_msb = i2cReadRegister(address, HTS221_CALIB_T0_T1_MSB);
+    // Read calibration data: the whole 0x30..0x3F block in one burst
+        uint8_t cal[HTS221_CALIB_BLOCK_LEN];
+        i2cReadPlan(HTS221Map::CalibrationRead::plan(address), cal);
+        uint8_t T0_degC_x8 = cal[HTS221_CALIB_T0_DEGC_X8 - HTS221_CALIB_H0_RH_X2];
+        uint8_t T1_degC_x8 = cal[HTS221_CALIB_T1_DEGC_X8 - HTS221_CALIB_H0_RH_X2];
+        uint8_t T0_T1_msb = cal[HTS221_CALIB_T0_T1_MSB - HTS221_CALIB_H0_RH_X2];
 
     calib.T0_degC = ((T0_T1_msb & 0x03) << 8 | T0_degC_x8) / 8.0f;
     calib.T1_degC = ((T0_T1_msb & 0x0C) << 6 | T1_degC_x8) / 8.0f;
-        calib.T0_out = i2cRead16Bit(address, HTS221_CALIB_T0_OUT_L, HTS221_CALIB_T0_OUT_H);
-        calib.T1_out = i2cRead16Bit(address, HTS221_CALIB_T1_OUT_L, HTS221_CALIB_T1_OUT_H);
-        calib.H0_rh = i2cReadRegister(address, HTS221_CALIB_H0_RH_X2) / 2.0f;
-        calib.H1_rh = i2cReadRegister(address, HTS221_CALIB_H1_RH_X2) / 2.0f;
-        calib.H0_T0_out = i2cRead16Bit(address, HTS221_CALIB_H0_T0_OUT_L, HTS221_CALIB_H0_T0_OUT_H);
-        calib.H1_T0_out = i2cRead16Bit(address, HTS221_CALIB_H1_T0_OUT_L, HTS221_CALIB_H1_T0_OUT_H);
-
-        // Initialize buffers
-        for (uint8_t i = 0; i < 5; i++) {
-      tempBuffer[i] = calib.T0_degC;
-      humBuffer[i] = calib.H0_rh;
-    }
+        calib.T0_out = blockRead16(cal, HTS221_CALIB_H0_RH_X2, HTS221_CALIB_T0_OUT_L);
+        calib.T1_out = blockRead16(cal, HTS221_CALIB_H0_RH_X2, HTS221_CALIB_T1_OUT_L);
+        calib.H0_rh = cal[HTS221_CALIB_H0_RH_X2 - HTS221_CALIB_H0_RH_X2] / 2.0f;
+        calib.H1_rh = cal[HTS221_CALIB_H1_RH_X2 - HTS221_CALIB_H0_RH_X2] / 2.0f;
+        calib.H0_T0_out = blockRead16(cal, HTS221_CALIB_H0_RH_X2, HTS221_CALIB_H0_T0_OUT_L);
+        calib.H1_T0_out = blockRead16(cal, HTS221_CALIB_H0_RH_X2, HTS221_CALIB_H1_T0_OUT_L);
+
+        // Fold the two-point calibration into a fixed-point slope/offset once, so each
+        // sample costs one multiply instead of float divides
+        calib.tempQ = makeLinearCal((T0_T1_msb & 0x03) << 8 | T0_degC_x8, (T0_T1_msb & 0x0C) << 6 | T1_degC_x8,
+                                    3, calib.T0_out, calib.T1_out);
+        calib.humQ = makeLinearCal(cal[HTS221_CALIB_H0_RH_X2 - HTS221_CALIB_H0_RH_X2],
+                                   cal[HTS221_CALIB_H1_RH_X2 - HTS221_CALIB_H0_RH_X2],
+                                   1, calib.H0_T0_out, calib.H1_T0_out);
+
+        // One combined read per tick: status + humidity + temperature (0x27..0x2B)
+        samplePlan = HTS221Map::SampleRead::plan(address);
+
+        // Average only real samples from here on
+        tempWindow.clear();
+        humWindow.clear();
 
         Serial.println("HTS221: Direct hardware initialization successful!");
     return true;
   }
 
+    // Start the status + humidity + temperature burst without waiting for it
+    void requestData() {
+        if (!pendingRead.isBusy()) {
+            i2cSubmitPlan(samplePlan, pendingRead);
+        }
+    }
+
   void readData(float &temperature, float &humidity) {
+        // Status, humidity and temperature in a single burst - use the one queued by
+        // requestData() if there is one, otherwise read it now
+        uint8_t localBlock[5];
+        const uint8_t* block = localBlock;
+        if (pendingRead.request.state != I2C_REQUEST_IDLE && i2cAwait(pendingRead)) {
+            block = pendingRead.data;
+        } else {
+            i2cReadPlan(samplePlan, localBlock);
+        }
+        pendingRead.release();
+
         // Check if data is ready
-        uint8_t status = i2cReadRegister(address, HTS221_STATUS_REG);
+        uint8_t status = block[HTS221_STATUS_REG - samplePlan.startReg];
         if (!(status & 0x03)) return; // No new data
 
         // Read temperature
-        int16_t temp_raw = i2cRead16Bit(address, HTS221_TEMP_OUT_L, HTS221_TEMP_OUT_H);
-    temperature = calib.T0_degC + (float)(temp_raw - calib.T0_out) * 
-                 (calib.T1_degC - calib.T0_degC) / (float)(calib.T1_out - calib.T0_out);
+        int16_t temp_raw = blockRead16(block, samplePlan.startReg, HTS221_TEMP_OUT_L);
+    temperature = q16ToFloat(applyLinearCal(calib.tempQ, temp_raw));
 
         // Read humidity
-        int16_t hum_raw = i2cRead16Bit(address, HTS221_HUMIDITY_OUT_L, HTS221_HUMIDITY_OUT_H);
-    humidity = calib.H0_rh + (float)(hum_raw - calib.H0_T0_out) * 
-              (calib.H1_rh - calib.H0_rh) / (float)(calib.H1_T0_out - calib.H0_T0_out);
-    humidity = constrain(humidity, 0.0f, 100.0f);
+        int16_t hum_raw = blockRead16(block, samplePlan.startReg, HTS221_HUMIDITY_OUT_L);
+    humidity = q16ToFloat(q16Clamp(applyLinearCal(calib.humQ, hum_raw), 0, 100 * Q16_ONE));
 
     // Apply smoothing
-        temperature = smoothData(tempBuffer, temperature);
-        humidity = smoothData(humBuffer, humidity);
+        tempWindow.push(temperature);
+        humWindow.push(humidity);
+        temperature = tempWindow.mean();
+        humidity = humWindow.mean();
+    }
+};
+
+// ============================================================================
+// LIS2MDL MAGNETOMETER
+// ============================================================================
+
+#ifndef MAG_USE_CONTINUOUS
+#define MAG_USE_CONTINUOUS 1            // 0 = single-shot triggered once per pass (lowest power)
+#endif
+#define LIS2MDL_ODR_CODE 0              // ODR: 0 = 10Hz, 1 = 20Hz, 2 = 50Hz, 3 = 100Hz
+#define LIS2MDL_MODE_CONTINUOUS 0
+#define LIS2MDL_MODE_SINGLE 1
+#define MAG_CAL_MIN_SPAN_COUNTS 200     // 30µT of rotation coverage per axis before offsets are trusted
+#define MAG_CAL_COARSE_AFTER_MS 60000   // Still not rotated by then: settle for a coarse calibration
+
+// Board mounting: sign of each magnetometer axis relative to the LSM6DS3 frame
+#define MAG_AXIS_SIGN_X 1
+#define MAG_AXIS_SIGN_Y 1
+#define MAG_AXIS_SIGN_Z 1
+
+// How far the hard-iron correction in MagData can be trusted
+enum MagCalQuality {
+    MAG_CAL_NONE = 0,                 // Neither rotated enough nor waited long enough
+    MAG_CAL_COARSE,                   // Axes short of the span rely on the sensor's own offset cancellation
+    MAG_CAL_FULL                      // Every axis centred on its rotation extremes
+};
+
+struct MagData {
+    float fieldX, fieldY, fieldZ;     // µT, hard-iron corrected, in the IMU frame
+    uint8_t calibration;              // MagCalQuality
+    bool sensorWorking;               // Sensor status flag
+};
+
+class LIS2MDL_Direct {
+private:
+    uint8_t address;
+    bool present = false;
+    bool continuous = true;
+    BusReadPlan samplePlan;
+
+    // Hard-iron estimate: centre of the extremes seen on each axis (raw counts)
+    int16_t minRaw[3];
+    int16_t maxRaw[3];
+    bool haveExtremes = false;
+    uint32_t calStartMs = 0;
+
+    void writeCfgA(uint8_t mode) {
+        i2cWriteRegister(address, LIS2MDL_CFG_REG_A, RegisterValue<LIS2MDLMap::CFG_REG_A>::zero()
+                         .set<LIS2MDLMap::COMP_TEMP_EN>(1)
+                         .set<LIS2MDLMap::ODR>(LIS2MDL_ODR_CODE)
+                         .set<LIS2MDLMap::MD>(mode).value);
+    }
+
+    void trackExtremes(const int16_t raw[3]) {
+        if (!haveExtremes) calStartMs = millis();
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            if (!haveExtremes || raw[axis] < minRaw[axis]) minRaw[axis] = raw[axis];
+            if (!haveExtremes || raw[axis] > maxRaw[axis]) maxRaw[axis] = raw[axis];
+        }
+        haveExtremes = true;
+    }
+
+public:
+    LIS2MDL_Direct(uint8_t addr = LIS2MDL_ADDR) : address(addr) {}
+
+    bool begin(bool continuousMode) {
+        sensorBus.registerDevice(address, "LIS2MDL", LIS2MDLMap::autoIncrementFlag);
+
+        uint8_t deviceId = i2cReadRegister(address, LIS2MDL_WHO_AM_I);
+        if (deviceId != LIS2MDLMap::whoAmI) {
+            Serial.print("LIS2MDL: Device not found! ID = 0x");
+            Serial.println(deviceId, 16);
+            return false;
+        }
+
+        // Offset cancellation (set/reset pulses) and the digital low-pass filter
+        i2cWriteRegister(address, LIS2MDLMap::CFG_REG_B::address, RegisterValue<LIS2MDLMap::CFG_REG_B>::zero()
+                         .set<LIS2MDLMap::OFF_CANC>(1).set<LIS2MDLMap::LPF>(1).value);
+        // BDU so the X/Y/Z bytes of one burst come from the same measurement
+        i2cWriteRegister(address, LIS2MDL_CFG_REG_C, RegisterValue<LIS2MDLMap::CFG_REG_C>::zero()
+                         .set<LIS2MDLMap::BDU>(1).value);
+
+        continuous = continuousMode;
+        writeCfgA(continuous ? LIS2MDL_MODE_CONTINUOUS : LIS2MDL_MODE_SINGLE);
+
+        samplePlan = LIS2MDLMap::SampleRead::plan(address);
+        resetCalibration();
+        present = true;
+
+        Serial.print("LIS2MDL: Direct hardware initialization successful (");
+        Serial.print(continuous ? "continuous" : "single-shot");
+        Serial.println(" mode)");
+        return true;
+    }
+
+    // Forget the hard-iron estimate (e.g. after the board moved into a new enclosure)
+    void resetCalibration() {
+        haveExtremes = false;
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            minRaw[axis] = 0;
+            maxRaw[axis] = 0;
+        }
+    }
+
+    bool axisSpanned(uint8_t axis) {
+        return haveExtremes && maxRaw[axis] - minRaw[axis] >= MAG_CAL_MIN_SPAN_COUNTS;
+    }
+
+    // A board that never rotates (wall or desk mount) would otherwise never calibrate.
+    // After MAG_CAL_COARSE_AFTER_MS it runs on the axes it has spanned plus the
+    // set/reset offset cancellation for the rest, which removes the sensor's own offset
+    // but not the board's hard iron; the heading may then be off by tens of degrees.
+    uint8_t getCalibration() {
+        if (!haveExtremes) return MAG_CAL_NONE;
+        if (axisSpanned(0) && axisSpanned(1) && axisSpanned(2)) return MAG_CAL_FULL;
+        return (millis() - calStartMs >= MAG_CAL_COARSE_AFTER_MS) ? MAG_CAL_COARSE : MAG_CAL_NONE;
+    }
+
+    // Read status + X/Y/Z in one burst. Single-shot mode re-arms the next measurement
+    // so it completes while the rest of the loop runs.
+    // Returns false (data untouched) when no new measurement was available.
+    bool readData(MagData &data) {
+        if (!present) return false;
+
+        typedef LIS2MDLMap::SampleRead Read;
+        uint8_t block[Read::length];
+        i2cReadPlan(samplePlan, block);
+
+        if (!continuous) {
+            writeCfgA(LIS2MDL_MODE_SINGLE);
+        }
+        if (!LIS2MDLMap::ZYXDA::decode(block[Read::offset<LIS2MDLMap::STATUS_REG>()])) return false;
+
+        const uint8_t* p = &block[Read::offset<LIS2MDLMap::OUTX_L_REG>()];
+        int16_t raw[3];
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            raw[axis] = (int16_t)(p[axis * 2 + 1] << 8 | p[axis * 2]);
+        }
+        trackExtremes(raw);
+
+        // Remove the hard-iron offset, scale to µT and map into the IMU frame. An axis
+        // without enough span has no usable centre yet and is left to offset cancellation.
+        q16_t field[3];
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            int16_t offset = axisSpanned(axis) ? (int16_t)(((int32_t)minRaw[axis] + maxRaw[axis]) / 2) : 0;
+            field[axis] = q16ScaleRaw((int16_t)(raw[axis] - offset), LIS2MDL_SCALE_Q32);
+        }
+        data.fieldX = MAG_AXIS_SIGN_X * q16ToFloat(field[0]);
+        data.fieldY = MAG_AXIS_SIGN_Y * q16ToFloat(field[1]);
+        data.fieldZ = MAG_AXIS_SIGN_Z * q16ToFloat(field[2]);
+        data.calibration = getCalibration();
+        data.sensorWorking = true;
+        return true;
     }
 };
 
@@ -379,31 +899,384 @@ public:
 // LSM6DS3 ACCELEROMETER & GYROSCOPE SENSOR
 // ============================================================================
 
+// FIFO Streaming Parameters
+#ifndef IMU_USE_FIFO
+#define IMU_USE_FIFO 1                  // Drain the on-chip FIFO instead of polling one snapshot
+#endif
+#define LSM6DS3_FIFO_DECIMATION 2       // Keep every 2nd sample (208Hz ODR -> 104Hz stream)
+#define LSM6DS3_FIFO_WATERMARK 104      // Samples (accel+gyro sets) before FTH flag is raised
+#define LSM6DS3_INT1_WATERMARK 26       // Watermark when FTH drives INT1 (~4 wakeups/s at 104Hz)
+#define IMU_INT1_SERVICE_TIMEOUT_MS 500 // Acquisition thread drains anyway if an edge is missed
+#define LSM6DS3_FIFO_MODE_BYPASS 0x00
+#define LSM6DS3_FIFO_MODE_CONTINUOUS 0x06
+#define LSM6DS3_FIFO_WORDS_PER_SAMPLE 6 // Gx Gy Gz Ax Ay Az (gyro is always first data set)
+#define LSM6DS3_FIFO_BURST_SAMPLES 2    // 24 bytes per burst - fits the 32-byte Wire buffer
+#define IMU_BLOCK_CAPACITY 128          // Samples handed to the pipeline per block
+
+// Embedded motion functions: free-fall, wake-up, 6D and tilt events latched on INT1
+// next to the FIFO watermark, plus the on-chip step counter
+#ifndef IMU_USE_EMBEDDED
+#define IMU_USE_EMBEDDED 1
+#endif
+#define IMU_WAKE_THRESHOLD_MG 63        // Slope above this is a wake-up (rounded to full scale / 64)
+#define IMU_WAKE_DURATION_SAMPLES 1     // ...once it lasts this many ODR samples (0..3)
+#define IMU_FREE_FALL_THS_CODE 3        // FF_THS: 3 = 312 mg
+#define IMU_FREE_FALL_MS 60             // |a| under the threshold this long is a free fall
+#define IMU_6D_THS_CODE 2               // SIXD_THS: 2 = 60 degrees
+#define IMU_QUIET_MS 10000              // No hardware event this long: per-sample fusion is skipped
+#define ACTIVITY_WINDOW_MS 10000        // Activity features window, uploaded as each one closes
+#define IMU_IDLE_DRAIN_MS 50            // loop()'s idle wait drains the IMU this often (fall uploads)
+#define IMU_GRAVITY_CUTOFF_HZ 0.3f      // Low-pass that tracks gravity out of the motion magnitude
+
+// Anti-alias decimation of the FIFO stream down to the rates the monitor and the upload
+// sample at, instead of whichever sample loop() happens to see
+#ifndef IMU_DECIMATION
+#define IMU_DECIMATION 1
+#endif
+#define IMU_DECIM_STAGE1_HZ 26.0f       // Two intermediate stages that take the bulk of the ratio...
+#define IMU_DECIM_STAGE2_HZ 2.0f
+#define IMU_MONITOR_RATE_HZ (1000.0f / SAMPLE_FREQUENCY_MS)         // ...then the monitor rate...
+#define IMU_UPLOAD_RATE_HZ (1000.0f / FIREBASE_UPDATE_INTERVAL_MS)  // ...and the upload rate
+#define IMU_STAGE_MONITOR 2             // Chain stages read by the monitor and the upload
+#define IMU_STAGE_UPLOAD 3
+#define IMU_DECIM_TAPS_PER_FACTOR 4     // FIR length 4 x factor + 1 per intermediate stage
+#define IMU_DECIM_OUTPUT_TAPS 31        // Monitor and upload stages (factor 2): >= 58 dB at their Nyquist
+#define IMU_DECIM_PASSBAND 0.75f        // FIR cutoff as a fraction of each stage's output Nyquist
+
+// Full-scale settings; conversion scales are looked up from these codes
+#define LSM6DS3_ACCEL_FS_CODE 0x0       // FS_XL: 00 = ±2g
+#define LSM6DS3_GYRO_FS_CODE 0x0        // FS_G: 00 = ±245dps
+#define IMU_FALL_ACCEL_FS_CODE 0x3      // FS_XL: 11 = ±8g while the fall detector runs (impacts reach 2.5g+)
+
 struct MotionData {
     float accelX, accelY, accelZ;    // m/s²
     float gyroX, gyroY, gyroZ;       // degrees/s
     float motionMagnitude;            // Overall motion level
+    float peakMagnitude;              // Largest motion level seen in the last sample block
     float xAngle, yAngle, zAngle;    // Orientation angles (degrees) - matches phone display
     bool isMoving;                    // Motion detection flag
     bool sensorWorking;               // Sensor status flag
+    uint8_t events;                   // ImuEvent bits the sensor raised since the last pass
+    uint8_t orientation;              // 6D position bits (ZH ZL YH YL XH XL) of the last 6D event
+    uint16_t steps;                   // Hardware step counter (wraps at 65535)
+    bool quiet;                       // No hardware event for IMU_QUIET_MS, fusion skipped
+};
+
+// Hardware motion events from the LSM6DS3 embedded functions
+enum ImuEvent {
+    IMU_EVENT_FREE_FALL = 0x01,
+    IMU_EVENT_WAKE_UP = 0x02,
+    IMU_EVENT_ORIENTATION = 0x04,
+    IMU_EVENT_TILT = 0x08,
+    IMU_EVENT_STEP = 0x10
+};
+
+// Events that end the quiet state (a step alone does not move the attitude)
+#define IMU_MOTION_EVENTS (IMU_EVENT_FREE_FALL | IMU_EVENT_WAKE_UP | IMU_EVENT_ORIENTATION | IMU_EVENT_TILT)
+
+// Channels of the decimation chain: raw counts, plus |a - g| in accelerometer counts
+enum ImuChannel {
+    IMU_CHANNEL_ACCEL_X,
+    IMU_CHANNEL_ACCEL_Y,
+    IMU_CHANNEL_ACCEL_Z,
+    IMU_CHANNEL_GYRO_X,
+    IMU_CHANNEL_GYRO_Y,
+    IMU_CHANNEL_GYRO_Z,
+    IMU_CHANNEL_MOTION,
+    IMU_CHANNEL_COUNT
+};
+
+// Block of consecutive samples drained from the FIFO in one pass
+struct ImuSampleBlock {
+    ImuSample samples[IMU_BLOCK_CAPACITY];
+    uint16_t count;                   // Valid samples in this block
+    uint16_t pending;                 // Samples still waiting in the FIFO after this block
+    float sampleRateHz;               // Effective rate after decimation
+    unsigned long periodUs;           // Time between consecutive samples
+    bool overrun;                     // FIFO overflowed (oldest samples were lost)
 };
 
+// Output data rate (Hz) for the 4-bit ODR field shared by CTRL1_XL, CTRL2_G and FIFO_CTRL5
+float lsm6ds3OdrHz(uint8_t odrCode) {
+    static const float ODR_TABLE[] = {0.0f, 12.5f, 26.0f, 52.0f, 104.0f, 208.0f,
+                                      416.0f, 833.0f, 1660.0f, 3330.0f, 6660.0f};
+    if (odrCode >= sizeof(ODR_TABLE) / sizeof(ODR_TABLE[0])) return 0.0f;
+    return ODR_TABLE[odrCode];
+}
+
+// CTRL1_XL / CTRL2_G contents for an ODR code and full-scale code
+constexpr uint8_t lsm6ds3Ctrl1XlValue(uint8_t odrCode, uint8_t fsCode) {
+    return RegisterValue<LSM6DS3Map::CTRL1_XL>::zero()
+        .set<LSM6DS3Map::ODR_XL>(odrCode).set<LSM6DS3Map::FS_XL>(fsCode).value;
+}
+
+constexpr uint8_t lsm6ds3Ctrl2GValue(uint8_t odrCode, uint8_t fsCode) {
+    return fsCode == LSM6DS3_GYRO_FS_125
+        ? RegisterValue<LSM6DS3Map::CTRL2_G>::zero().set<LSM6DS3Map::ODR_G>(odrCode).set<LSM6DS3Map::FS_125>(1).value
+        : RegisterValue<LSM6DS3Map::CTRL2_G>::zero().set<LSM6DS3Map::ODR_G>(odrCode).set<LSM6DS3Map::FS_G>(fsCode).value;
+}
+
+// Accelerometer full scale in mg for an FS_XL code (00 = 2g, 01 = 16g, 10 = 4g, 11 = 8g)
+uint16_t lsm6ds3AccelRangeMg(uint8_t fsCode) {
+    static const uint16_t RANGE_MG[] = {2000, 16000, 4000, 8000};
+    return RANGE_MG[fsCode & 0x03];
+}
+
+// CTRL3_C: block data update (no torn high/low bytes) + register auto-increment
+#define LSM6DS3_CTRL3_C_VALUE  RegisterValue<LSM6DS3Map::CTRL3_C>().set<LSM6DS3Map::BDU>(1).set<LSM6DS3Map::IF_INC>(1).value
+#define LSM6DS3_CTRL3_C_RESET  RegisterValue<LSM6DS3Map::CTRL3_C>().set<LSM6DS3Map::SW_RESET>(1).value
+
+// FIFO_CTRL3 decimation code for a decimation factor (0 = factor not supported)
+uint8_t lsm6ds3DecimationCode(uint8_t factor) {
+    switch (factor) {
+        case 1:  return 0x01;
+        case 2:  return 0x02;
+        case 3:  return 0x03;
+        case 4:  return 0x04;
+        case 8:  return 0x05;
+        case 16: return 0x06;
+        case 32: return 0x07;
+        default: return 0x00;
+    }
+}
+
 class LSM6DS3_Direct {
 private:
     uint8_t address;
     
-    // Orientation angles (complementary filter state)
-    float pitch = 0.0f;   // Y-axis rotation (yAngle)
-    float roll = 0.0f;    // X-axis rotation (xAngle)
-    float yaw = 0.0f;     // Z-axis rotation (zAngle)
+    // Quaternion attitude; Euler angles are only derived when a sample is reported
+    OrientationFilter ahrs;
     unsigned long lastAngleUpdate = 0;
-    const float ALPHA = 0.98f;  // Complementary filter coefficient (98% gyro, 2% accel)
+    
+    // Latest calibrated magnetometer field; the filter corrects yaw towards it
+    float magField[3] = {0.0f, 0.0f, 0.0f};
+    bool magAvailable = false;
+    
+    // One combined gyro+accel read per tick (0x22..0x2D)
+    BusReadPlan samplePlan;
+    BusAsyncRead pendingSample;
+    
+    // Full-scale codes currently programmed and the matching Q32 conversion factors
+    uint8_t accelFsCode = LSM6DS3_ACCEL_FS_CODE;
+    uint8_t gyroFsCode = LSM6DS3_GYRO_FS_CODE;
+    int32_t accelScaleQ32 = lsm6ds3AccelScaleQ32(LSM6DS3_ACCEL_FS_CODE);
+    int32_t gyroScaleQ32 = lsm6ds3GyroScaleQ32(LSM6DS3_GYRO_FS_CODE);
+    
+    // FIFO state
+    uint8_t odrCode = 0x5;       // ODR field currently written to CTRL1_XL/CTRL2_G
+    bool fifoEnabled = false;
+    float fifoRateHz = 0.0f;     // Effective FIFO sample rate after decimation
+    
+    // See every block sample at full rate (not the polled fallback); may be null
+    FallDetector* fallDetector = nullptr;
+    ActivityFeatureExtractor* activity = nullptr;
+    
+    // Lower-rate streams for the monitor and upload; fed with raw counts, so a full-scale
+    // change restarts it. May be null.
+    DecimationChain* decimator = nullptr;
+    
+    // Motion magnitude of every block sample since takeMagnitudes(), for the aggregates
+    SeriesStats passMagnitudes = {0, 0.0f, 0.0f, 0.0f, 0.0f};
+    
+    // Gravity as a per-axis low-pass of the raw accelerometer (counts, Q16), as the
+    // activity features track it, so the motion magnitude does not depend on which way
+    // up the board lies. Restarts on a full-scale change or a polling gap.
+    int32_t gravityQ16[3] = {0, 0, 0};
+    int32_t gravityAlphaQ16 = 0;
+    float gravityRateHz = 0.0f;
+    bool gravityPrimed = false;
+    
+    // |a - gravity| in counts for each sample of the block being processed
+    int16_t motionCounts[IMU_BLOCK_CAPACITY];
+    
+    // Embedded functions. The acquisition thread reads the latched sources on every INT1
+    // edge (that releases the line for the next watermark) and ORs them in here; loop()
+    // takes them with takeEvents().
+    bool isDsl = false;                 // LSM6DSL: pedometer/tilt enables sit in CTRL10_C
+    bool embeddedEnabled = false;
+    bool quiet = false;
+    bool eventsPolled = false;          // No INT1: nothing latches the sources but us
+    unsigned long lastEventMs = 0;
+    BusReadPlan eventPlan;
+    BusReadPlan functionPlan;
+    std::atomic<uint8_t> pendingEvents{0};
+    std::atomic<uint8_t> pendingOrientation{0};
+    std::atomic<uint16_t> latchedSteps{0};  // Step counter from the same burst as FUNC_SRC
+    
+    // Wake-up threshold in full scale / 64 steps, so it follows setFullScale()
+    void writeWakeThreshold() {
+        uint32_t code = ((uint32_t)IMU_WAKE_THRESHOLD_MG * 64 + lsm6ds3AccelRangeMg(accelFsCode) / 2)
+                        / lsm6ds3AccelRangeMg(accelFsCode);
+        if (code < 1) code = 1;
+        if (code > LSM6DS3Map::WK_THS::maxValue) code = LSM6DS3Map::WK_THS::maxValue;
+        i2cWriteRegister(address, LSM6DS3_WAKE_UP_THS,
+                         RegisterValue<LSM6DS3Map::WAKE_UP_THS>::zero().set<LSM6DS3Map::WK_THS>((uint8_t)code).value);
+    }
+    
+    // Convert one raw sample to m/s² and degrees/s in Q16 using the programmed full scales
+    void convertSample(const int16_t accelRaw[3], const int16_t gyroRaw[3], q16_t accelQ[3], q16_t gyroQ[3]) {
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            accelQ[axis] = q16ScaleRaw(accelRaw[axis], accelScaleQ32);
+            gyroQ[axis] = q16ScaleRaw(gyroRaw[axis], gyroScaleQ32);
+        }
+    }
+    
+    // Gravity low-pass coefficient for a sample rate, recomputed only when it changes
+    void setGravityRate(float rateHz) {
+        if (rateHz == gravityRateHz) return;
+        gravityRateHz = rateHz;
+        float alpha = 1.0f - expf(-2.0f * 3.14159265f * IMU_GRAVITY_CUTOFF_HZ / rateHz);
+        gravityAlphaQ16 = (int32_t)(alpha * 65536.0f + 0.5f);
+    }
+    
+    // Advance the gravity estimate over `count` samples and write |a - gravity| of each to
+    // out, in counts saturating at full scale
+    void removeGravity(const ImuSample* samples, uint16_t count, int16_t* out) {
+        int16_t body[3][DECIMATION_BLOCK];
+        for (uint16_t start = 0; start < count; start += DECIMATION_BLOCK) {
+            uint16_t n = count - start;
+            if (n > DECIMATION_BLOCK) n = DECIMATION_BLOCK;
+            for (uint16_t i = 0; i < n; i++) {
+                const int16_t* accel = samples[start + i].accel;
+                if (!gravityPrimed) {
+                    for (uint8_t axis = 0; axis < 3; axis++) gravityQ16[axis] = (int32_t)accel[axis] * 65536;
+                    gravityPrimed = true;
+                }
+                for (uint8_t axis = 0; axis < 3; axis++) {
+                    int64_t error = (int64_t)accel[axis] * 65536 - gravityQ16[axis];
+                    gravityQ16[axis] += (int32_t)((error * gravityAlphaQ16) >> 16);
+                    body[axis][i] = dspSsat16((int32_t)accel[axis] - ((gravityQ16[axis] + 0x8000) >> 16));
+                }
+            }
+            dspMagnitude3Q15(body[0], body[1], body[2], out + start, n);
+        }
+    }
+    
+    // Raw counts of a block into the decimation chain, DECIMATION_BLOCK samples at a time.
+    // The motion channel is the block's |a - gravity| from removeGravity().
+    void feedDecimator(const ImuSampleBlock &block) {
+        int16_t planar[IMU_CHANNEL_COUNT][DECIMATION_BLOCK];
+        const int16_t* channels[IMU_CHANNEL_COUNT];
+        for (uint8_t c = 0; c < IMU_CHANNEL_COUNT; c++) channels[c] = planar[c];
+        
+        for (uint16_t start = 0; start < block.count; start += DECIMATION_BLOCK) {
+            uint16_t n = block.count - start;
+            if (n > DECIMATION_BLOCK) n = DECIMATION_BLOCK;
+            for (uint16_t i = 0; i < n; i++) {
+                const ImuSample &sample = block.samples[start + i];
+                for (uint8_t axis = 0; axis < 3; axis++) {
+                    planar[IMU_CHANNEL_ACCEL_X + axis][i] = sample.accel[axis];
+                    planar[IMU_CHANNEL_GYRO_X + axis][i] = sample.gyro[axis];
+                }
+            }
+            memcpy(planar[IMU_CHANNEL_MOTION], motionCounts + start, n * sizeof(int16_t));
+            decimator->process(channels, n);
+        }
+    }
+    
+    // Convert one raw sample to Q16 physical units and fuse it into the attitude at the
+    // filter's current sample period
+    void fuseSample(const int16_t accelRaw[3], const int16_t gyroRaw[3], q16_t accelQ[3], q16_t gyroQ[3]) {
+        convertSample(accelRaw, gyroRaw, accelQ, gyroQ);
+        
+        const float DEG_TO_RAD_F = 3.14159265f / 180.0f;
+        float gx = q16ToFloat(gyroQ[0]) * DEG_TO_RAD_F;
+        float gy = q16ToFloat(gyroQ[1]) * DEG_TO_RAD_F;
+        float gz = q16ToFloat(gyroQ[2]) * DEG_TO_RAD_F;
+        float ax = q16ToFloat(accelQ[0]);
+        float ay = q16ToFloat(accelQ[1]);
+        float az = q16ToFloat(accelQ[2]);
+        
+        if (!ahrs.isInitialized()) {
+            // First sample: start from the accelerometer (and magnetometer) attitude
+            ahrs.initialize(ax, ay, az, magField[0], magField[1], magField[2], magAvailable);
+        } else if (magAvailable) {
+            ahrs.update(gx, gy, gz, ax, ay, az, magField[0], magField[1], magField[2]);
+        } else {
+            ahrs.update(gx, gy, gz, ax, ay, az);
+        }
+    }
+    
+    // Publish one fused sample: physical values plus the filter attitude as Euler angles
+    void report(const q16_t accelQ[3], const q16_t gyroQ[3], q16_t magnitudeQ, MotionData &motion) {
+        motion.accelX = q16ToFloat(accelQ[0]);
+        motion.accelY = q16ToFloat(accelQ[1]);
+        motion.accelZ = q16ToFloat(accelQ[2]);
+        motion.gyroX = q16ToFloat(gyroQ[0]);
+        motion.gyroY = q16ToFloat(gyroQ[1]);
+        motion.gyroZ = q16ToFloat(gyroQ[2]);
+        motion.motionMagnitude = q16ToFloat(magnitudeQ);
+        
+        // Motion detection (now properly calibrated)
+        motion.isMoving = (motion.motionMagnitude > 0.1f);
+        
+        // Angles matching the phone display: x = roll, y = pitch, z = heading (0..360)
+        EulerAngles euler = ahrs.getEuler();
+        motion.xAngle = euler.roll;
+        motion.yAngle = euler.pitch;
+        motion.zAngle = euler.yaw;
+        
+        // Set sensor working flag
+        motion.sensorWorking = true;
+    }
     
 public:
-    LSM6DS3_Direct(uint8_t addr = 0x6A) : address(addr) {}
+    LSM6DS3_Direct(uint8_t addr = LSM6DS3Map::i2cAddress) : address(addr) {}
+    
+    // Detector that gets every sample of processBlock(); null to stop feeding it
+    void setFallDetector(FallDetector* detector) {
+        fallDetector = detector;
+    }
+    
+    // Activity features over the same samples; null to stop feeding it
+    void setActivityExtractor(ActivityFeatureExtractor* extractor) {
+        activity = extractor;
+    }
+    
+    // Decimation chain over the same samples, IMU_CHANNEL_COUNT channels; null to stop
+    void setDecimator(DecimationChain* chain) {
+        decimator = chain;
+    }
+    
+    // Motion magnitudes of every sample processed since the last call; false if none
+    // (polled fallback, where only the snapshot exists)
+    bool takeMagnitudes(SeriesStats &out) {
+        if (passMagnitudes.count == 0) return false;
+        out = passMagnitudes;
+        passMagnitudes.clear();
+        return true;
+    }
+    
+    // Overwrite motion's accelerometer, gyroscope and magnitude values with the newest
+    // output of a decimation stage, at the programmed full scales. Angles are left alone.
+    bool readDecimated(uint8_t stage, MotionData &motion) {
+        int16_t v[IMU_CHANNEL_COUNT];
+        if (!decimator || !decimator->latest(stage, v)) return false;
+        q16_t accelQ[3], gyroQ[3];
+        convertSample(&v[IMU_CHANNEL_ACCEL_X], &v[IMU_CHANNEL_GYRO_X], accelQ, gyroQ);
+        motion.accelX = q16ToFloat(accelQ[0]);
+        motion.accelY = q16ToFloat(accelQ[1]);
+        motion.accelZ = q16ToFloat(accelQ[2]);
+        motion.gyroX = q16ToFloat(gyroQ[0]);
+        motion.gyroY = q16ToFloat(gyroQ[1]);
+        motion.gyroZ = q16ToFloat(gyroQ[2]);
+        motion.motionMagnitude = q16ToFloat(q16ScaleRaw(v[IMU_CHANNEL_MOTION], accelScaleQ32));
+        motion.isMoving = (motion.motionMagnitude > 0.1f);
+        return true;
+    }
+    
+    // Hand the newest magnetometer reading to the orientation filter. Coarse and full
+    // calibrations are used; until then yaw is integrated from the gyro alone.
+    void setMagneticField(const MagData &mag) {
+        magAvailable = mag.sensorWorking && mag.calibration != MAG_CAL_NONE;
+        magField[0] = mag.fieldX;
+        magField[1] = mag.fieldY;
+        magField[2] = mag.fieldZ;
+    }
     
     bool begin() {
         Serial.println("LSM6DS3: Starting ROBUST initialization...");
+        sensorBus.registerDevice(address, "LSM6DS3", LSM6DS3_AUTO_INCREMENT);
         
         // 1. Check device ID with multiple attempts
         Serial.println("LSM6DS3: Checking device ID...");
@@ -417,8 +1290,9 @@ public:
             Serial.print(" - Device ID = 0x");
             Serial.println(deviceId, 16);
             
-            if (deviceId == 0x69 || deviceId == 0x6A) {
+            if (deviceId == LSM6DS3Map::whoAmI || deviceId == LSM6DS3Map::whoAmIDsl) {
                 deviceFound = true;
+                isDsl = (deviceId == LSM6DS3Map::whoAmIDsl);
                 Serial.println("LSM6DS3: ✅ Device found with ID 0x" + String(deviceId, 16));
                 break;
             }
@@ -434,22 +1308,26 @@ public:
             
             // Try alternative address 0x6B
             Serial.println("LSM6DS3: Trying alternative address 0x6B...");
-            address = 0x6B;
+            address = LSM6DS3Map::i2cAddressAlt;
+            sensorBus.registerDevice(address, "LSM6DS3", LSM6DS3_AUTO_INCREMENT);
             deviceId = i2cReadRegister(address, LSM6DS3_WHO_AM_I);
             Serial.print("LSM6DS3: Alternative address Device ID = 0x");
             Serial.println(deviceId, 16);
             
-            if (deviceId != 0x69 && deviceId != 0x6A) {
+            if (deviceId != LSM6DS3Map::whoAmI && deviceId != LSM6DS3Map::whoAmIDsl) {
                 Serial.println("LSM6DS3: Alternative address also failed!");
                 return false;
             } else {
                 Serial.println("LSM6DS3: Found device at alternative address 0x6B!");
+                isDsl = (deviceId == LSM6DS3Map::whoAmIDsl);
             }
         }
         
+        samplePlan = LSM6DS3Map::SampleRead::plan(address);
+        
         // 2. Reset device completely
         Serial.println("LSM6DS3: Performing complete reset...");
-        i2cWriteRegister(address, LSM6DS3_CTRL3_C, 0x01);
+        i2cWriteRegister(address, LSM6DS3_CTRL3_C, LSM6DS3_CTRL3_C_RESET);
         delay(200);
         
         // 3. Wait for reset to complete
@@ -457,19 +1335,20 @@ public:
         Serial.print("LSM6DS3: Reset status = 0x");
         Serial.println(resetStatus, 16);
         
-        // 4. Configure accelerometer: 100Hz, ±2g, BDU enabled
+        // 4. Configure accelerometer: 208Hz, ±2g, BDU enabled
         Serial.println("LSM6DS3: Configuring accelerometer...");
-        i2cWriteRegister(address, LSM6DS3_CTRL1_XL, 0x50); // 100Hz, ±2g
+        odrCode = 0x5;
+        i2cWriteRegister(address, LSM6DS3_CTRL1_XL, lsm6ds3Ctrl1XlValue(odrCode, accelFsCode)); // 208Hz, ±2g
         delay(100);
         
-        // 5. Configure gyroscope: 100Hz, ±245dps, BDU enabled
+        // 5. Configure gyroscope: 208Hz, ±245dps, BDU enabled
         Serial.println("LSM6DS3: Configuring gyroscope...");
-        i2cWriteRegister(address, LSM6DS3_CTRL2_G, 0x50); // 100Hz, ±245dps
+        i2cWriteRegister(address, LSM6DS3_CTRL2_G, lsm6ds3Ctrl2GValue(odrCode, gyroFsCode)); // 208Hz, ±245dps
         delay(100);
         
         // 6. Configure control register: BDU=1, IF_INC=1
         Serial.println("LSM6DS3: Configuring control register...");
-        i2cWriteRegister(address, LSM6DS3_CTRL3_C, 0x04); // BDU=1, IF_INC=1
+        i2cWriteRegister(address, LSM6DS3_CTRL3_C, LSM6DS3_CTRL3_C_VALUE); // BDU=1, IF_INC=1
         delay(100);
         
         // 7. Verify configuration
@@ -493,8 +1372,8 @@ public:
         bool hasData = false;
         
         for (int attempt = 0; attempt < 5; attempt++) {
-            uint8_t testData[6];
-            i2cReadRegisters(address, LSM6DS3_OUTX_L_XL, testData, 6);
+            uint8_t testData[LSM6DS3Map::AccelRead::length];
+            i2cReadPlan(LSM6DS3Map::AccelRead::plan(address), testData);
             
             Serial.print("LSM6DS3: Attempt ");
             Serial.print(attempt + 1);
@@ -526,18 +1405,19 @@ public:
             Serial.println("LSM6DS3: ❌ No data after multiple attempts - trying alternative config...");
             
             // Try alternative configuration
-            i2cWriteRegister(address, LSM6DS3_CTRL1_XL, 0x60); // 833Hz, ±2g
+            odrCode = 0x6;
+            i2cWriteRegister(address, LSM6DS3_CTRL1_XL, lsm6ds3Ctrl1XlValue(odrCode, accelFsCode)); // 416Hz, ±2g
             delay(100);
-            i2cWriteRegister(address, LSM6DS3_CTRL2_G, 0x60); // 833Hz, ±245dps
+            i2cWriteRegister(address, LSM6DS3_CTRL2_G, lsm6ds3Ctrl2GValue(odrCode, gyroFsCode)); // 416Hz, ±245dps
             delay(100);
-            i2cWriteRegister(address, LSM6DS3_CTRL3_C, 0x04); // BDU=1
+            i2cWriteRegister(address, LSM6DS3_CTRL3_C, LSM6DS3_CTRL3_C_VALUE); // BDU=1, IF_INC=1
             delay(100);
             
             delay(1000);
             
             // Test again
-            uint8_t testData[6];
-            i2cReadRegisters(address, LSM6DS3_OUTX_L_XL, testData, 6);
+            uint8_t testData[LSM6DS3Map::AccelRead::length];
+            i2cReadPlan(LSM6DS3Map::AccelRead::plan(address), testData);
             Serial.print("LSM6DS3: Alternative test: ");
             for (int i = 0; i < 6; i++) {
                 Serial.print("0x");
@@ -565,96 +1445,603 @@ public:
     }
     
     void readData(MotionData &motion) {
-        uint8_t data[12];
+        // Gyroscope + accelerometer output registers in one 12-byte burst
+        ImuSample sample;
+        readLatestSample(sample);
+        
+        // Polled samples have gaps, so the decimated streams stop until the FIFO returns
+        if (decimator) decimator->reset();
         
-        // Read accelerometer data
-        i2cReadRegisters(address, LSM6DS3_OUTX_L_XL, data, 6);
+        // Polled samples have no fixed rate, so the period comes from the loop timing;
+        // a gap too long to integrate across restarts from the accelerometer attitude
+        unsigned long currentAngleTime = millis();
+        float dt = (lastAngleUpdate > 0) ? (currentAngleTime - lastAngleUpdate) / 1000.0f : 0.0f;
+        lastAngleUpdate = currentAngleTime;
+        if (dt > 0 && dt < 1.0f) {
+            ahrs.setSamplePeriod(dt);
+            setGravityRate(1.0f / dt);
+        } else {
+            ahrs.reset();
+            gravityPrimed = false;
+        }
         
-        // Convert to signed 16-bit values
-        int16_t accelX_raw = (int16_t)(data[1] << 8 | data[0]);
-        int16_t accelY_raw = (int16_t)(data[3] << 8 | data[2]);
-        int16_t accelZ_raw = (int16_t)(data[5] << 8 | data[4]);
+        q16_t accelQ[3], gyroQ[3];
+        fuseSample(sample.accel, sample.gyro, accelQ, gyroQ);
+        removeGravity(&sample, 1, motionCounts);
+        report(accelQ, gyroQ, q16ScaleRaw(motionCounts[0], accelScaleQ32), motion);
+        motion.peakMagnitude = motion.motionMagnitude;
+    }
+    
+    // Program the FIFO in continuous mode: gyro + accel data sets, equal decimation,
+    // watermark in samples. The sensor keeps buffering at full ODR between loop() passes.
+    bool beginFifo(uint8_t decimation, uint16_t watermarkSamples) {
+        uint8_t decCode = lsm6ds3DecimationCode(decimation);
+        if (decCode == 0) {
+            Serial.println("LSM6DS3: Unsupported FIFO decimation factor");
+            return false;
+        }
         
-        // Convert to m/s² (scale factor for ±2g range: 0.061 mg/LSB)
-        motion.accelX = accelX_raw * 0.061f * 0.001f * 9.81f;
-        motion.accelY = accelY_raw * 0.061f * 0.001f * 9.81f;
-        motion.accelZ = accelZ_raw * 0.061f * 0.001f * 9.81f;
+        uint16_t thresholdWords = watermarkSamples * LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+        if (thresholdWords > 0x0FFF) thresholdWords = 0x0FFF;
         
-        // Read gyroscope data
-        i2cReadRegisters(address, LSM6DS3_OUTX_L_G, data, 6);
+        // Reset FIFO contents by passing through bypass mode
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL5, RegisterValue<LSM6DS3Map::FIFO_CTRL5>::zero()
+                         .set<LSM6DS3Map::FIFO_MODE>(LSM6DS3_FIFO_MODE_BYPASS).value);
         
-        // Convert to signed 16-bit values
-        int16_t gyroX_raw = (int16_t)(data[1] << 8 | data[0]);
-        int16_t gyroY_raw = (int16_t)(data[3] << 8 | data[2]);
-        int16_t gyroZ_raw = (int16_t)(data[5] << 8 | data[4]);
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL1, thresholdWords & 0xFF);        // FTH[7:0]
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL2, RegisterValue<LSM6DS3Map::FIFO_CTRL2>::zero()
+                         .set<LSM6DS3Map::FTH_H>(thresholdWords >> 8).value);
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL3, RegisterValue<LSM6DS3Map::FIFO_CTRL3>::zero()
+                         .set<LSM6DS3Map::DEC_FIFO_GYRO>(decCode).set<LSM6DS3Map::DEC_FIFO_XL>(decCode).value);
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL4, 0x00);
         
-        // Convert to degrees/s (scale factor for ±245dps range: 8.75 mdps/LSB)
-        motion.gyroX = gyroX_raw * 8.75f * 0.001f;
-        motion.gyroY = gyroY_raw * 8.75f * 0.001f;
-        motion.gyroZ = gyroZ_raw * 8.75f * 0.001f;
+        // FIFO ODR follows the sensor ODR, FIFO_MODE = continuous (oldest data overwritten)
+        const uint8_t fifoCtrl5 = RegisterValue<LSM6DS3Map::FIFO_CTRL5>::zero()
+            .set<LSM6DS3Map::ODR_FIFO>(odrCode).set<LSM6DS3Map::FIFO_MODE>(LSM6DS3_FIFO_MODE_CONTINUOUS).value;
+        i2cWriteRegister(address, LSM6DS3_FIFO_CTRL5, fifoCtrl5);
         
-        // Calculate motion magnitude (excluding gravity)
-        // Remove gravity component (assuming Z-axis is vertical)
-        float accelX_noGravity = motion.accelX;
-        float accelY_noGravity = motion.accelY;
-        float accelZ_noGravity = motion.accelZ - 9.81f; // Remove gravity
+        uint8_t ctrl5 = i2cReadRegister(address, LSM6DS3_FIFO_CTRL5);
+        if (ctrl5 != fifoCtrl5) {
+            Serial.print("LSM6DS3: FIFO configuration failed, FIFO_CTRL5 = 0x");
+            Serial.println(ctrl5, 16);
+            fifoEnabled = false;
+            return false;
+        }
         
-        motion.motionMagnitude = sqrt(accelX_noGravity * accelX_noGravity + 
-                                    accelY_noGravity * accelY_noGravity + 
-                                    accelZ_noGravity * accelZ_noGravity);
+        fifoRateHz = lsm6ds3OdrHz(odrCode) / decimation;
+        fifoEnabled = true;
         
-        // Motion detection (now properly calibrated)
-        motion.isMoving = (motion.motionMagnitude > 0.1f);
+        Serial.print("LSM6DS3: FIFO streaming at ");
+        Serial.print(fifoRateHz, 1);
+        Serial.print("Hz, watermark ");
+        Serial.print(watermarkSamples);
+        Serial.println(" samples");
+        return true;
+    }
+    
+    bool isFifoEnabled() {
+        return fifoEnabled;
+    }
+    
+    // Change accelerometer/gyroscope range at runtime. The conversion scale follows the
+    // register write, so readings stay correct whatever range a power profile selects.
+    void setFullScale(uint8_t accelCode, uint8_t gyroCode) {
+        accelFsCode = accelCode & 0x03;
+        gyroFsCode = (gyroCode > LSM6DS3_GYRO_FS_125) ? 0 : gyroCode;
+        i2cWriteRegister(address, LSM6DS3_CTRL1_XL, lsm6ds3Ctrl1XlValue(odrCode, accelFsCode));
+        i2cWriteRegister(address, LSM6DS3_CTRL2_G, lsm6ds3Ctrl2GValue(odrCode, gyroFsCode));
+        accelScaleQ32 = lsm6ds3AccelScaleQ32(accelFsCode);
+        gyroScaleQ32 = lsm6ds3GyroScaleQ32(gyroFsCode);
+        gravityPrimed = false;
+        if (decimator) decimator->reset();
+        if (embeddedEnabled) {
+            writeWakeThreshold();
+        }
+    }
+    
+    // Rate at which samples are produced (FIFO rate after decimation, else sensor ODR)
+    float getSampleRateHz() {
+        return fifoEnabled ? fifoRateHz : lsm6ds3OdrHz(odrCode);
+    }
+    
+    // Free-fall, wake-up, 6D and tilt detection on the chip, latched until read and routed
+    // to INT1 (MD1_CFG, so the watermark/data-ready routing is untouched), plus the step
+    // counter. The thresholds assume the accelerometer ODR programmed in begin().
+    bool beginEmbeddedFunctions() {
+        float odrHz = lsm6ds3OdrHz(odrCode);
+        if (odrHz < 26.0f) {
+            Serial.println("LSM6DS3: Embedded functions need an accelerometer ODR of 26Hz or more");
+            return false;
+        }
         
-        // Calculate orientation angles (matching phone display format)
-        // Using complementary filter: accelerometer for long-term accuracy, gyro for responsiveness
-        unsigned long currentAngleTime = millis();
-        float dt = 0.0f;
+        uint32_t ffSamples = (uint32_t)(IMU_FREE_FALL_MS * odrHz / 1000.0f + 0.5f);
+        if (ffSamples > 0x3F) ffSamples = 0x3F;
+        i2cWriteRegister(address, LSM6DS3_FREE_FALL,
+                         RegisterValue<LSM6DS3Map::FREE_FALL>::zero()
+                             .set<LSM6DS3Map::FF_DUR>(ffSamples & 0x1F)
+                             .set<LSM6DS3Map::FF_THS>(IMU_FREE_FALL_THS_CODE).value);
+        i2cWriteRegister(address, LSM6DS3_WAKE_UP_DUR,
+                         RegisterValue<LSM6DS3Map::WAKE_UP_DUR>::zero()
+                             .set<LSM6DS3Map::FF_DUR5>(ffSamples >> 5)
+                             .set<LSM6DS3Map::WAKE_DUR>(IMU_WAKE_DURATION_SAMPLES).value);
+        writeWakeThreshold();
+        i2cWriteRegister(address, LSM6DS3_TAP_THS_6D,
+                         RegisterValue<LSM6DS3Map::TAP_THS_6D>::zero().set<LSM6DS3Map::SIXD_THS>(IMU_6D_THS_CODE).value);
         
-        if (lastAngleUpdate > 0) {
-            dt = (currentAngleTime - lastAngleUpdate) / 1000.0f;  // Convert to seconds
+        // The two chips put the pedometer/tilt enables in different registers
+        if (isDsl) {
+            i2cWriteRegister(address, LSM6DS3_TAP_CFG,
+                             RegisterValue<LSM6DS3Map::TAP_CFG>::zero()
+                                 .set<LSM6DS3Map::INTERRUPTS_ENABLE>(1).set<LSM6DS3Map::LIR>(1).value);
+            i2cWriteRegister(address, LSM6DS3_CTRL10_C,
+                             RegisterValue<LSM6DS3Map::CTRL10_C>::zero().set<LSM6DS3Map::FUNC_EN>(1)
+                                 .set<LSM6DS3Map::PEDO_EN_DSL>(1).set<LSM6DS3Map::TILT_EN_DSL>(1).value);
         } else {
-            dt = 0.01f;  // Default 10ms for first reading
+            i2cWriteRegister(address, LSM6DS3_TAP_CFG,
+                             RegisterValue<LSM6DS3Map::TAP_CFG>::zero()
+                                 .set<LSM6DS3Map::PEDO_EN>(1).set<LSM6DS3Map::TILT_EN>(1).set<LSM6DS3Map::LIR>(1).value);
+            i2cWriteRegister(address, LSM6DS3_CTRL10_C,
+                             RegisterValue<LSM6DS3Map::CTRL10_C>().set<LSM6DS3Map::FUNC_EN>(1).value);
         }
-        lastAngleUpdate = currentAngleTime;
+        i2cWriteRegister(address, LSM6DS3_MD1_CFG,
+                         RegisterValue<LSM6DS3Map::MD1_CFG>::zero()
+                             .set<LSM6DS3Map::INT1_WU>(1).set<LSM6DS3Map::INT1_FF>(1)
+                             .set<LSM6DS3Map::INT1_6D>(1).set<LSM6DS3Map::INT1_TILT>(1).value);
         
-        // Calculate angles from accelerometer (when device is relatively still)
-        // Convert accelerometer from m/s² to g
-        float ax_g = motion.accelX / 9.81f;
-        float ay_g = motion.accelY / 9.81f;
-        float az_g = motion.accelZ / 9.81f;
-        
-        // Calculate accelerometer-based angles (in degrees)
-        // Roll (rotation around X-axis) = xAngle
-        float accelRoll = atan2(ay_g, az_g) * 180.0f / 3.14159265f;
-        
-        // Pitch (rotation around Y-axis) = yAngle
-        float accelPitch = atan2(-ax_g, sqrt(ay_g * ay_g + az_g * az_g)) * 180.0f / 3.14159265f;
-        
-        // Yaw (rotation around Z-axis) = zAngle (approximate from accelerometer)
-        float accelYaw = atan2(ay_g, ax_g) * 180.0f / 3.14159265f;
-        
-        // Integrate gyroscope to get angle change
-        if (dt > 0 && dt < 1.0f) {  // Valid time delta (avoid huge jumps)
-            // Update angles using complementary filter
-            // ALPHA = 0.98 means 98% gyro (responsive), 2% accelerometer (stable)
-            pitch = ALPHA * (pitch + motion.gyroY * dt) + (1.0f - ALPHA) * accelPitch;
-            roll = ALPHA * (roll + motion.gyroX * dt) + (1.0f - ALPHA) * accelRoll;
-            yaw = ALPHA * (yaw + motion.gyroZ * dt) + (1.0f - ALPHA) * accelYaw;
+        eventPlan = LSM6DS3Map::EventSourceRead::plan(address);
+        functionPlan = LSM6DS3Map::FunctionRead::plan(address);
+        pendingEvents = 0;
+        lastEventMs = millis();
+        quiet = false;
+        embeddedEnabled = true;
+        Serial.print("LSM6DS3: Embedded functions on (free fall ");
+        Serial.print(ffSamples);
+        Serial.println(" samples, wake-up, 6D, tilt, pedometer)");
+        return true;
+    }
+    
+    bool hasEmbeddedFunctions() {
+        return embeddedEnabled;
+    }
+    
+    // Read and clear the latched event sources, merging them into the pending set.
+    // Called from the acquisition thread on every INT1 edge, or from takeEvents() and
+    // processBlock() when polling.
+    void latchEvents() {
+        if (!embeddedEnabled) return;
+        uint8_t src[LSM6DS3Map::EventSourceRead::length];
+        uint8_t func[LSM6DS3Map::FunctionRead::length];
+        i2cReadPlan(eventPlan, src);
+        i2cReadPlan(functionPlan, func);
+        
+        uint8_t wake = src[LSM6DS3Map::EventSourceRead::offset<LSM6DS3Map::WAKE_UP_SRC>()];
+        uint8_t d6d = src[LSM6DS3Map::EventSourceRead::offset<LSM6DS3Map::D6D_SRC>()];
+        uint8_t fn = func[LSM6DS3Map::FunctionRead::offset<LSM6DS3Map::FUNC_SRC>()];
+        uint8_t events = 0;
+        if (LSM6DS3Map::FF_IA::decode(wake)) events |= IMU_EVENT_FREE_FALL;
+        if (LSM6DS3Map::WU_IA::decode(wake)) events |= IMU_EVENT_WAKE_UP;
+        if (LSM6DS3Map::D6D_IA::decode(d6d)) {
+            events |= IMU_EVENT_ORIENTATION;
+            pendingOrientation = LSM6DS3Map::D6D_POSITION::decode(d6d);
+        }
+        if (LSM6DS3Map::TILT_IA::decode(fn)) events |= IMU_EVENT_TILT;
+        if (LSM6DS3Map::STEP_DETECTED::decode(fn)) events |= IMU_EVENT_STEP;
+        if (events) pendingEvents.fetch_or(events);
+        
+        latchedSteps = (uint16_t)(func[LSM6DS3Map::FunctionRead::offset<LSM6DS3Map::STEP_COUNTER_H>()] << 8 |
+                                  func[LSM6DS3Map::FunctionRead::offset<LSM6DS3Map::STEP_COUNTER_L>()]);
+    }
+    
+    // Hand the events raised since the last call, the 6D position and the step count to
+    // motion, and decide whether the sensor is quiet. Call before draining the FIFO so a
+    // wake-up or free fall gets the block it happened in fully processed.
+    bool takeEvents(MotionData &motion, bool interruptDriven) {
+        motion.events = 0;
+        motion.quiet = false;
+        if (!embeddedEnabled) return false;
+        eventsPolled = !interruptDriven;
+        if (eventsPolled) {
+            latchEvents();
+        }
+        motion.events = pendingEvents.exchange(0);
+        motion.orientation = pendingOrientation;
+        motion.steps = latchedSteps;
+        
+        unsigned long now = millis();
+        if (motion.events & IMU_MOTION_EVENTS) {
+            lastEventMs = now;
+        }
+        bool wasQuiet = quiet;
+        quiet = now - lastEventMs >= IMU_QUIET_MS;
+        if (wasQuiet && !quiet) {
+            // The attitude was not tracked while quiet; restart it from the accelerometer
+            ahrs.reset();
+        }
+        motion.quiet = quiet;
+        return motion.events != 0;
+    }
+    
+    // takeEvents() decided the quiet flag before the drain; an event latched since then
+    // ends it for the rest of the drain, so the block a fall starts in reaches the fall
+    // detector. The events stay pending for the next takeEvents().
+    void wakeOnPendingEvents(MotionData &motion) {
+        if (!embeddedEnabled) return;
+        if (eventsPolled) latchEvents();
+        if (!(pendingEvents.load() & IMU_MOTION_EVENTS)) return;
+        lastEventMs = millis();
+        quiet = false;
+        motion.quiet = false;
+        ahrs.reset();
+    }
+    
+    // Route data-ready (no FIFO) or FIFO watermark (FIFO enabled) to the INT1 pin
+    void enableInt1() {
+        i2cWriteRegister(address, LSM6DS3_INT1_CTRL, fifoEnabled ? LSM6DS3_INT1_FTH : LSM6DS3_INT1_DRDY_XL);
+    }
+    
+    // Start the gyro+accel output burst without waiting for it
+    void requestSample() {
+        if (!pendingSample.isBusy()) {
+            i2cSubmitPlan(samplePlan, pendingSample);
+        }
+    }
+    
+    // Read the current gyro+accel output registers (0x22..0x2D) in one 12-byte burst,
+    // taking the result of requestSample() when one is outstanding
+    void readLatestSample(ImuSample &sample) {
+        uint8_t localData[LSM6DS3Map::SampleRead::length];
+        const uint8_t* data = localData;
+        if (pendingSample.request.state != I2C_REQUEST_IDLE && i2cAwait(pendingSample)) {
+            data = pendingSample.data;
         } else {
-            // First reading or invalid dt - use accelerometer directly
-            pitch = accelPitch;
-            roll = accelRoll;
-            yaw = accelYaw;
+            i2cReadPlan(samplePlan, localData);
+        }
+        pendingSample.release();
+        const uint8_t gyroOffset = LSM6DS3Map::SampleRead::offset<LSM6DS3Map::OUTX_L_G>();
+        const uint8_t accelOffset = LSM6DS3Map::SampleRead::offset<LSM6DS3Map::OUTX_L_XL>();
+        for (uint8_t axis = 0; axis < 3; axis++) {
+            sample.gyro[axis] = (int16_t)(data[gyroOffset + axis * 2 + 1] << 8 | data[gyroOffset + axis * 2]);
+            sample.accel[axis] = (int16_t)(data[accelOffset + axis * 2 + 1] << 8 | data[accelOffset + axis * 2]);
+        }
+        sample.timestampUs = micros();
+    }
+    
+    // Drain up to IMU_BLOCK_CAPACITY samples from the FIFO using burst reads.
+    // Returns the number of samples placed in the block (0 when the FIFO is empty).
+    uint16_t readFifo(ImuSampleBlock &block) {
+        block.sampleRateHz = fifoRateHz;
+        block.periodUs = (fifoRateHz > 0) ? (unsigned long)(1000000.0f / fifoRateHz) : 0;
+        block.count = readFifoSamples(block.samples, IMU_BLOCK_CAPACITY, block.pending, block.overrun);
+        return block.count;
+    }
+    
+    // Burst-read up to maxSamples whole samples from the FIFO into out.
+    // pending receives the samples left behind, overrun the FIFO overflow flag.
+    uint16_t readFifoSamples(ImuSample* out, uint16_t maxSamples, uint16_t &pending, bool &overrun) {
+        pending = 0;
+        overrun = false;
+        if (!fifoEnabled) return 0;
+        uint32_t periodUs = (uint32_t)(1000000.0f / fifoRateHz);
+        
+        // FIFO_STATUS1..4: unread word count, flags and position in the gyro/accel pattern
+        typedef LSM6DS3Map::FifoStatusRead StatusRead;
+        uint8_t status[StatusRead::length];
+        i2cReadPlan(StatusRead::plan(address), status);
+        uint32_t now = micros();
+        
+        const uint8_t status2 = status[StatusRead::offset<LSM6DS3Map::FIFO_STATUS2>()];
+        uint16_t wordsAvailable = ((uint16_t)LSM6DS3Map::DIFF_FIFO_H::decode(status2) << 8) |
+                                  status[StatusRead::offset<LSM6DS3Map::FIFO_STATUS1>()];
+        uint16_t pattern = ((uint16_t)(status[StatusRead::offset<LSM6DS3Map::FIFO_STATUS4>()] & 0x03) << 8) |
+                           status[StatusRead::offset<LSM6DS3Map::FIFO_STATUS3>()];
+        overrun = LSM6DS3Map::FIFO_OVER_RUN::decode(status2) != 0;
+        if (LSM6DS3Map::FIFO_EMPTY::decode(status2)) return 0;
+        
+        // Re-align to the start of a sample if a previous read stopped mid-pattern
+        while (pattern != 0 && wordsAvailable > 0) {
+            uint8_t discard[2];
+            i2cReadRegisters(address, LSM6DS3_FIFO_DATA_OUT_L, discard, 2);
+            pattern = (pattern + 1) % LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+            wordsAvailable--;
+        }
+        
+        uint16_t samplesAvailable = wordsAvailable / LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+        if (samplesAvailable == 0) return 0;
+        uint16_t toRead = samplesAvailable;
+        if (toRead > maxSamples) toRead = maxSamples;
+        
+        // The newest sample in the FIFO was taken roughly now; older ones are one period apart
+        uint32_t firstTimestamp = now - (uint32_t)(samplesAvailable - 1) * periodUs;
+        
+        uint16_t count = 0;
+        uint8_t burst[LSM6DS3_FIFO_BURST_SAMPLES * LSM6DS3_FIFO_WORDS_PER_SAMPLE * 2];
+        while (count < toRead) {
+            uint16_t chunk = toRead - count;
+            if (chunk > LSM6DS3_FIFO_BURST_SAMPLES) chunk = LSM6DS3_FIFO_BURST_SAMPLES;
+            
+            // FIFO_DATA_OUT rolls back from _H to _L, so one burst returns consecutive words
+            i2cReadRegisters(address, LSM6DS3_FIFO_DATA_OUT_L, burst,
+                             chunk * LSM6DS3_FIFO_WORDS_PER_SAMPLE * 2);
+            
+            for (uint16_t i = 0; i < chunk; i++) {
+                const uint8_t* p = &burst[i * LSM6DS3_FIFO_WORDS_PER_SAMPLE * 2];
+                ImuSample &sample = out[count];
+                for (uint8_t axis = 0; axis < 3; axis++) {
+                    sample.gyro[axis] = (int16_t)(p[axis * 2 + 1] << 8 | p[axis * 2]);
+                    sample.accel[axis] = (int16_t)(p[6 + axis * 2 + 1] << 8 | p[6 + axis * 2]);
+                }
+                sample.timestampUs = firstTimestamp + (uint32_t)count * periodUs;
+                count++;
+            }
+        }
+        
+        pending = samplesAvailable - count;
+        return count;
+    }
+    
+    // Run every sample of a block through conversion, the orientation filter (at the
+    // fixed period of the FIFO rate), the fall detector and the activity features. Euler
+    // angles are computed once, for the newest sample; motion also gets the block's peak
+    // magnitude. While the embedded functions report the sensor quiet, only the newest
+    // sample is converted (an event latched during the drain ends that, see
+    // wakeOnPendingEvents()). The gravity estimate and the decimation chain get every
+    // sample either way (both work on raw counts and are cheap), so neither has gaps.
+    void processBlock(const ImuSampleBlock &block, MotionData &motion) {
+        if (block.count == 0) return;
+        setGravityRate(block.sampleRateHz);
+        removeGravity(block.samples, block.count, motionCounts);
+        if (decimator) feedDecimator(block);
+        if (quiet) wakeOnPendingEvents(motion);
+        
+        if (quiet) {
+            q16_t accelQ[3], gyroQ[3];
+            const ImuSample &newest = block.samples[block.count - 1];
+            convertSample(newest.accel, newest.gyro, accelQ, gyroQ);
+            report(accelQ, gyroQ, q16ScaleRaw(motionCounts[block.count - 1], accelScaleQ32), motion);
+            motion.peakMagnitude = motion.motionMagnitude;
+            for (uint16_t i = 0; i < block.count; i++) {
+                passMagnitudes.add(motion.motionMagnitude);
+            }
+            lastAngleUpdate = millis();
+            if (activity) {
+                activity->addQuiet(block.count, newest.timestampUs);
+            }
+            return;
+        }
+        
+        ahrs.setSamplePeriod(1.0f / block.sampleRateHz);
+        q16_t accelQ[3], gyroQ[3];
+        q16_t magnitudeQ = 0;
+        q16_t peakQ = 0;
+        for (uint16_t i = 0; i < block.count; i++) {
+            fuseSample(block.samples[i].accel, block.samples[i].gyro, accelQ, gyroQ);
+            magnitudeQ = q16ScaleRaw(motionCounts[i], accelScaleQ32);
+            if (magnitudeQ > peakQ) peakQ = magnitudeQ;
+            passMagnitudes.add(q16ToFloat(magnitudeQ));
+            if (fallDetector || activity) {
+                float accel[3], gyro[3];
+                for (uint8_t axis = 0; axis < 3; axis++) {
+                    accel[axis] = q16ToFloat(accelQ[axis]);
+                    gyro[axis] = q16ToFloat(gyroQ[axis]);
+                }
+                if (fallDetector) fallDetector->addSample(accel, gyro, block.samples[i].timestampUs);
+                if (activity) activity->addSample(accel, gyro, block.samples[i].timestampUs);
+            }
+        }
+        report(accelQ, gyroQ, magnitudeQ, motion);
+        motion.peakMagnitude = q16ToFloat(peakQ);
+        lastAngleUpdate = millis();
+    }
+};
+
+// ============================================================================
+// LPS22HB BAROMETRIC PRESSURE SENSOR
+// ============================================================================
+
+#ifndef BARO_USE_FIFO
+#define BARO_USE_FIFO 1                 // Stream into the on-chip FIFO instead of one-shot triggers
+#endif
+#define LPS22HB_FIFO_ODR_CODE 2         // ODR: 2 = 10Hz (enough to resolve a fall's height step)
+#define LPS22HB_FIFO_WATERMARK 10       // Slots before FTH_FIFO is raised (~1 drain per second)
+#define LPS22HB_FIFO_DEPTH 32           // Pressure + temperature slots held on chip
+#define LPS22HB_FIFO_MODE_BYPASS 0
+#define LPS22HB_FIFO_MODE_STREAM 2      // Oldest slot overwritten when full
+#define LPS22HB_PRESSURE_LSB_PER_HPA 4096.0f
+#define LPS22HB_TEMP_LSB_PER_DEGC 100.0f
+#define BARO_REFERENCE_ALPHA 0.01f      // Reference altitude follows slow drift (weather, HVAC)
+#define SEA_LEVEL_PRESSURE_HPA 1013.25f
+
+struct PressureData {
+    float pressure;                   // hPa (mean of the samples drained this pass)
+    float temperature;                // °C from the barometer's own sensor
+    float altitude;                   // m, barometric formula against SEA_LEVEL_PRESSURE_HPA
+    float heightChange;               // m, newest altitude minus the slow reference
+    float heightSwing;                // m, max - min altitude within this pass' samples
+    uint8_t samples;                  // Samples that contributed to this reading
+    bool sensorWorking;               // Sensor status flag
+};
+
+// Altitude (m) for a pressure (hPa) using the international barometric formula
+float pressureToAltitude(float pressureHpa) {
+    return 44330.0f * (1.0f - powf(pressureHpa / SEA_LEVEL_PRESSURE_HPA, 0.1903f));
+}
+
+class LPS22HB_Direct {
+private:
+    uint8_t address;
+    bool present = false;
+    bool fifoEnabled = false;
+    bool haveReference = false;
+    float referenceAltitude = 0.0f;
+
+    // STATUS + PRESS_OUT + TEMP_OUT (one-shot) and PRESS_OUT + TEMP_OUT (one FIFO slot)
+    BusReadPlan samplePlan;
+    BusReadPlan fifoSlotPlan;
+
+    static int32_t rawPressure(const uint8_t* p) {
+        // 24-bit two's complement, sign-extended through the top byte
+        return (int32_t)((uint32_t)p[2] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 8) >> 8;
+    }
+
+    static int16_t rawTemperature(const uint8_t* t) {
+        return (int16_t)(t[1] << 8 | t[0]);
+    }
+
+    // CTRL_REG2 always keeps IF_ADD_INC so multi-byte reads stay bursts
+    void writeCtrl2(bool fifo, bool oneShot) {
+        i2cWriteRegister(address, LPS22HB_CTRL_REG2, RegisterValue<LPS22HBMap::CTRL_REG2>::zero()
+                         .set<LPS22HBMap::IF_ADD_INC>(1)
+                         .set<LPS22HBMap::FIFO_EN>(fifo ? 1 : 0)
+                         .set<LPS22HBMap::ONE_SHOT>(oneShot ? 1 : 0).value);
+    }
+
+    void triggerOneShot() {
+        writeCtrl2(false, true);
+    }
+
+    // Fill the derived fields from a pressure sum and altitude range
+    void finish(PressureData &data, float pressureSum, float tempSum, float newestAltitude,
+                float minAltitude, float maxAltitude, uint8_t count) {
+        data.pressure = pressureSum / count;
+        data.temperature = tempSum / count;
+        data.altitude = pressureToAltitude(data.pressure);
+        data.heightSwing = maxAltitude - minAltitude;
+        data.samples = count;
+
+        if (!haveReference) {
+            referenceAltitude = newestAltitude;
+            haveReference = true;
+        }
+        data.heightChange = newestAltitude - referenceAltitude;
+        referenceAltitude += BARO_REFERENCE_ALPHA * (newestAltitude - referenceAltitude);
+        data.sensorWorking = true;
+    }
+
+    bool readOneShot(PressureData &data) {
+        typedef LPS22HBMap::SampleRead Read;
+        uint8_t block[Read::length];
+        i2cReadPlan(samplePlan, block);
+
+        bool ready = LPS22HBMap::P_DA::decode(block[Read::offset<LPS22HBMap::STATUS>()]) != 0;
+        if (ready) {
+            float pressure = rawPressure(&block[Read::offset<LPS22HBMap::PRESS_OUT_XL>()]) / LPS22HB_PRESSURE_LSB_PER_HPA;
+            float temperature = rawTemperature(&block[Read::offset<LPS22HBMap::TEMP_OUT_L>()]) / LPS22HB_TEMP_LSB_PER_DEGC;
+            float altitude = pressureToAltitude(pressure);
+            finish(data, pressure, temperature, altitude, altitude, altitude, 1);
+        }
+
+        // Keep one conversion in flight (ONE_SHOT self-clears when the conversion ends)
+        triggerOneShot();
+        return ready;
+    }
+
+    bool readFifo(PressureData &data) {
+        uint8_t status = i2cReadRegister(address, LPS22HBMap::FIFO_STATUS::address);
+        uint8_t stored = LPS22HBMap::FSS::decode(status);
+        if (stored == 0) return false;
+
+        // One slot per burst: the output registers do not wrap around like the IMU FIFO port
+        typedef LPS22HBMap::FifoSlotRead Read;
+        uint8_t slot[Read::length];
+        float pressureSum = 0.0f, tempSum = 0.0f;
+        float minAltitude = 0.0f, maxAltitude = 0.0f, altitude = 0.0f;
+        for (uint8_t i = 0; i < stored; i++) {
+            i2cReadPlan(fifoSlotPlan, slot);
+            float pressure = rawPressure(&slot[Read::offset<LPS22HBMap::PRESS_OUT_XL>()]) / LPS22HB_PRESSURE_LSB_PER_HPA;
+            pressureSum += pressure;
+            tempSum += rawTemperature(&slot[Read::offset<LPS22HBMap::TEMP_OUT_L>()]) / LPS22HB_TEMP_LSB_PER_DEGC;
+
+            altitude = pressureToAltitude(pressure);
+            if (i == 0 || altitude < minAltitude) minAltitude = altitude;
+            if (i == 0 || altitude > maxAltitude) maxAltitude = altitude;
+        }
+
+        finish(data, pressureSum, tempSum, altitude, minAltitude, maxAltitude, stored);
+        return true;
+    }
+
+public:
+    LPS22HB_Direct(uint8_t addr = LPS22HB_ADDR) : address(addr) {}
+
+    // Low-power one-shot mode: the sensor idles in power-down between triggered conversions
+    bool begin() {
+        sensorBus.registerDevice(address, "LPS22HB", LPS22HBMap::autoIncrementFlag);
+
+        uint8_t deviceId = i2cReadRegister(address, LPS22HB_WHO_AM_I);
+        if (deviceId != LPS22HBMap::whoAmI) {
+            Serial.print("LPS22HB: Device not found! ID = 0x");
+            Serial.println(deviceId, 16);
+            return false;
+        }
+
+        // Software reset, then wait for the register file to return to defaults
+        i2cWriteRegister(address, LPS22HB_CTRL_REG2, RegisterValue<LPS22HBMap::CTRL_REG2>()
+                         .set<LPS22HBMap::SWRESET>(1).value);
+        delay(10);
+
+        // ODR = 0 (one-shot), BDU so pressure bytes come from the same conversion
+        i2cWriteRegister(address, LPS22HB_CTRL_REG1, RegisterValue<LPS22HBMap::CTRL_REG1>::zero()
+                         .set<LPS22HBMap::ODR>(0).set<LPS22HBMap::BDU>(1).value);
+        i2cWriteRegister(address, LPS22HBMap::RES_CONF::address, RegisterValue<LPS22HBMap::RES_CONF>::zero()
+                         .set<LPS22HBMap::LC_EN>(1).value);
+
+        samplePlan = LPS22HBMap::SampleRead::plan(address);
+        present = true;
+        fifoSlotPlan = LPS22HBMap::FifoSlotRead::plan(address);
+        fifoEnabled = false;
+
+        // Start the first conversion so the first readData() has a result waiting
+        triggerOneShot();
+
+        Serial.println("LPS22HB: Direct hardware initialization successful!");
+        return true;
+    }
+
+    // Continuous conversion into the FIFO in stream mode. The low-pass filter smooths
+    // the 10Hz stream and each pass drains every buffered slot at once.
+    bool beginFifo(uint8_t odrCode, uint8_t watermark) {
+        if (watermark == 0 || watermark >= LPS22HB_FIFO_DEPTH) watermark = LPS22HB_FIFO_DEPTH - 1;
+
+        // Bypass first to clear the FIFO, then enable it in stream mode
+        i2cWriteRegister(address, LPS22HBMap::FIFO_CTRL::address, RegisterValue<LPS22HBMap::FIFO_CTRL>::zero()
+                         .set<LPS22HBMap::F_MODE>(LPS22HB_FIFO_MODE_BYPASS).value);
+        writeCtrl2(true, false);
+        const uint8_t fifoCtrl = RegisterValue<LPS22HBMap::FIFO_CTRL>::zero()
+            .set<LPS22HBMap::F_MODE>(LPS22HB_FIFO_MODE_STREAM).set<LPS22HBMap::WTM>(watermark).value;
+        i2cWriteRegister(address, LPS22HBMap::FIFO_CTRL::address, fifoCtrl);
+
+        // Continuous mode with LPF at ODR/9 and BDU
+        i2cWriteRegister(address, LPS22HB_CTRL_REG1, RegisterValue<LPS22HBMap::CTRL_REG1>::zero()
+                         .set<LPS22HBMap::ODR>(odrCode).set<LPS22HBMap::EN_LPFP>(1)
+                         .set<LPS22HBMap::BDU>(1).value);
+
+        if (i2cReadRegister(address, LPS22HBMap::FIFO_CTRL::address) != fifoCtrl) {
+            Serial.println("LPS22HB: FIFO configuration failed - staying in one-shot mode");
+            writeCtrl2(false, false);
+            i2cWriteRegister(address, LPS22HB_CTRL_REG1, RegisterValue<LPS22HBMap::CTRL_REG1>::zero()
+                             .set<LPS22HBMap::BDU>(1).value);
+            triggerOneShot();
+            return false;
         }
-        
-        // Store angles in motion structure (matching phone display: x-angle, y-angle, z-angle)
-        motion.xAngle = roll;   // X-axis rotation
-        motion.yAngle = pitch;  // Y-axis rotation
-        motion.zAngle = yaw;    // Z-axis rotation
-        
-        // Set sensor working flag
-        motion.sensorWorking = true;
+
+        fifoEnabled = true;
+        Serial.print("LPS22HB: FIFO streaming, watermark ");
+        Serial.print(watermark);
+        Serial.println(" samples");
+        return true;
+    }
+
+    bool isFifoEnabled() {
+        return fifoEnabled;
+    }
+
+    // Collect the newest pressure reading. In one-shot mode this takes the conversion
+    // triggered on the previous pass and starts the next one, so nothing waits on the
+    // ADC. In FIFO mode every buffered slot is drained and averaged.
+    // Returns false (data untouched) when no new sample was available.
+    bool readData(PressureData &data) {
+        if (!present) return false;
+        return fifoEnabled ? readFifo(data) : readOneShot(data);
     }
 };
 
@@ -665,21 +2052,32 @@ public:
 // Data Collection Parameters
 #define SAMPLE_FREQUENCY_MS 1000        // Sample every 1 second
 #define ANALYSIS_WINDOW_MS 10000        // Analyze over 10 seconds
-#define SMOOTHING_SAMPLES 10            // Average over 10 samples
-#define ALERT_THRESHOLD_COUNT 3         // Alert after 3 consecutive violations
-
-// Sound Level Thresholds (Calibrated Scale - above baseline)
-#define SOUND_SILENCE_MAX 5             // 0-5: Silence (near baseline)
-#define SOUND_LOW_MAX 20                // 6-20: Low sound
-#define SOUND_MEDIUM_MAX 50             // 21-50: Medium sound  
-#define SOUND_HIGH_MAX 100              // 51-100: High sound
-#define SOUND_DANGEROUS_MIN 100         // 100+: Dangerous/very loud
+#define SMOOTHING_SAMPLES 8             // Average over 8 samples (power of two)
+#define ALERT_ENTER_SECONDS 10          // Aggregated seconds beyond a rule's threshold before it fires
+#define ALERT_EXIT_SECONDS 30           // ... and back inside (past the hysteresis) before it clears
+#define TREND_WINDOW_SAMPLES 16         // Trend fit capacity (power of two, >= one analysis window of samples)
+
+// Aggregation tiers (min/max/mean/stddev/count per channel)
+#define AGGREGATE_BASE_MS 1000          // Tier 0: per-second summaries of every loop pass
+#define AGGREGATE_TIER1_PERIODS (ANALYSIS_WINDOW_MS / AGGREGATE_BASE_MS)  // Tier 1: one analysis window
+#define AGGREGATE_TIER2_PERIODS 6       // Tier 2: per-minute
+#define AGGREGATE_UPLOAD_TIER 2         // Tier sent to the proxy each time it closes
+#define RULE_WINDOW_SECONDS (ANALYSIS_WINDOW_MS / AGGREGATE_BASE_MS)  // Free falls and step rate span this
+
+// Sound Level Thresholds (dB SPL, fast Leq, unweighted)
+#define SOUND_SILENCE_MAX 40            // <=40 dB: Silence (quiet room)
+#define SOUND_LOW_MAX 55                // 41-55 dB: Low sound (conversation at a distance)
+#define SOUND_MEDIUM_MAX 70             // 56-70 dB: Medium sound (normal speech, TV)
+#define SOUND_HIGH_MAX 85               // 71-85 dB: High sound (shouting, busy street)
+// The silence edge follows the tracked noise floor: a steady fan or street hum is still
+// "silence" when nothing rises above it. DANGEROUS stays absolute, since exposure is.
+#define SOUND_SILENCE_OVER_FLOOR_DB VAD_ON_MARGIN_DB  // Silence up to this far above the floor
+#define SOUND_ALERT_OVER_FLOOR_DB 30    // Sound alert input: this far above the room's floor
 
 // Motion Intensity Thresholds (Gravity-Corrected Scale)
 #define MOTION_CALM_MAX 0.5             // 0-0.5 m/s²: Calm (gravity-corrected)
 #define MOTION_NORMAL_MAX 1.5           // 0.5-1.5 m/s²: Normal movement
 #define MOTION_ACTIVE_MAX 3.0           // 1.5-3.0 m/s²: Active movement
-#define MOTION_VIOLENT_MIN 3.0          // 3.0+ m/s²: Violent/shaking
 
 // Environmental Thresholds
 #define TEMP_COMFORTABLE_MIN 18.0       // 18-26°C: Comfortable
@@ -694,6 +2092,15 @@ public:
 #define HUMIDITY_UNCOMFORTABLE_MAX 85.0
 #define HUMIDITY_DANGEROUS_MIN 85.0     // 85+%: Dangerous
 
+// Status levels: hysteresis state machines fed with every aggregated second
+#define LEVEL_HYSTERESIS_SOUND 3.0f     // dB past a band edge before the status can move
+#define LEVEL_HYSTERESIS_MOTION 0.2f    // m/s²
+#define LEVEL_HYSTERESIS_TEMP 0.5f      // °C
+#define LEVEL_HYSTERESIS_HUMIDITY 2.0f  // %RH
+#define LEVEL_ENTER_DWELL_MS 1000       // A worse status needs two aggregated seconds in a row
+#define LEVEL_EXIT_DWELL_MS 5000        // A better one needs five
+#define LEVEL_EVENT_QUEUE 16            // Transitions waiting for display/upload (oldest dropped)
+
 // ============================================================================
 // INTELLIGENT DATA STRUCTURES
 // ============================================================================
@@ -703,230 +2110,536 @@ struct SensorData {
     float humidity;
     float motionMagnitude;
     float soundLevel;
+    float pressure;
     unsigned long timestamp;
 };
 
+// Channels summarised by the monitor's aggregation tiers
+enum SensorChannel {
+    CHANNEL_TEMPERATURE = 0,
+    CHANNEL_HUMIDITY,
+    CHANNEL_MOTION,
+    CHANNEL_SOUND,
+    CHANNEL_PRESSURE,
+    CHANNEL_COUNT
+};
+
+const char* channelName(uint8_t channel) {
+    static const char* const names[] = {"temperature", "humidity", "motion", "sound", "pressure"};
+    return channel < CHANNEL_COUNT ? names[channel] : "?";
+}
+
+// Alert rule inputs, refreshed every aggregated second: each channel's 1 s mean, then
+// their trends (units per second), then the IMU's hardware events over the last
+// RULE_WINDOW_SECONDS. A channel without a reading in that second is NaN.
+#define RULE_INPUT_TREND(channel) (CHANNEL_COUNT + (channel))
+#define RULE_INPUT_FREE_FALLS (2 * CHANNEL_COUNT)        // Free-fall events
+#define RULE_INPUT_STEP_RATE (2 * CHANNEL_COUNT + 1)     // Steps per minute
+#define RULE_INPUT_SOUND_OVER_FLOOR (2 * CHANNEL_COUNT + 2)  // dB above the noise floor (0 until known)
+#define RULE_INPUT_COUNT (2 * CHANNEL_COUNT + 3)
+
+// Alert rule groups, one per alert flag in AnalysisResult
+enum AlertGroup {
+    ALERT_GROUP_SOUND = 0,
+    ALERT_GROUP_MOTION,
+    ALERT_GROUP_ENVIRONMENT
+};
+
+// Default rules (threshold, hysteresis, input, comparator, consecutive, weight, group,
+// release), evaluated once per aggregated second with the status bands' hysteresis.
+// Replace at runtime with SET RULES or from the proxy; RESET RULES restores these.
+constexpr AlertRule DEFAULT_ALERT_RULES[] = {
+    {SOUND_HIGH_MAX, LEVEL_HYSTERESIS_SOUND, CHANNEL_SOUND, ALERT_ABOVE, ALERT_ENTER_SECONDS, 1,
+     ALERT_GROUP_SOUND, ALERT_EXIT_SECONDS},
+    {SOUND_ALERT_OVER_FLOOR_DB, LEVEL_HYSTERESIS_SOUND, RULE_INPUT_SOUND_OVER_FLOOR, ALERT_ABOVE,
+     ALERT_ENTER_SECONDS, 1, ALERT_GROUP_SOUND, ALERT_EXIT_SECONDS},
+    {MOTION_ACTIVE_MAX, LEVEL_HYSTERESIS_MOTION, CHANNEL_MOTION, ALERT_ABOVE, ALERT_ENTER_SECONDS, 1,
+     ALERT_GROUP_MOTION, ALERT_EXIT_SECONDS},
+    {TEMP_COMFORTABLE_MIN, LEVEL_HYSTERESIS_TEMP, CHANNEL_TEMPERATURE, ALERT_BELOW, ALERT_ENTER_SECONDS, 2,
+     ALERT_GROUP_ENVIRONMENT, ALERT_EXIT_SECONDS},
+    {TEMP_DANGEROUS_MIN, LEVEL_HYSTERESIS_TEMP, CHANNEL_TEMPERATURE, ALERT_ABOVE, ALERT_ENTER_SECONDS, 2,
+     ALERT_GROUP_ENVIRONMENT, ALERT_EXIT_SECONDS},
+    {HUMIDITY_COMFORTABLE_MIN, LEVEL_HYSTERESIS_HUMIDITY, CHANNEL_HUMIDITY, ALERT_BELOW, ALERT_ENTER_SECONDS, 2,
+     ALERT_GROUP_ENVIRONMENT, ALERT_EXIT_SECONDS},
+    {HUMIDITY_DANGEROUS_MIN, LEVEL_HYSTERESIS_HUMIDITY, CHANNEL_HUMIDITY, ALERT_ABOVE, ALERT_ENTER_SECONDS, 2,
+     ALERT_GROUP_ENVIRONMENT, ALERT_EXIT_SECONDS},
+    // Repeated free falls (the board being thrown or dropped again and again): fires on the
+    // second within RULE_WINDOW_SECONDS and clears once the window holds none. A single fall
+    // is FallDetector's to judge.
+    {1.0f, 1.0f, RULE_INPUT_FREE_FALLS, ALERT_ABOVE, 1, 2, ALERT_GROUP_MOTION, 1},
+};
+
+#define DEFAULT_ALERT_RULE_COUNT (sizeof(DEFAULT_ALERT_RULES) / sizeof(DEFAULT_ALERT_RULES[0]))
+#define ALERT_RULES_TEXT_MAX 512        // SET RULES / proxy payload, ~40 chars per rule
+
+enum SoundStatus {
+    SOUND_STATUS_SILENCE = 0,
+    SOUND_STATUS_LOW,
+    SOUND_STATUS_MEDIUM,
+    SOUND_STATUS_HIGH,
+    SOUND_STATUS_DANGEROUS
+};
+
+enum MotionStatus {
+    MOTION_STATUS_CALM = 0,
+    MOTION_STATUS_NORMAL,
+    MOTION_STATUS_ACTIVE,
+    MOTION_STATUS_VIOLENT
+};
+
+enum ComfortStatus {
+    COMFORT_STATUS_COMFORTABLE = 0,
+    COMFORT_STATUS_UNCOMFORTABLE,
+    COMFORT_STATUS_DANGEROUS
+};
+
+// Value doubles as the alert level: 0=Normal, 1=Warning, 2=Alert, 3=Critical
+enum OverallStatus {
+    OVERALL_STATUS_NORMAL = 0,
+    OVERALL_STATUS_WARNING,
+    OVERALL_STATUS_ALERT,
+    OVERALL_STATUS_CRITICAL
+};
+
+// Plain data, no heap: statuses are enum values, text only at the display/upload edge
 struct AnalysisResult {
-    // Sound Analysis
-    String soundStatus;
-    bool soundAlert;
-    int soundViolationCount;
-    
-    // Motion Analysis
-    String motionStatus;
-    bool motionAlert;
-    int motionViolationCount;
-    
-    // Environmental Analysis
-    String tempStatus;
-    String humidityStatus;
-    bool environmentalAlert;
-    
-    // Overall Health Status
-    String overallStatus;
-    int alertLevel; // 0=Normal, 1=Warning, 2=Alert, 3=Critical
+    uint8_t soundStatus;              // SoundStatus
+    uint8_t motionStatus;             // MotionStatus
+    uint8_t tempStatus;               // ComfortStatus
+    uint8_t humidityStatus;           // ComfortStatus
+    uint8_t overallStatus;            // OverallStatus
+    uint8_t soundAlert : 1;
+    uint8_t motionAlert : 1;
+    uint8_t environmentalAlert : 1;
+    uint16_t soundViolationCount;     // Consecutive seconds over the limit (saturating)
+    uint16_t motionViolationCount;
+};
+
+static_assert(std::is_pod<AnalysisResult>::value, "AnalysisResult must stay plain data (no String members)");
+
+// What a status transition is about
+enum LevelSource {
+    LEVEL_SOURCE_SOUND = 0,
+    LEVEL_SOURCE_MOTION,
+    LEVEL_SOURCE_TEMPERATURE,
+    LEVEL_SOURCE_HUMIDITY,
+    LEVEL_SOURCE_OVERALL,
+    LEVEL_SOURCE_SOUND_ALERT,         // Alert groups, in AlertGroup order (level 0 off, 1 on)
+    LEVEL_SOURCE_MOTION_ALERT,
+    LEVEL_SOURCE_ENVIRONMENT_ALERT,
+    LEVEL_SOURCE_COUNT
+};
+
+// Channel state machines, in LevelSource order
+#define LEVEL_MACHINES LEVEL_SOURCE_OVERALL
+
+// One status transition, uploaded instead of a full snapshot
+struct LevelEvent {
+    uint32_t timeMs;
+    float value;                      // Aggregated value (or alert score) that caused it
+    uint8_t source;                   // LevelSource
+    uint8_t from;
+    uint8_t to;
+};
+
+const char* soundStatusName(uint8_t status) {
+    static const char* const names[] = {"SILENCE", "LOW", "MEDIUM", "HIGH", "DANGEROUS"};
+    return status <= SOUND_STATUS_DANGEROUS ? names[status] : "?";
+}
+
+const char* motionStatusName(uint8_t status) {
+    static const char* const names[] = {"CALM", "NORMAL", "ACTIVE", "VIOLENT"};
+    return status <= MOTION_STATUS_VIOLENT ? names[status] : "?";
+}
+
+const char* comfortStatusName(uint8_t status) {
+    static const char* const names[] = {"COMFORTABLE", "UNCOMFORTABLE", "DANGEROUS"};
+    return status <= COMFORT_STATUS_DANGEROUS ? names[status] : "?";
+}
+
+const char* overallStatusName(uint8_t status) {
+    static const char* const names[] = {"NORMAL", "WARNING", "ALERT", "CRITICAL"};
+    return status <= OVERALL_STATUS_CRITICAL ? names[status] : "?";
+}
+
+const char* levelSourceName(uint8_t source) {
+    static const char* const names[] = {"sound", "motion", "temperature", "humidity", "overall",
+                                        "sound_alert", "motion_alert", "environment_alert"};
+    return source < LEVEL_SOURCE_COUNT ? names[source] : "?";
+}
+
+const char* levelName(uint8_t source, uint8_t level) {
+    switch (source) {
+        case LEVEL_SOURCE_SOUND: return soundStatusName(level);
+        case LEVEL_SOURCE_MOTION: return motionStatusName(level);
+        case LEVEL_SOURCE_TEMPERATURE:
+        case LEVEL_SOURCE_HUMIDITY: return comfortStatusName(level);
+        case LEVEL_SOURCE_OVERALL: return overallStatusName(level);
+        case LEVEL_SOURCE_SOUND_ALERT:
+        case LEVEL_SOURCE_MOTION_ALERT:
+        case LEVEL_SOURCE_ENVIRONMENT_ALERT: return level ? "ON" : "OFF";
+    }
+    return "?";
+}
+
+// Status bands per channel (same edges as the thresholds above; a value on an edge
+// belongs to the lower band) and the level each band maps to
+const BandConfig LEVEL_BANDS[LEVEL_MACHINES] = {
+    {{SOUND_SILENCE_MAX, SOUND_LOW_MAX, SOUND_MEDIUM_MAX, SOUND_HIGH_MAX},
+     {SOUND_STATUS_SILENCE, SOUND_STATUS_LOW, SOUND_STATUS_MEDIUM, SOUND_STATUS_HIGH, SOUND_STATUS_DANGEROUS},
+     4, LEVEL_HYSTERESIS_SOUND, LEVEL_ENTER_DWELL_MS, LEVEL_EXIT_DWELL_MS},
+    {{MOTION_CALM_MAX, MOTION_NORMAL_MAX, MOTION_ACTIVE_MAX},
+     {MOTION_STATUS_CALM, MOTION_STATUS_NORMAL, MOTION_STATUS_ACTIVE, MOTION_STATUS_VIOLENT},
+     3, LEVEL_HYSTERESIS_MOTION, LEVEL_ENTER_DWELL_MS, LEVEL_EXIT_DWELL_MS},
+    {{TEMP_COMFORTABLE_MIN, TEMP_COMFORTABLE_MAX, TEMP_DANGEROUS_MIN},
+     {COMFORT_STATUS_DANGEROUS, COMFORT_STATUS_COMFORTABLE, COMFORT_STATUS_UNCOMFORTABLE, COMFORT_STATUS_DANGEROUS},
+     3, LEVEL_HYSTERESIS_TEMP, LEVEL_ENTER_DWELL_MS, LEVEL_EXIT_DWELL_MS},
+    {{HUMIDITY_COMFORTABLE_MIN, HUMIDITY_COMFORTABLE_MAX, HUMIDITY_DANGEROUS_MIN},
+     {COMFORT_STATUS_DANGEROUS, COMFORT_STATUS_COMFORTABLE, COMFORT_STATUS_UNCOMFORTABLE, COMFORT_STATUS_DANGEROUS},
+     3, LEVEL_HYSTERESIS_HUMIDITY, LEVEL_ENTER_DWELL_MS, LEVEL_EXIT_DWELL_MS},
 };
 
+// Aggregated channel behind each state machine
+const uint8_t LEVEL_CHANNELS[LEVEL_MACHINES] = {CHANNEL_SOUND, CHANNEL_MOTION, CHANNEL_TEMPERATURE, CHANNEL_HUMIDITY};
+
 class IntelligentSensorMonitor {
 private:
-    SensorData dataBuffer[SMOOTHING_SAMPLES];
-    int bufferIndex;
-    unsigned long lastAnalysis;
+    // One window per channel; statistics update per sample, never by rescanning
+    RingWindow<float, SMOOTHING_SAMPLES> tempWindow;
+    RingWindow<float, SMOOTHING_SAMPLES> humidityWindow;
+    RingWindow<float, SMOOTHING_SAMPLES> motionWindow;
+    RingWindow<float, SMOOTHING_SAMPLES> soundWindow;
+    RingWindow<float, SMOOTHING_SAMPLES> pressureWindow;
+    RingWindow<unsigned long, SMOOTHING_SAMPLES> timeWindow;
+    
+    // Every value passed to addData, summarised per second / window / minute
+    SeriesAggregator aggregates;
     unsigned long lastSample;
     
-    // Alert Counters
-    int soundAlertCount;
-    int motionAlertCount;
-    int environmentalAlertCount;
+    // Alert rules, evaluated on every aggregated second
+    AlertRuleEngine alertRules;
+    
+    // Status levels, evaluated on every aggregated second
+    BandStateMachine levels[LEVEL_MACHINES];
+    uint32_t evaluatedSeconds;
+    AnalysisResult current;
     
-    // Trend Analysis
-    float tempTrend;
-    float humidityTrend;
-    float motionTrend;
-    float soundTrend;
+    // Transitions not yet taken by the display/upload
+    LevelEvent events[LEVEL_EVENT_QUEUE];
+    uint8_t eventHead;
+    uint8_t eventCount;
+    uint32_t droppedEvents;
+    
+    // Trend Analysis: least-squares fit over the last analysis window, per channel
+    LinearTrend<TREND_WINDOW_SAMPLES> trends[CHANNEL_COUNT];
+    
+    // IMU hardware events: free falls per aggregated second and the step counter at
+    // each, over the last RULE_WINDOW_SECONDS (ring indexed by evaluatedSeconds)
+    uint16_t secondFreeFalls;
+    uint16_t freeFallsPerSecond[RULE_WINDOW_SECONDS];
+    uint16_t stepsAtSecond[RULE_WINDOW_SECONDS];
+    uint32_t ruleSeconds;
+    uint16_t latestSteps;
+    
+    // Background level from the microphone's noise floor tracker
+    float soundFloorDb;
+    bool haveSoundFloor;
     
 public:
     IntelligentSensorMonitor() {
-        bufferIndex = 0;
-        lastAnalysis = 0;
         lastSample = 0;
-        soundAlertCount = 0;
-        motionAlertCount = 0;
-        environmentalAlertCount = 0;
-        tempTrend = 0;
-        humidityTrend = 0;
-        motionTrend = 0;
-        soundTrend = 0;
-        
-        // Initialize buffer
-        for (int i = 0; i < SMOOTHING_SAMPLES; i++) {
-            dataBuffer[i] = {0, 0, 0, 0, 0};
+        alertRules.load(DEFAULT_ALERT_RULES, DEFAULT_ALERT_RULE_COUNT, RULE_INPUT_COUNT);
+        for (uint8_t m = 0; m < LEVEL_MACHINES; m++) {
+            levels[m].begin(LEVEL_BANDS[m]);
         }
+        evaluatedSeconds = 0;
+        secondFreeFalls = 0;
+        memset(freeFallsPerSecond, 0, sizeof(freeFallsPerSecond));
+        memset(stepsAtSecond, 0, sizeof(stepsAtSecond));
+        ruleSeconds = 0;
+        latestSteps = 0;
+        soundFloorDb = 0.0f;
+        haveSoundFloor = false;
+        memset(&current, 0, sizeof(current));
+        eventHead = 0;
+        eventCount = 0;
+        droppedEvents = 0;
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+            trends[c].setSpan(ANALYSIS_WINDOW_MS);
+        }
+        aggregates.begin(CHANNEL_COUNT, AGGREGATE_BASE_MS, AGGREGATE_TIER1_PERIODS, AGGREGATE_TIER2_PERIODS);
     }
     
     // Add new sensor data with timestamp
-    void addData(float temp, float hum, float motion, float sound) {
+    // motionSamples, when given, summarises every IMU sample of the pass; tier 0 then
+    // gets the real spread and peaks of motion instead of one low-passed value a second.
+    // They land in the second the pass runs in, up to one pass after they were taken.
+    void addData(float temp, float hum, float motion, float sound, float pressure,
+                 const SeriesStats* motionSamples = nullptr) {
         unsigned long now = millis();
         
+        // Aggregation sees every pass, not just the smoothing samples
+        float values[CHANNEL_COUNT];
+        values[CHANNEL_TEMPERATURE] = temp;
+        values[CHANNEL_HUMIDITY] = hum;
+        values[CHANNEL_MOTION] = motionSamples ? NAN : motion;
+        values[CHANNEL_SOUND] = sound;
+        values[CHANNEL_PRESSURE] = pressure;
+        aggregates.add(values, now);
+        if (motionSamples) {
+            aggregates.addSummary(CHANNEL_MOTION, *motionSamples, now);
+        }
+        values[CHANNEL_MOTION] = motion;
+        
         // Only sample at specified frequency
         if (now - lastSample >= SAMPLE_FREQUENCY_MS) {
-            dataBuffer[bufferIndex] = {temp, hum, motion, sound, now};
-            bufferIndex = (bufferIndex + 1) % SMOOTHING_SAMPLES;
+            tempWindow.push(temp);
+            humidityWindow.push(hum);
+            motionWindow.push(motion);
+            soundWindow.push(sound);
+            if (!isnan(pressure)) pressureWindow.push(pressure);
+            timeWindow.push(now);
+            for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+                if (!isnan(values[c])) trends[c].add(now, values[c]);
+            }
             lastSample = now;
         }
     }
     
-    // Get smoothed data (averaged over multiple samples)
-    SensorData getSmoothedData() {
-        float tempSum = 0, humSum = 0, motionSum = 0, soundSum = 0;
-        int validSamples = 0;
-        
-        for (int i = 0; i < SMOOTHING_SAMPLES; i++) {
-            if (dataBuffer[i].timestamp > 0) {
-                tempSum += dataBuffer[i].temperature;
-                humSum += dataBuffer[i].humidity;
-                motionSum += dataBuffer[i].motionMagnitude;
-                soundSum += dataBuffer[i].soundLevel;
-                validSamples++;
-            }
-        }
-        
-        if (validSamples > 0) {
-            return {
-                tempSum / validSamples,
-                humSum / validSamples,
-                motionSum / validSamples,
-                soundSum / validSamples,
-                millis()
-            };
-        }
-        
-        return {0, 0, 0, 0, 0};
+    // Hardware events and step counter from the IMU's embedded functions
+    void addMotionEvents(uint8_t events, uint16_t steps) {
+        if (events & IMU_EVENT_FREE_FALL) secondFreeFalls++;
+        latestSteps = steps;
     }
     
-    // Analyze sound levels intelligently
-    String analyzeSound(float soundLevel) {
-        if (soundLevel <= SOUND_SILENCE_MAX) return "SILENCE";
-        if (soundLevel <= SOUND_LOW_MAX) return "LOW";
-        if (soundLevel <= SOUND_MEDIUM_MAX) return "MEDIUM";
-        if (soundLevel <= SOUND_HIGH_MAX) return "HIGH";
-        return "DANGEROUS";
+    // Tracked noise floor (dB, same scale as the sound channel); moves the silence edge
+    void setSoundFloor(bool known, float floorDb) {
+        haveSoundFloor = known;
+        soundFloorDb = floorDb;
+        if (!known) return;
+        float edge = floorDb + SOUND_SILENCE_OVER_FLOOR_DB;
+        if (edge < SOUND_SILENCE_MAX) edge = SOUND_SILENCE_MAX;
+        if (edge > SOUND_LOW_MAX - LEVEL_HYSTERESIS_SOUND) edge = SOUND_LOW_MAX - LEVEL_HYSTERESIS_SOUND;
+        levels[LEVEL_SOURCE_SOUND].setBoundary(0, edge);
     }
     
-    // Analyze motion intensity intelligently
-    String analyzeMotion(float motionMagnitude) {
-        if (motionMagnitude <= MOTION_CALM_MAX) return "CALM";
-        if (motionMagnitude <= MOTION_NORMAL_MAX) return "NORMAL";
-        if (motionMagnitude <= MOTION_ACTIVE_MAX) return "ACTIVE";
-        return "VIOLENT";
+    float getSilenceEdgeDb() const {
+        return levels[LEVEL_SOURCE_SOUND].getBoundary(0);
+    }
+    
+    // Get smoothed data (averaged over multiple samples)
+    SensorData getSmoothedData() {
+        if (timeWindow.isEmpty()) {
+            return {0, 0, 0, 0, 0, 0};
+        }
+        return {
+            tempWindow.mean(),
+            humidityWindow.mean(),
+            motionWindow.mean(),
+            soundWindow.mean(),
+            pressureWindow.isEmpty() ? NAN : pressureWindow.mean(),
+            millis()
+        };
     }
     
-    // Analyze environmental conditions
-    String analyzeTemperature(float temp) {
-        if (temp >= TEMP_COMFORTABLE_MIN && temp <= TEMP_COMFORTABLE_MAX) return "COMFORTABLE";
-        if (temp >= TEMP_UNCOMFORTABLE_MIN && temp <= TEMP_UNCOMFORTABLE_MAX) return "UNCOMFORTABLE";
-        return "DANGEROUS";
+    void pushEvent(uint8_t source, uint8_t from, uint8_t to, float value, uint32_t nowMs) {
+        if (eventCount == LEVEL_EVENT_QUEUE) {
+            eventHead = (eventHead + 1) % LEVEL_EVENT_QUEUE;
+            eventCount--;
+            droppedEvents++;
+        }
+        LevelEvent& e = events[(eventHead + eventCount) % LEVEL_EVENT_QUEUE];
+        e.timeMs = nowMs;
+        e.value = value;
+        e.source = source;
+        e.from = from;
+        e.to = to;
+        eventCount++;
     }
     
-    String analyzeHumidity(float humidity) {
-        if (humidity >= HUMIDITY_COMFORTABLE_MIN && humidity <= HUMIDITY_COMFORTABLE_MAX) return "COMFORTABLE";
-        if (humidity >= HUMIDITY_UNCOMFORTABLE_MIN && humidity <= HUMIDITY_UNCOMFORTABLE_MAX) return "UNCOMFORTABLE";
-        return "DANGEROUS";
+    // Rate of change per second over the analysis window (least squares)
+    float getTrend(uint8_t channel) const {
+        return channel < CHANNEL_COUNT ? trends[channel].slope() : 0.0f;
     }
     
-    // Calculate trends (rate of change)
-    void calculateTrends() {
-        if (bufferIndex >= 2) {
-            int prevIndex = (bufferIndex - 2 + SMOOTHING_SAMPLES) % SMOOTHING_SAMPLES;
-            int currIndex = (bufferIndex - 1 + SMOOTHING_SAMPLES) % SMOOTHING_SAMPLES;
-            
-            if (dataBuffer[prevIndex].timestamp > 0 && dataBuffer[currIndex].timestamp > 0) {
-                unsigned long timeDiff = dataBuffer[currIndex].timestamp - dataBuffer[prevIndex].timestamp;
-                if (timeDiff > 0) {
-                    tempTrend = (dataBuffer[currIndex].temperature - dataBuffer[prevIndex].temperature) / (timeDiff / 1000.0f);
-                    humidityTrend = (dataBuffer[currIndex].humidity - dataBuffer[prevIndex].humidity) / (timeDiff / 1000.0f);
-                    motionTrend = (dataBuffer[currIndex].motionMagnitude - dataBuffer[prevIndex].motionMagnitude) / (timeDiff / 1000.0f);
-                    soundTrend = (dataBuffer[currIndex].soundLevel - dataBuffer[prevIndex].soundLevel) / (timeDiff / 1000.0f);
-                }
-            }
-        }
+    // How well a straight line explains the window (0..1); low means the trend is noise
+    float getTrendFit(uint8_t channel) const {
+        return channel < CHANNEL_COUNT ? trends[channel].rSquared() : 0.0f;
     }
     
-    // Perform comprehensive analysis
-    AnalysisResult analyze() {
-        AnalysisResult result = {"", false, 0, "", false, 0, "", "", false, "", 0};
-        
+    // Perform comprehensive analysis on every newly closed aggregated second: status levels
+    // (bands with hysteresis and dwell) and alert rules (thresholds with hysteresis and
+    // enter/exit dwell counted in seconds) both read that second's summary, so a rule
+    // sees every second rather than one smoothed value per analysis window. Alert group
+    // and overall changes are queued as events. Returns false (result untouched) when
+    // nothing changed.
+    bool analyze(AnalysisResult& result) {
         unsigned long now = millis();
+        uint32_t seconds = aggregates.getClosedCount(0);
+        if (seconds == evaluatedSeconds) {
+            return false;
+        }
+        evaluatedSeconds = seconds;
+        bool changed = false;
+        AnalysisResult previous = current;
         
-        // Only analyze at specified intervals
-        if (now - lastAnalysis >= ANALYSIS_WINDOW_MS) {
-            SensorData smoothed = getSmoothedData();
-            calculateTrends();
-            
-            // Sound Analysis
-            result.soundStatus = analyzeSound(smoothed.soundLevel);
-            if (smoothed.soundLevel > SOUND_HIGH_MAX) {
-                soundAlertCount++;
-                result.soundAlert = (soundAlertCount >= ALERT_THRESHOLD_COUNT);
-                result.soundViolationCount = soundAlertCount;
-            } else {
-                soundAlertCount = 0;
-                result.soundAlert = false;
-                result.soundViolationCount = 0;
-            }
-            
-            // Motion Analysis
-            result.motionStatus = analyzeMotion(smoothed.motionMagnitude);
-            if (smoothed.motionMagnitude > MOTION_ACTIVE_MAX) {
-                motionAlertCount++;
-                result.motionAlert = (motionAlertCount >= ALERT_THRESHOLD_COUNT);
-                result.motionViolationCount = motionAlertCount;
-            } else {
-                motionAlertCount = 0;
-                result.motionAlert = false;
-                result.motionViolationCount = 0;
-            }
-            
-            // Environmental Analysis
-            result.tempStatus = analyzeTemperature(smoothed.temperature);
-            result.humidityStatus = analyzeHumidity(smoothed.humidity);
-            result.environmentalAlert = (result.tempStatus == "DANGEROUS" || result.humidityStatus == "DANGEROUS");
-            
-            // Overall Status Assessment
-            int alertScore = 0;
-            if (result.soundAlert) alertScore += 1;
-            if (result.motionAlert) alertScore += 1;
-            if (result.environmentalAlert) alertScore += 2;
-            
-            if (alertScore == 0) {
-                result.overallStatus = "NORMAL";
-                result.alertLevel = 0;
-            } else if (alertScore == 1) {
-                result.overallStatus = "WARNING";
-                result.alertLevel = 1;
-            } else if (alertScore == 2) {
-                result.overallStatus = "ALERT";
-                result.alertLevel = 2;
-  } else {
-                result.overallStatus = "CRITICAL";
-                result.alertLevel = 3;
+        // Status levels
+        for (uint8_t m = 0; m < LEVEL_MACHINES; m++) {
+            const SeriesStats& stats = aggregates.getSummary(0, LEVEL_CHANNELS[m]);
+            if (stats.count == 0) continue;
+            bool started = levels[m].isStarted();
+            if (levels[m].update(stats.mean, now)) {
+                pushEvent(m, levels[m].getPreviousLevel(), levels[m].getLevel(), stats.mean, now);
+                changed = true;
+            } else if (!started) {
+                changed = true;
             }
-            
-            lastAnalysis = now;
+        }
+        current.soundStatus = levels[LEVEL_SOURCE_SOUND].getLevel();
+        current.motionStatus = levels[LEVEL_SOURCE_MOTION].getLevel();
+        current.tempStatus = levels[LEVEL_SOURCE_TEMPERATURE].getLevel();
+        current.humidityStatus = levels[LEVEL_SOURCE_HUMIDITY].getLevel();
+        
+        // Rule inputs from the same second
+        float inputs[RULE_INPUT_COUNT];
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+            const SeriesStats& stats = aggregates.getSummary(0, c);
+            inputs[c] = stats.count ? stats.mean : NAN;
+            inputs[RULE_INPUT_TREND(c)] = trends[c].slope();
+        }
+        
+        // Hardware events over the last RULE_WINDOW_SECONDS. The slot about to be reused
+        // holds the step counter from that long ago; the counter wraps at 16 bits and the
+        // difference stays right across it.
+        uint8_t slot = ruleSeconds % RULE_WINDOW_SECONDS;
+        uint16_t stepsThen = stepsAtSecond[ruleSeconds < RULE_WINDOW_SECONDS ? 0 : slot];
+        uint32_t stepSpan = ruleSeconds < RULE_WINDOW_SECONDS ? ruleSeconds : RULE_WINDOW_SECONDS;
+        freeFallsPerSecond[slot] = secondFreeFalls;
+        stepsAtSecond[slot] = latestSteps;
+        secondFreeFalls = 0;
+        ruleSeconds++;
+        uint16_t freeFalls = 0;
+        for (uint8_t i = 0; i < RULE_WINDOW_SECONDS; i++) freeFalls += freeFallsPerSecond[i];
+        inputs[RULE_INPUT_FREE_FALLS] = freeFalls;
+        inputs[RULE_INPUT_STEP_RATE] = stepSpan
+            ? (uint16_t)(latestSteps - stepsThen) * 60000.0f / (stepSpan * AGGREGATE_BASE_MS) : 0.0f;
+        inputs[RULE_INPUT_SOUND_OVER_FLOOR] = haveSoundFloor ? inputs[CHANNEL_SOUND] - soundFloorDb : 0.0f;
+        alertRules.evaluate(inputs, RULE_INPUT_COUNT);
+        
+        current.soundAlert = alertRules.isGroupActive(ALERT_GROUP_SOUND);
+        current.soundViolationCount = alertRules.getGroupCount(ALERT_GROUP_SOUND);
+        current.motionAlert = alertRules.isGroupActive(ALERT_GROUP_MOTION);
+        current.motionViolationCount = alertRules.getGroupCount(ALERT_GROUP_MOTION);
+        current.environmentalAlert = alertRules.isGroupActive(ALERT_GROUP_ENVIRONMENT);
+        
+        // Overall Status Assessment
+        uint8_t alertScore = alertRules.getScore();
+        current.overallStatus = (alertScore >= OVERALL_STATUS_CRITICAL) ? (uint8_t)OVERALL_STATUS_CRITICAL : alertScore;
+        
+        // Transitions, so the upload does not have to poll for them
+        if (current.soundAlert != previous.soundAlert) {
+            pushEvent(LEVEL_SOURCE_SOUND_ALERT, previous.soundAlert, current.soundAlert, inputs[CHANNEL_SOUND], now);
+        }
+        if (current.motionAlert != previous.motionAlert) {
+            pushEvent(LEVEL_SOURCE_MOTION_ALERT, previous.motionAlert, current.motionAlert, inputs[CHANNEL_MOTION], now);
+        }
+        if (current.environmentalAlert != previous.environmentalAlert) {
+            pushEvent(LEVEL_SOURCE_ENVIRONMENT_ALERT, previous.environmentalAlert, current.environmentalAlert,
+                      alertScore, now);
+        }
+        if (current.overallStatus != previous.overallStatus) {
+            pushEvent(LEVEL_SOURCE_OVERALL, previous.overallStatus, current.overallStatus, alertScore, now);
+        }
+        if (memcmp(&current, &previous, sizeof(current)) != 0) {
+            changed = true;
         }
         
-        return result;
+        if (!changed) {
+            return false;
+        }
+        result = current;
+        return true;
+    }
+    
+    // Oldest transition not yet taken; false when there is none
+    bool takeEvent(LevelEvent& event) {
+        if (eventCount == 0) return false;
+        event = events[eventHead];
+        eventHead = (eventHead + 1) % LEVEL_EVENT_QUEUE;
+        eventCount--;
+        return true;
+    }
+    
+    uint32_t getDroppedEvents() const {
+        return droppedEvents;
     }
     
     // Get current sensor readings (smoothed)
     SensorData getCurrentReadings() {
         return getSmoothedData();
     }
+    
+    const SeriesAggregator& getAggregates() const {
+        return aggregates;
+    }
+    
+    // Replace the alert rules; false (old rules kept) if the table is invalid
+    bool loadRules(const AlertRule* rules, uint8_t count) {
+        return alertRules.load(rules, count, RULE_INPUT_COUNT);
+    }
+    
+    const AlertRuleEngine& getRules() const {
+        return alertRules;
+    }
 };
 
 // Global instance
 IntelligentSensorMonitor sensorMonitor;
 
+// Full-rate fall detection and activity features, fed by LSM6DS3_Direct::processBlock
+FallDetector fallDetector;
+ActivityFeatureExtractor activityFeatures;
+
+// Monitor and upload rate streams from the same samples
+DecimationChain imuDecimation;
+
+// Heap watch around the analysis cycle. newlib's arena only grows, so it is the heap
+// high-water mark; in-use bytes catch allocations that were not freed. Other threads
+// (WiFi) can allocate at the same moment, so a rare hit is worth a second look, a
+// steady count is a regression.
+struct HeapWatch {
+    uint32_t cycles;
+    uint32_t changedCycles;
+    size_t highWater;
+    size_t inUse;
+};
+
+HeapWatch analysisHeap = {0, 0, 0, 0};
+
+bool runAnalysis(AnalysisResult& result) {
+    struct mallinfo before = mallinfo();
+    bool ran = sensorMonitor.analyze(result);
+    struct mallinfo after = mallinfo();
+    
+    if (ran) {
+        analysisHeap.cycles++;
+        if (after.arena != before.arena || after.uordblks != before.uordblks) {
+            analysisHeap.changedCycles++;
+        }
+        analysisHeap.highWater = after.arena;
+        analysisHeap.inUse = after.uordblks;
+    }
+    return ran;
+}
+
+void printHeapStats() {
+    struct mallinfo info = mallinfo();
+    Serial.print("Heap: high-water "); Serial.print((unsigned long)info.arena);
+    Serial.print(" B, in use "); Serial.print((unsigned long)info.uordblks); Serial.println(" B");
+    Serial.print("Analysis cycles: "); Serial.print(analysisHeap.cycles);
+    Serial.print(", cycles that changed the heap: "); Serial.println(analysisHeap.changedCycles);
+}
+
 // ============================================================================
 // FIREBASE CLIENT (Using MXChipFirebase Library)
 // ============================================================================
@@ -940,6 +2653,232 @@ int currentProxyPort = PROXY_SERVER_PORT;
 String wifiSsidStr = String(WIFI_SSID);
 String wifiPasswordStr = String(WIFI_PASSWORD);
 
+// Upload the latest summary of AGGREGATE_UPLOAD_TIER once per closed period
+uint32_t uploadedSummaries = 0;
+
+void sendAggregateSummary() {
+    const SeriesAggregator& aggregates = sensorMonitor.getAggregates();
+    uint32_t closed = aggregates.getClosedCount(AGGREGATE_UPLOAD_TIER);
+    if (closed == uploadedSummaries) return;
+    
+    // Channels without a single reading in the period (no barometer) are left out
+    ChannelSummary channels[CHANNEL_COUNT];
+    uint8_t count = 0;
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+        const SeriesStats& stats = aggregates.getSummary(AGGREGATE_UPLOAD_TIER, c);
+        if (stats.count == 0) continue;
+        channels[count].name = channelName(c);
+        channels[count].min = stats.min;
+        channels[count].max = stats.max;
+        channels[count].mean = stats.mean;
+        channels[count].stddev = stats.stddev();
+        channels[count].count = stats.count;
+        count++;
+    }
+    // Marked sent either way: a missed minute is not worth blocking the next one
+    uploadedSummaries = closed;
+    firebaseClient.sendSummary(DEVICE_ID,
+                               aggregates.getPeriodMs(AGGREGATE_UPLOAD_TIER) / 1000,
+                               aggregates.getSummaryStartMs(AGGREGATE_UPLOAD_TIER) / 1000,
+                               channels, count);
+}
+
+// Activity features: the latest window is kept for GET ACT and uploaded as it closes
+ActivityFeatures lastActivity = {};
+uint32_t activityWindows = 0;
+
+void handleActivityFeatures() {
+    ActivityFeatures features;
+    if (!activityFeatures.poll(features)) return;
+    lastActivity = features;
+    activityWindows++;
+    if (WiFi.status() == WL_CONNECTED && firebaseClient.isConnected()) {
+        // Window start in sensor microseconds, carried over to the millis() clock
+        unsigned long startMs = millis() - (micros() - features.startUs) / 1000;
+        firebaseClient.sendActivity(DEVICE_ID, startMs / 1000, features.durationMs / 1000,
+                                    features.sma, features.enmo, features.jerkRms,
+                                    features.variance[0], features.variance[1], features.variance[2],
+                                    features.gyroRms, features.dominantHz, features.steps, features.cadence);
+    }
+}
+
+void printActivity() {
+    const ActivityFeatures& f = lastActivity;
+    Serial.print("Activity ("); Serial.print(activityWindows); Serial.print(" windows, last ");
+    Serial.print(f.durationMs / 1000); Serial.print("s, ");
+    Serial.print(f.activeSamples); Serial.print("/"); Serial.print(f.samples); Serial.println(" samples analysed)");
+    Serial.print("  SMA "); Serial.print(f.sma, 3);
+    Serial.print("g, ENMO "); Serial.print(f.enmo, 3);
+    Serial.print("g, jerk "); Serial.print(f.jerkRms, 2); Serial.println("g/s");
+    Serial.print("  var x/y/z "); Serial.print(f.variance[0], 4);
+    Serial.print(" "); Serial.print(f.variance[1], 4);
+    Serial.print(" "); Serial.print(f.variance[2], 4);
+    Serial.print(" g2, gyro "); Serial.print(f.gyroRms, 1); Serial.println(" dps RMS");
+    Serial.print("  dominant "); Serial.print(f.dominantHz, 1);
+    Serial.print("Hz ("); Serial.print(f.dominantShare * 100.0f, 0);
+    Serial.print("%), steps "); Serial.print(f.steps);
+    Serial.print(", cadence "); Serial.print(f.cadence, 0); Serial.println("/min");
+}
+
+void printDecimation() {
+    if (!imuDecimation.isActive()) {
+        Serial.println("Decimation: off (snapshot values go to the monitor and upload)");
+        return;
+    }
+    Serial.print("Decimation from "); Serial.print(imuDecimation.getInputRateHz(), 1);
+    Serial.print("Hz, "); Serial.print(imuDecimation.getMacsPerSecond()); Serial.println(" MAC/s");
+    for (uint8_t s = 0; s < imuDecimation.getStages(); s++) {
+        Serial.print("  stage "); Serial.print(s);
+        Serial.print(": "); Serial.print(imuDecimation.getRateHz(s), 2);
+        Serial.print("Hz (/"); Serial.print(imuDecimation.getFactor(s));
+        Serial.print(", "); Serial.print(imuDecimation.getTaps(s));
+        Serial.print(" taps), "); Serial.print(imuDecimation.getOutputCount(s)); Serial.print(" samples");
+        if (s == IMU_STAGE_MONITOR) Serial.print(" -> monitor");
+        if (s == IMU_STAGE_UPLOAD) Serial.print(" -> upload");
+        Serial.println();
+    }
+}
+
+void printAggregates() {
+    const SeriesAggregator& aggregates = sensorMonitor.getAggregates();
+    for (uint8_t t = 0; t < SERIES_TIERS; t++) {
+        Serial.print("Tier "); Serial.print(t);
+        Serial.print(" ("); Serial.print(aggregates.getPeriodMs(t) / 1000); Serial.print("s, ");
+        Serial.print(aggregates.getClosedCount(t)); Serial.println(" closed)");
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+            const SeriesStats& stats = aggregates.getSummary(t, c);
+            Serial.print("  "); Serial.print(channelName(c));
+            Serial.print(": min "); Serial.print(stats.min, 2);
+            Serial.print(" max "); Serial.print(stats.max, 2);
+            Serial.print(" mean "); Serial.print(stats.mean, 2);
+            Serial.print(" sd "); Serial.print(stats.stddev(), 2);
+            Serial.print(" n "); Serial.println(stats.count);
+        }
+    }
+}
+
+void printTrends() {
+    for (uint8_t c = 0; c < CHANNEL_COUNT; c++) {
+        Serial.print(channelName(c));
+        Serial.print(": "); Serial.print(sensorMonitor.getTrend(c), 4);
+        Serial.print("/s, R2 "); Serial.println(sensorMonitor.getTrendFit(c), 2);
+    }
+}
+
+// Status transitions: printed as they happen and uploaded one by one
+void handleLevelEvents() {
+    LevelEvent event;
+    while (sensorMonitor.takeEvent(event)) {
+        Serial.print("\nEvent: "); Serial.print(levelSourceName(event.source));
+        Serial.print(" "); Serial.print(levelName(event.source, event.from));
+        Serial.print(" -> "); Serial.print(levelName(event.source, event.to));
+        Serial.print(" ("); Serial.print(event.value, 2); Serial.println(")");
+        
+        if (WiFi.status() == WL_CONNECTED && firebaseClient.isConnected()) {
+            firebaseClient.sendEvent(DEVICE_ID, levelSourceName(event.source),
+                                     levelName(event.source, event.from), levelName(event.source, event.to),
+                                     event.value, event.timeMs / 1000);
+        }
+    }
+}
+
+// Hardware motion events, one line per pass that raised any
+void printImuEvents(const MotionData &m) {
+    Serial.print("IMU:");
+    if (m.events & IMU_EVENT_FREE_FALL) Serial.print(" free-fall");
+    if (m.events & IMU_EVENT_WAKE_UP) Serial.print(" wake-up");
+    if (m.events & IMU_EVENT_TILT) Serial.print(" tilt");
+    if (m.events & IMU_EVENT_STEP) Serial.print(" step");
+    if (m.events & IMU_EVENT_ORIENTATION) {
+        Serial.print(" 6D 0x"); Serial.print(m.orientation, 16);
+    }
+    Serial.print(" (steps "); Serial.print(m.steps); Serial.println(")");
+}
+
+// Falls: alerted on serial and uploaded immediately, with the evidence that scored them
+void handleFallEvents() {
+    FallEvent fall;
+    while (fallDetector.poll(fall)) {
+        // The impact is stamped in sensor microseconds; carry it over to the millis() clock
+        unsigned long impactMs = millis() - (micros() - fall.timestampUs) / 1000;
+        Serial.print("\n🚨 FALL DETECTED: confidence "); Serial.print(fall.confidence, 2);
+        Serial.print(", impact "); Serial.print(fall.impactG, 2); Serial.print("g");
+        Serial.print(", free fall "); Serial.print(fall.freeFallMs); Serial.print("ms");
+        Serial.print(", angle "); Serial.print(fall.angleChangeDeg, 0);
+        Serial.print(", height "); Serial.print(fall.heightDropM, 2); Serial.print("m");
+        Serial.println(fall.still ? ", lying still" : ", moving");
+        
+        if (WiFi.status() == WL_CONNECTED && firebaseClient.isConnected()) {
+            firebaseClient.sendFallEvent(DEVICE_ID, fall.confidence, fall.impactG, fall.impactZ,
+                                         fall.freeFallMs, fall.angleChangeDeg, fall.heightDropM,
+                                         fall.still, impactMs / 1000);
+        }
+    }
+}
+
+void printFallStats() {
+    static const char* const PHASES[] = {"idle", "free fall", "impact", "stillness", "cooldown"};
+    Serial.print("Fall detector: "); Serial.print(PHASES[fallDetector.getPhase()]);
+    Serial.print(", candidates "); Serial.print(fallDetector.getCandidates());
+    Serial.print(", falls "); Serial.println(fallDetector.getDetections());
+}
+
+// Parse and load an alert rule table in AlertRuleEngine's text form
+bool applyRulesText(const char* text) {
+    AlertRule rules[ALERT_RULES_MAX];
+    uint8_t count = 0;
+    if (!AlertRuleEngine::parse(text, rules, count, ALERT_RULES_MAX)) {
+        Serial.println("Rules: parse error (expected input,op,threshold,hysteresis,consecutive,weight,group[,release];...)");
+        return false;
+    }
+    if (!sensorMonitor.loadRules(rules, count)) {
+        Serial.println("Rules: invalid table, keeping the current rules");
+        return false;
+    }
+    Serial.print("Rules: loaded "); Serial.print(count); Serial.println(" rules");
+    return true;
+}
+
+void printRules() {
+    const AlertRuleEngine& rules = sensorMonitor.getRules();
+    for (uint8_t i = 0; i < rules.getRuleCount(); i++) {
+        const AlertRule& r = rules.getRule(i);
+        Serial.print("  ");
+        if (r.input == RULE_INPUT_FREE_FALLS) {
+            Serial.print("free falls");
+        } else if (r.input == RULE_INPUT_STEP_RATE) {
+            Serial.print("step rate");
+        } else if (r.input == RULE_INPUT_SOUND_OVER_FLOOR) {
+            Serial.print("sound over floor");
+        } else {
+            if (r.input >= CHANNEL_COUNT) Serial.print("trend ");
+            Serial.print(channelName(r.input % CHANNEL_COUNT));
+        }
+        Serial.print(r.comparator == ALERT_ABOVE ? " > " : " < "); Serial.print(r.threshold, 2);
+        Serial.print(" hyst "); Serial.print(r.hysteresis, 2);
+        Serial.print(" "); Serial.print(r.consecutive);
+        Serial.print("s/"); Serial.print(r.release ? r.release : r.consecutive); Serial.print("s");
+        Serial.print(" weight "); Serial.print(r.weight);
+        Serial.print(" group "); Serial.println(r.group);
+    }
+    char text[ALERT_RULES_TEXT_MAX];
+    if (rules.format(text, sizeof(text))) {
+        Serial.print("SET RULES "); Serial.println(text);
+    }
+}
+
+// Rules pushed by the proxy in its response; only reloaded when the text changes
+char proxyRules[ALERT_RULES_TEXT_MAX] = "";
+
+void checkProxyRules() {
+    char text[ALERT_RULES_TEXT_MAX];
+    if (!firebaseClient.takeRules(text, sizeof(text))) return;
+    if (strcmp(text, proxyRules) == 0) return;
+    strcpy(proxyRules, text);
+    Serial.println("Rules: update from proxy");
+    applyRulesText(text);
+}
+
 // Process serial commands (SET PROXY host[:port], SET WIFI ssid password)
 void processSerialCommands() {
     if (!Serial || Serial.available() == 0) return;
@@ -1003,12 +2942,36 @@ void processSerialCommands() {
                 }
             }
         }
+    } else if (cmd.equalsIgnoreCase("GET BUS")) {
+        printBusStats();
+    } else if (cmd.equalsIgnoreCase("GET HEAP")) {
+        printHeapStats();
+    } else if (cmd.equalsIgnoreCase("GET AGG")) {
+        printAggregates();
+    } else if (cmd.equalsIgnoreCase("GET TREND")) {
+        printTrends();
+    } else if (cmd.equalsIgnoreCase("GET FALL")) {
+        printFallStats();
+    } else if (cmd.equalsIgnoreCase("GET ACT")) {
+        printActivity();
+    } else if (cmd.equalsIgnoreCase("GET DECIM")) {
+        printDecimation();
+    } else if (cmd.length() > 10 && cmd.substring(0, 10).equalsIgnoreCase("SET RULES ")) {
+        String payload = cmd.substring(10);
+        payload.trim();
+        applyRulesText(payload.c_str());
+    } else if (cmd.equalsIgnoreCase("GET RULES")) {
+        printRules();
+    } else if (cmd.equalsIgnoreCase("RESET RULES")) {
+        sensorMonitor.loadRules(DEFAULT_ALERT_RULES, DEFAULT_ALERT_RULE_COUNT);
+        proxyRules[0] = '\0';
+        Serial.println("Rules: defaults restored");
     } else if (cmd.equalsIgnoreCase("GET CONFIG")) {
         Serial.println("Current configuration:");
         Serial.print("  WiFi SSID: "); Serial.println(wifiSsidStr);
         Serial.print("  Proxy Host: "); Serial.print(currentProxyHost); Serial.print(":"); Serial.println(currentProxyPort);
     } else {
-        Serial.println("Unknown command. Use 'SET PROXY host[:port]', 'SET WIFI ssid password', or 'GET CONFIG'.");
+        Serial.println("Unknown command. Use 'SET PROXY host[:port]', 'SET WIFI ssid password', 'GET BUS', 'GET HEAP', 'GET AGG', 'GET TREND', 'GET FALL', 'GET ACT', 'GET DECIM', 'SET RULES ...', 'GET RULES', 'RESET RULES', or 'GET CONFIG'.");
     }
 }
 
@@ -1019,10 +2982,15 @@ void processSerialCommands() {
 // Display Settings
 #define DISPLAY_INTERVAL_MS 1000        // Update values every 1 second
 #define AVERAGE_WINDOW_MS 2000           // Average over 2 seconds for display
+#define DISPLAY_SAMPLE_MS 500            // One display sample per 500ms
+#define DISPLAY_AVERAGE_SAMPLES 4        // AVERAGE_WINDOW_MS / DISPLAY_SAMPLE_MS (power of two)
 #define SIGNIFICANT_CHANGE_TEMP 0.1     // 0.1°C change (very sensitive)
 #define SIGNIFICANT_CHANGE_HUM 0.5      // 0.5% change (very sensitive)
 #define SIGNIFICANT_CHANGE_MOTION 0.05  // 0.05 m/s² change (very sensitive)
-#define SIGNIFICANT_CHANGE_SOUND 1      // 1 unit change (very sensitive)
+#define SIGNIFICANT_CHANGE_SOUND 1      // 1 dB change (very sensitive)
+
+// Latest barometer reading, defined with the other sensor data below
+extern PressureData pressureData;
 
 class CleanDisplay {
 private:
@@ -1030,33 +2998,43 @@ private:
     unsigned long lastDataCollection;
     bool headerPrinted;
     
-    // Running averages
-    float tempSum, humSum, motionSum, soundSum;
-    int sampleCount;
+    // Sliding averages over AVERAGE_WINDOW_MS
+    RingWindow<float, DISPLAY_AVERAGE_SAMPLES> tempWindow;
+    RingWindow<float, DISPLAY_AVERAGE_SAMPLES> humWindow;
+    RingWindow<float, DISPLAY_AVERAGE_SAMPLES> motionWindow;
+    RingWindow<float, DISPLAY_AVERAGE_SAMPLES> soundWindow;
     
     // Previous values for change detection
     float lastTemp, lastHum, lastMotion, lastSound;
     
+    // Latest analysis, rendered as text only here
+    AnalysisResult analysis;
+    bool haveAnalysis;
+    
 public:
     CleanDisplay() {
         lastDisplay = 0;
         lastDataCollection = 0;
         headerPrinted = false;
-        tempSum = humSum = motionSum = soundSum = 0;
-        sampleCount = 0;
         lastTemp = lastHum = lastMotion = lastSound = -999;
+        memset(&analysis, 0, sizeof(analysis));
+        haveAnalysis = false;
+    }
+    
+    void setAnalysis(const AnalysisResult& result) {
+        analysis = result;
+        haveAnalysis = true;
     }
     
     void addData(float temp, float hum, float motion, float sound) {
         unsigned long now = millis();
         
         // Collect data every 500ms for better real-time accuracy
-        if (now - lastDataCollection >= 500) {
-            tempSum += temp;
-            humSum += hum;
-            motionSum += motion;
-            soundSum += sound;
-            sampleCount++;
+        if (now - lastDataCollection >= DISPLAY_SAMPLE_MS) {
+            tempWindow.push(temp);
+            humWindow.push(hum);
+            motionWindow.push(motion);
+            soundWindow.push(sound);
             lastDataCollection = now;
         }
     }
@@ -1068,10 +3046,10 @@ public:
         if (now - lastDisplay >= DISPLAY_INTERVAL_MS) {
             
             // Calculate averages
-            float avgTemp = (sampleCount > 0) ? tempSum / sampleCount : 0;
-            float avgHum = (sampleCount > 0) ? humSum / sampleCount : 0;
-            float avgMotion = (sampleCount > 0) ? motionSum / sampleCount : 0;
-            float avgSound = (sampleCount > 0) ? soundSum / sampleCount : 0;
+            float avgTemp = tempWindow.mean();
+            float avgHum = humWindow.mean();
+            float avgMotion = motionWindow.mean();
+            float avgSound = soundWindow.mean();
             
             // Print header only once
             if (!headerPrinted) {
@@ -1113,10 +3091,34 @@ public:
                 Serial.print("°                    ");
             }
             
+            // Pressure (if barometer is working)
+            if (pressureData.sensorWorking) {
+                Serial.print("\nPressure:    ");
+                Serial.print(pressureData.pressure, 2);
+                Serial.print(" hPa (");
+                Serial.print(pressureData.heightChange, 2);
+                Serial.print(" m)                ");
+            }
+            
             // Sound
             Serial.print("\nSound:       ");
             Serial.print(avgSound, 1);
-            Serial.print(" units                  ");
+            Serial.print(" dB                     ");
+            
+            // Status from the last aggregated second
+            if (haveAnalysis) {
+                Serial.print("\nStatus:      ");
+                Serial.print(overallStatusName(analysis.overallStatus));
+                Serial.print(" (sound ");
+                Serial.print(soundStatusName(analysis.soundStatus));
+                Serial.print(", motion ");
+                Serial.print(motionStatusName(analysis.motionStatus));
+                Serial.print(", temp ");
+                Serial.print(comfortStatusName(analysis.tempStatus));
+                Serial.print(", humidity ");
+                Serial.print(comfortStatusName(analysis.humidityStatus));
+                Serial.print(")          ");
+            }
             
             // Update last values
             lastTemp = avgTemp;
@@ -1124,9 +3126,6 @@ public:
             lastMotion = avgMotion;
             lastSound = avgSound;
             
-            // Reset for next cycle
-            tempSum = humSum = motionSum = soundSum = 0;
-            sampleCount = 0;
             lastDisplay = now;
         }
     }
@@ -1141,6 +3140,121 @@ CleanDisplay cleanDisplay;
 
 HTS221_Direct hts221;
 LSM6DS3_Direct lsm6ds3;
+LPS22HB_Direct lps22hb;
+LIS2MDL_Direct lis2mdl;
+
+// ============================================================================
+// INTERRUPT-DRIVEN IMU ACQUISITION
+// ============================================================================
+
+ImuAcquisition imuAcquisition;
+
+// Called by ImuAcquisition::service() in the acquisition context
+uint16_t readImuForAcquisition(void* ctx, ImuSample* out, uint16_t maxSamples, uint32_t irqTimestampUs) {
+    LSM6DS3_Direct* imu = static_cast<LSM6DS3_Direct*>(ctx);
+    imu->latchEvents();                 // Latched event sources would hold INT1 high
+    if (imu->isFifoEnabled()) {
+        uint16_t pending;
+        bool overrun;
+        uint16_t count = imu->readFifoSamples(out, maxSamples, pending, overrun);
+        if (overrun) imuAcquisition.noteSourceOverrun();
+        return count;
+    }
+    if (maxSamples == 0) return 0;
+    imu->readLatestSample(out[0]);
+    out[0].timestampUs = irqTimestampUs; // Data-ready edge is the true sample time
+    return 1;
+}
+
+#if IMU_USE_INT1
+#define IMU_SIGNAL_INT1 0x01
+
+Thread imuThread(osPriorityHigh, 2048);
+
+void lsm6ds3Int1Isr() {
+    imuAcquisition.onInterrupt(micros());
+    imuThread.signal_set(IMU_SIGNAL_INT1);
+}
+
+// Acquisition thread: sleeps until INT1 fires, then moves samples into the ring
+void imuAcquisitionTask() {
+    while (true) {
+        Thread::signal_wait(IMU_SIGNAL_INT1, IMU_INT1_SERVICE_TIMEOUT_MS);
+        imuAcquisition.service();
+    }
+}
+
+bool beginImuInterrupt() {
+    imuAcquisition.begin(readImuForAcquisition, &lsm6ds3);
+    lsm6ds3.enableInt1();
+    pinMode(LSM6DS3_INT1_PIN, INPUT);
+    attachInterrupt(LSM6DS3_INT1_PIN, lsm6ds3Int1Isr, RISING);
+    imuThread.start(imuAcquisitionTask);
+    
+    Serial.print("LSM6DS3: INT1 acquisition on ");
+    Serial.println(lsm6ds3.isFifoEnabled() ? "FIFO watermark" : "data-ready");
+    return true;
+}
+#endif
+
+// Fill a block from whichever acquisition path is active (INT1 ring or FIFO polling)
+uint16_t fillImuBlock(ImuSampleBlock &block) {
+    if (imuAcquisition.isActive()) {
+        block.sampleRateHz = lsm6ds3.getSampleRateHz();
+        block.periodUs = (unsigned long)(1000000.0f / block.sampleRateHz);
+        block.count = imuAcquisition.drain(block.samples, IMU_BLOCK_CAPACITY);
+        block.pending = imuAcquisition.available();
+        block.overrun = imuAcquisition.takeOverrun();
+        return block.count;
+    }
+    return lsm6ds3.readFifo(block);
+}
+
+// Blocks that arrived after lost samples (FIFO overrun on the chip or a full ring)
+uint32_t imuOverrunBlocks = 0;
+
+void reportImuOverrun() {
+    imuOverrunBlocks++;
+    Serial.print("LSM6DS3: samples lost before this block (");
+    Serial.print(imuOverrunBlocks);
+    Serial.print(" blocks so far");
+    if (imuAcquisition.isActive()) {
+        Serial.print(", ring dropped "); Serial.print(imuAcquisition.getDroppedSamples());
+        Serial.print(", FIFO overruns "); Serial.print(imuAcquisition.getSourceOverruns());
+    }
+    Serial.println(")");
+}
+
+// Plan the decimation chain from the rate the IMU actually streams at
+bool beginImuDecimation() {
+    DecimationConfig config = imuDecimation.getConfig();
+    config.stages = 4;
+    config.rateHz[0] = IMU_DECIM_STAGE1_HZ;
+    config.rateHz[1] = IMU_DECIM_STAGE2_HZ;
+    config.rateHz[IMU_STAGE_MONITOR] = IMU_MONITOR_RATE_HZ;
+    config.rateHz[IMU_STAGE_UPLOAD] = IMU_UPLOAD_RATE_HZ;
+    config.passband = IMU_DECIM_PASSBAND;
+    config.tapsPerFactor = IMU_DECIM_TAPS_PER_FACTOR;
+    // The output stages make the sharp cut, at the lowest input rate where taps are cheapest
+    config.taps[0] = 0;
+    config.taps[1] = 0;
+    config.taps[IMU_STAGE_MONITOR] = IMU_DECIM_OUTPUT_TAPS;
+    config.taps[IMU_STAGE_UPLOAD] = IMU_DECIM_OUTPUT_TAPS;
+    if (!imuDecimation.begin(config, lsm6ds3.getSampleRateHz(), IMU_CHANNEL_COUNT)) {
+        Serial.println("LSM6DS3: Decimation chain does not fit this rate - monitor and upload use snapshots");
+        lsm6ds3.setDecimator(nullptr);
+        return false;
+    }
+    lsm6ds3.setDecimator(&imuDecimation);
+    Serial.print("LSM6DS3: Decimating ");
+    Serial.print(imuDecimation.getInputRateHz(), 1);
+    Serial.print("Hz to ");
+    Serial.print(imuDecimation.getRateHz(IMU_STAGE_MONITOR), 2);
+    Serial.print("Hz (monitor) and ");
+    Serial.print(imuDecimation.getRateHz(IMU_STAGE_UPLOAD), 2);
+    Serial.println("Hz (upload)");
+    return true;
+}
 
 // ============================================================================
 // MAIN SETUP & LOOP
@@ -1166,11 +3280,10 @@ void setup() {
     
     // First, scan I2C bus to see what devices are present
     Serial.println("Scanning I2C bus...");
-    Wire.begin();
+    i2cBusBegin();
     int deviceCount = 0;
     for (uint8_t addr = 0x08; addr < 0x78; addr++) {
-        Wire.beginTransmission(addr);
-        if (Wire.endTransmission() == 0) {
+        if (i2cProbe(addr)) {
             Serial.print("I2C device found at address 0x");
             Serial.println(addr, 16);
             deviceCount++;
@@ -1182,22 +3295,19 @@ void setup() {
     
     // Test specific addresses
     Serial.println("Testing specific sensor addresses:");
-    Wire.beginTransmission(0x5F); // HTS221
-    if (Wire.endTransmission() == 0) {
+    if (i2cProbe(0x5F)) { // HTS221
         Serial.println("✅ HTS221 (0x5F) - RESPONDING");
     } else {
         Serial.println("❌ HTS221 (0x5F) - NOT RESPONDING");
     }
     
-    Wire.beginTransmission(0x6A); // LSM6DS3
-    if (Wire.endTransmission() == 0) {
+    if (i2cProbe(0x6A)) { // LSM6DS3
         Serial.println("✅ LSM6DS3 (0x6A) - RESPONDING");
     } else {
         Serial.println("❌ LSM6DS3 (0x6A) - NOT RESPONDING");
     }
     
-    Wire.beginTransmission(0x6B); // LSM6DS3 alternative
-    if (Wire.endTransmission() == 0) {
+    if (i2cProbe(0x6B)) { // LSM6DS3 alternative
         Serial.println("✅ LSM6DS3 (0x6B) - RESPONDING");
     } else {
         Serial.println("❌ LSM6DS3 (0x6B) - NOT RESPONDING");
@@ -1206,9 +3316,49 @@ void setup() {
     
     bool hts221_ok = hts221.begin();
     bool lsm6ds3_ok = lsm6ds3.begin();
+    bool lps22hb_ok = lps22hb.begin();
+    bool lis2mdl_ok = lis2mdl.begin(MAG_USE_CONTINUOUS);
+#if BARO_USE_FIFO
+    if (lps22hb_ok) {
+        lps22hb.beginFifo(LPS22HB_FIFO_ODR_CODE, LPS22HB_FIFO_WATERMARK);
+    }
+#endif
+#if IMU_USE_FIFO
+    if (lsm6ds3_ok && !lsm6ds3.beginFifo(LSM6DS3_FIFO_DECIMATION,
+                                          IMU_USE_INT1 ? LSM6DS3_INT1_WATERMARK : LSM6DS3_FIFO_WATERMARK)) {
+        Serial.println("LSM6DS3: FIFO unavailable - falling back to single-sample polling");
+    }
+#endif
+#if IMU_USE_INT1
+    if (lsm6ds3_ok) {
+        beginImuInterrupt();
+    }
+#endif
+    if (lsm6ds3_ok) {
+        // At ±2g a single-axis impact clips below the detector's impact threshold
+        lsm6ds3.setFullScale(IMU_FALL_ACCEL_FS_CODE, LSM6DS3_GYRO_FS_CODE);
+        lsm6ds3.setFallDetector(&fallDetector);
+        ActivityConfig activityConfig = activityFeatures.getConfig();
+        activityConfig.windowMs = ACTIVITY_WINDOW_MS;
+        activityFeatures.begin(activityConfig, lsm6ds3.getSampleRateHz());
+        lsm6ds3.setActivityExtractor(&activityFeatures);
+    }
+#if IMU_DECIMATION
+    if (lsm6ds3_ok) {
+        beginImuDecimation();
+    }
+#endif
+#if IMU_USE_EMBEDDED
+    if (lsm6ds3_ok) {
+        lsm6ds3.beginEmbeddedFunctions();
+    }
+#endif
     
-    // Calibrate sound sensor
-    soundCalibrator.calibrate();
+    // Start noise-floor tracking and continuous microphone capture (no quiet period needed)
+    soundCalibrator.begin();
+#if MIC_USE_DMA
+    beginMicCapture();
+#endif
     
     Serial.println("============================================================");
     Serial.println("SENSOR INITIALIZATION SUMMARY:");
@@ -1216,8 +3366,12 @@ void setup() {
     Serial.println(hts221_ok ? "✅ OK" : "❌ FAILED");
     Serial.print("LSM6DS3 (Accelerometer & Gyroscope): ");
     Serial.println(lsm6ds3_ok ? "✅ OK" : "❌ FAILED");
+    Serial.print("LPS22HB (Barometric Pressure): ");
+    Serial.println(lps22hb_ok ? "✅ OK" : "❌ FAILED");
+    Serial.print("LIS2MDL (Magnetometer): ");
+    Serial.println(lis2mdl_ok ? "✅ OK" : "❌ FAILED");
     Serial.print("Microphone (Sound Sensor): ");
-    Serial.println(soundCalibrator.isReady() ? "✅ CALIBRATED" : "❌ FAILED");
+    Serial.println(soundCalibrator.isReady() ? "✅ OK (stored noise floor)" : "✅ OK (learning noise floor)");
     Serial.println("============================================================");
     
     // Initialize WiFi using AZ3166 WiFi libraries
@@ -1259,6 +3413,7 @@ void setup() {
         firebaseClient.setPath(PROXY_ENDPOINT);
         firebaseClient.setDeviceId(DEVICE_ID);
         firebaseClient.setUpdateInterval(FIREBASE_UPDATE_INTERVAL_MS);
+        firebaseClient.setMotionSnapshot(UPLOAD_MOTION_SNAPSHOT);
         
         // Try to initialize client using runtime host & port
         if (firebaseClient.begin(currentProxyHost, currentProxyPort)) {
@@ -1290,6 +3445,51 @@ void setup() {
 // Global motion data for angle display
 MotionData motion;
 
+// Latest barometer reading (kept between passes when no new sample arrives)
+PressureData pressureData;
+
+// Latest magnetometer reading, fed to the orientation filter before each IMU block
+MagData magData;
+
+// Sample block drained from the LSM6DS3 FIFO each pass
+ImuSampleBlock imuBlock;
+
+// Cleared when the LSM6DS3 fails during operation; loop() then simulates a board at rest
+bool lsm6ds3_working = true;
+
+// What the idle wait drained since the last pass: loop() folds it into its own drain
+bool imuDrainedWhileIdle = false;
+float imuIdlePeak = 0.0f;
+
+// Drain everything buffered since the last call, block by block
+bool drainImuBlocks(MotionData &data, float &peak) {
+    bool gotSamples = false;
+    do {
+        if (fillImuBlock(imuBlock) == 0) break;
+        if (imuBlock.overrun) reportImuOverrun();
+        lsm6ds3.processBlock(imuBlock, data);
+        if (data.peakMagnitude > peak) peak = data.peakMagnitude;
+        gotSamples = true;
+    } while (imuBlock.pending > 0);
+    return gotSamples;
+}
+
+// Wait out the rest of the pass with the fall detector fed, so a fall is uploaded as
+// soon as it is decided rather than after the wait
+void waitForNextPass(unsigned long ms) {
+    unsigned long start = millis();
+    while (true) {
+        if (lsm6ds3_working && (lsm6ds3.isFifoEnabled() || imuAcquisition.isActive())) {
+            if (drainImuBlocks(motion, imuIdlePeak)) imuDrainedWhileIdle = true;
+            handleFallEvents();
+        }
+        unsigned long elapsed = millis() - start;
+        if (elapsed >= ms) break;
+        unsigned long left = ms - elapsed;
+        delay(left < IMU_IDLE_DRAIN_MS ? left : IMU_IDLE_DRAIN_MS);
+    }
+}
+
 void loop() {
     // Evaluate runtime serial commands frequently
     processSerialCommands();
@@ -1297,13 +3497,50 @@ void loop() {
     float temperature = 0.0f, humidity = 0.0f;
     motion.sensorWorking = false; // Default to false
     
+    // Queue this pass' register reads so the bus works while the CPU samples the mic
+    hts221.requestData();
+    if (!lsm6ds3.isFifoEnabled() && !imuAcquisition.isActive()) {
+        lsm6ds3.requestSample();
+    }
+    
+    // Read microphone (calibrated)
+    int micValue = soundCalibrator.getCalibratedSoundLevel();
+    soundCalibrator.maintain();
+    
     // Read HTS221 (temperature & humidity)
   hts221.readData(temperature, humidity);
 
+    // Read LIS2MDL (heading reference for the IMU's yaw)
+    uint8_t magCalibration = magData.calibration;
+    if (lis2mdl.readData(magData)) {
+        lsm6ds3.setMagneticField(magData);
+        if (magData.calibration != magCalibration) {
+            Serial.print("🧭 Magnetometer calibration: ");
+            Serial.println(magData.calibration == MAG_CAL_FULL ? "full" : "coarse (rotate the board to refine)");
+        }
+    }
+
     // Read LSM6DS3 (motion) - with fallback
-    static bool lsm6ds3_working = true;
     if (lsm6ds3_working) {
-        lsm6ds3.readData(motion);
+        if (lsm6ds3.takeEvents(motion, imuAcquisition.isActive())) {
+            printImuEvents(motion);
+        }
+        if (lsm6ds3.isFifoEnabled() || imuAcquisition.isActive()) {
+            // Drain everything buffered since the idle wait last did
+            float blockPeak = imuIdlePeak;
+            bool gotSamples = drainImuBlocks(motion, blockPeak) || imuDrainedWhileIdle;
+            imuIdlePeak = 0.0f;
+            imuDrainedWhileIdle = false;
+            
+            if (gotSamples) {
+                motion.sensorWorking = true;   // The pass' reset cleared what an idle-wait drain set
+                motion.peakMagnitude = blockPeak;
+            } else {
+                lsm6ds3.readData(motion);
+            }
+        } else {
+            lsm6ds3.readData(motion);
+        }
         if (!motion.sensorWorking) {
             lsm6ds3_working = false;
             Serial.println("LSM6DS3: Sensor failed during operation - using fallback");
@@ -1317,15 +3554,49 @@ void loop() {
         motion.gyroY = 0.0f;
         motion.gyroZ = 0.0f;
         motion.motionMagnitude = 0.0f; // No motion (gravity-corrected)
+        motion.peakMagnitude = 0.0f;
         motion.xAngle = 0.0f;
         motion.yAngle = 0.0f;
         motion.zAngle = 0.0f;
         motion.isMoving = false;
         motion.sensorWorking = false;
+        motion.events = 0;
+        motion.quiet = false;
     }
     
-    // Read microphone (calibrated)
-    int micValue = soundCalibrator.getCalibratedSoundLevel();
+    // Read LPS22HB (pressure) - keeps the last reading if no new sample arrived
+    lps22hb.readData(pressureData);
+    fallDetector.setHeight(pressureData.heightChange);
+    handleFallEvents();
+    handleActivityFeatures();
+    
+    // The monitor and the upload read the decimated streams at their own rates; the
+    // snapshot is the fallback while the chain has nothing (polling, or no chain)
+    MotionData monitorMotion = motion;
+    MotionData uploadMotion = motion;
+    if (motion.sensorWorking) {
+        lsm6ds3.readDecimated(IMU_STAGE_MONITOR, monitorMotion);
+        lsm6ds3.readDecimated(IMU_STAGE_UPLOAD, uploadMotion);
+    }
+    
+    // Feed the monitor at its own sampling rate
+    sensorMonitor.setSoundFloor(soundCalibrator.isReady(), soundCalibrator.getNoiseFloorDb());
+    // No barometer: NaN keeps the pressure channel out of the windows, trends and uploads
+    float pressure = pressureData.sensorWorking ? pressureData.pressure : NAN;
+    SeriesStats motionSamples;
+    bool haveMotionSamples = motion.sensorWorking && lsm6ds3.takeMagnitudes(motionSamples);
+    sensorMonitor.addData(temperature, humidity, monitorMotion.motionMagnitude, micValue, pressure,
+                          haveMotionSamples ? &motionSamples : nullptr);
+    if (lsm6ds3.hasEmbeddedFunctions()) {
+        sensorMonitor.addMotionEvents(motion.events, motion.steps);
+    }
+    
+    // Re-evaluate on every aggregated second; the display only hears about changes
+    AnalysisResult analysis;
+    if (runAnalysis(analysis)) {
+        cleanDisplay.setAnalysis(analysis);
+    }
+    handleLevelEvents();
     
     // Add data to clean display system
     cleanDisplay.addData(temperature, humidity, motion.motionMagnitude, micValue);
@@ -1333,26 +3604,40 @@ void loop() {
     // Display clean report every 5 seconds
     cleanDisplay.display();
     
-    // Send data to Firebase if WiFi is connected
+    // Send data to Firebase if WiFi is connected. Status and alert changes already went
+    // up as events (handleLevelEvents); this rate-limited snapshot stays because it is
+    // the devices/{id}/current record the dashboard reads and its response carries the
+    // proxy's rule table back (checkProxyRules).
     if (WiFi.status() == WL_CONNECTED && firebaseClient.isConnected()) {
+        // Spectral detail only while sound is active (and the DMA capture has analysed it)
+        SpectrumFeatures spectrum = {};
+        bool haveSpectrum = soundCalibrator.isSoundActive() && micSpectrum.getFeatures(spectrum);
         firebaseClient.sendSensorData(
             DEVICE_ID,
             temperature, 
             humidity, 
-            motion.motionMagnitude,
+            uploadMotion.motionMagnitude,
             micValue,
-            motion.accelX,
-            motion.accelY,
-            motion.accelZ,
-            motion.gyroX,
-            motion.gyroY,
-            motion.gyroZ,
+            uploadMotion.accelX,
+            uploadMotion.accelY,
+            uploadMotion.accelZ,
+            uploadMotion.gyroX,
+            uploadMotion.gyroY,
+            uploadMotion.gyroZ,
             motion.xAngle,
             motion.yAngle,
-            motion.zAngle
+            motion.zAngle,
+            pressure,
+            pressureData.heightChange,
+            haveSpectrum ? spectrum.bandDb : nullptr,
+            haveSpectrum ? SPECTRUM_BANDS : 0,
+            spectrum.centroidHz,
+            spectrum.flatnessQ15 / 32767.0f
         );
+        sendAggregateSummary();
+        checkProxyRules();
     }
     
-    // Simple delay
-    delay(1000);
+    // Wait for the next pass; falls decided meanwhile go out straight away
+    waitForNextPass(1000);
 }
@@ -0,0 +1,162 @@
+/*
+ * Host check for the interrupt-driven IMU acquisition path.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -pthread -Ilib/SensorPipeline/src \
+ *       tools/acquisition_check/imu_acquisition_check.cpp \
+ *       lib/SensorPipeline/src/ImuAcquisition.cpp -o imu_acquisition_check && ./imu_acquisition_check
+ *
+ * SimulatedImuInterrupt stands in for INT1 and the LSM6DS3 FIFO: it fires at the
+ * watermark period and hands out a numbered ramp (gyro X carries the sample number),
+ * so every sample loop() receives can be checked for order, timing and loss. The
+ * scenarios run the same ImuAcquisition the firmware uses: a steady 104 Hz stream
+ * drained once a second, a consumer stall longer than the ring, and a producer thread
+ * racing the consumer. Each prints expected vs got; any mismatch exits with status 1.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include "ImuAcquisition.h"
+
+#define CHECK_PERIOD_US 9615          // 104 Hz ODR
+#define CHECK_WATERMARK 26            // FIFO watermark: one interrupt per 250 ms
+#define CHECK_DRAIN_MAX 64
+
+static int failures = 0;
+
+static void expect(const char* scenario, const char* what, uint32_t expected, uint32_t got) {
+    printf("%-10s %-24s expected %-8u got %-8u %s\n", scenario, what, expected, got,
+           expected == got ? "ok" : "MISMATCH");
+    if (expected != got) failures++;
+}
+
+// What the consumer saw: ramp continuity, timestamp spacing and gaps
+struct Consumer {
+    uint32_t received;
+    uint32_t nextSequence;
+    uint32_t gaps;
+    uint32_t missing;
+    uint32_t badSamples;
+
+    Consumer() : received(0), nextSequence(0), gaps(0), missing(0), badSamples(0) {}
+
+    void take(const ImuSample& s) {
+        uint32_t seq = (uint16_t)s.gyro[0];
+        // The ramp wraps at 16 bits in gyro X; the timestamp carries the full count
+        uint32_t fromTime = s.timestampUs / CHECK_PERIOD_US - 1;
+        if ((fromTime & 0xFFFF) != seq || s.accel[2] != (int16_t)(fromTime * 3 + 2 + 16393)) badSamples++;
+        if (fromTime != nextSequence) {
+            if (fromTime < nextSequence) {
+                badSamples++;
+            } else {
+                gaps++;
+                missing += fromTime - nextSequence;
+            }
+        }
+        nextSequence = fromTime + 1;
+        received++;
+    }
+
+    void drainAll(ImuAcquisition& acquisition) {
+        ImuSample out[CHECK_DRAIN_MAX];
+        uint16_t n;
+        while ((n = acquisition.drain(out, CHECK_DRAIN_MAX)) > 0) {
+            for (uint16_t i = 0; i < n; i++) take(out[i]);
+        }
+    }
+};
+
+// Advance the simulated clock in small steps, servicing interrupts as the
+// acquisition thread would and draining every drainEveryUs (0 = never)
+static void run(SimulatedImuInterrupt& sim, ImuAcquisition& acquisition, Consumer& consumer,
+                uint32_t durationUs, uint32_t drainEveryUs) {
+    uint32_t sinceDrain = 0;
+    for (uint32_t t = 0; t < durationUs; t += 1000) {
+        sim.advance(1000);
+        if (acquisition.hasPendingInterrupt()) acquisition.service();
+        sinceDrain += 1000;
+        if (drainEveryUs && sinceDrain >= drainEveryUs) {
+            consumer.drainAll(acquisition);
+            sinceDrain = 0;
+        }
+    }
+}
+
+static void steady() {
+    ImuAcquisition acquisition;
+    SimulatedImuInterrupt sim(acquisition, CHECK_PERIOD_US, CHECK_WATERMARK);
+    Consumer consumer;
+    run(sim, acquisition, consumer, 60000000, 1000000);
+    consumer.drainAll(acquisition);
+
+    uint32_t produced = sim.nowUs() / (CHECK_PERIOD_US * CHECK_WATERMARK) * CHECK_WATERMARK;
+    expect("steady", "samples received", produced, consumer.received);
+    expect("steady", "gaps", 0, consumer.gaps);
+    expect("steady", "bad samples", 0, consumer.badSamples);
+    expect("steady", "ring drops", 0, acquisition.getDroppedSamples());
+    expect("steady", "overrun reported", 0, acquisition.takeOverrun());
+}
+
+static void stall() {
+    ImuAcquisition acquisition;
+    SimulatedImuInterrupt sim(acquisition, CHECK_PERIOD_US, CHECK_WATERMARK);
+    Consumer consumer;
+    run(sim, acquisition, consumer, 2000000, 500000);
+    consumer.drainAll(acquisition);
+    expect("stall", "overrun before stall", 0, acquisition.takeOverrun());
+
+    // loop() blocked on an upload for 8 s: the ring holds ~5 s, the rest is dropped
+    run(sim, acquisition, consumer, 8000000, 0);
+    expect("stall", "ring full", IMU_RING_CAPACITY, acquisition.available());
+    expect("stall", "drops counted", 1, acquisition.getDroppedSamples() > 0);
+    expect("stall", "overrun reported", 1, acquisition.takeOverrun());
+    expect("stall", "overrun reported once", 0, acquisition.takeOverrun());
+
+    // The ring keeps the oldest samples, so the loss shows as one gap of exactly the drop count
+    run(sim, acquisition, consumer, 2000000, 500000);
+    consumer.drainAll(acquisition);
+    uint32_t dropped = acquisition.getDroppedSamples();
+    expect("stall", "gaps", 1, consumer.gaps);
+    expect("stall", "missing == dropped", dropped, consumer.missing);
+    expect("stall", "received + dropped", consumer.nextSequence, consumer.received + dropped);
+    expect("stall", "bad samples", 0, consumer.badSamples);
+
+    acquisition.noteSourceOverrun();
+    expect("stall", "FIFO overrun reported", 1, acquisition.takeOverrun());
+}
+
+// The producer runs on its own thread, the consumer drains as fast as it can: every
+// sample is either delivered in order or counted as dropped
+static void threaded() {
+    ImuAcquisition acquisition;
+    SimulatedImuInterrupt sim(acquisition, CHECK_PERIOD_US, 1);
+    Consumer consumer;
+    std::atomic<bool> done(false);
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < 200000; i++) {
+            sim.advance(CHECK_PERIOD_US);
+            if (acquisition.hasPendingInterrupt()) acquisition.service();
+            if (i % 16 == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+    while (!done.load(std::memory_order_acquire)) consumer.drainAll(acquisition);
+    producer.join();
+    consumer.drainAll(acquisition);
+
+    expect("threaded", "received + dropped", 200000, consumer.received + acquisition.getDroppedSamples());
+    // Drops at the very end leave no gap behind them, only a short tail
+    expect("threaded", "missing == dropped", acquisition.getDroppedSamples(),
+           consumer.missing + (200000 - consumer.nextSequence));
+    expect("threaded", "bad samples", 0, consumer.badSamples);
+}
+
+int main() {
+    steady();
+    stall();
+    threaded();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,255 @@
+/*
+ * Equivalence check and host benchmark for the DspKernels.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Ilib/SensorPipeline/src tools/bench/dsp_bench.cpp \
+ *       lib/SensorPipeline/src/DspKernels.cpp -o dsp_bench && ./dsp_bench
+ *
+ * First checks each packed primitive (SMLALD, SMUAD, QADD16, PKHBT, SSAT) against
+ * plain integer arithmetic on random and rail operands, then runs every kernel over
+ * random, full-scale and saturating signals in random
+ * block lengths and compares the output bit for bit with the scalar versions in
+ * DspReference.h; any difference is printed and the exit status is 1. Then reports
+ * host ns/sample for kernel and reference. On the host the kernels run on the portable
+ * emulation of SMLALD/SMUAD/QADD16/PKHBT/SSAT, which is what makes the comparison
+ * stand in for the device path; the timings compare changes, not device cycles.
+ * Built for the board (DSP_USE_SIMD=1), the same primitive and kernel checks run
+ * the instructions themselves.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include "DspKernels.h"
+#include "DspReference.h"
+
+#define CHECK_SAMPLES 4096
+#define CHECK_ROUNDS 20
+#define BENCH_SAMPLES 512
+#define BENCH_ITERATIONS 4000
+
+#define FIR_TAPS 31
+#define FIR_FACTOR 4
+#define FIR_MAX_BLOCK 64
+#define BIQUAD_STAGES 2
+#define MOVING_LENGTH 26
+
+static uint32_t rng = 12345;
+
+static uint32_t nextRandom() {
+    rng = rng * 1664525u + 1013904223u;
+    return rng;
+}
+
+// Signal kinds: uniform full range, a loud tone with noise, and mostly rails
+static void fillSignal(int16_t* x, uint32_t n, int kind) {
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t r = (int32_t)(nextRandom() >> 16) - 32768;
+        if (kind == 0) {
+            x[i] = (int16_t)r;
+        } else if (kind == 1) {
+            x[i] = dspSat16((int32_t)(30000.0f * sinf(0.07f * i)) + r / 16);
+        } else {
+            x[i] = (r & 4) ? (r & 1 ? 32767 : -32768) : (int16_t)r;
+        }
+    }
+}
+
+static int failures = 0;
+
+static void expect(const char* kernel, int kind, bool same) {
+    if (!same) {
+        printf("MISMATCH %s on signal %d\n", kernel, kind);
+        failures++;
+    }
+}
+
+template <typename T>
+static bool sameArrays(const T* a, const T* b, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+// Block lengths the way the acquisition loop delivers them: uneven, sometimes empty
+static uint16_t nextBlock(uint32_t remaining, uint16_t maxBlock, uint8_t multiple) {
+    uint32_t n = (nextRandom() >> 8) % (maxBlock / multiple + 1) * multiple;
+    return (uint16_t)(n > remaining ? remaining - remaining % multiple : n);
+}
+
+// Operands for the primitive checks: mostly random, often at or next to the rails
+static int16_t nextOperand() {
+    static const int16_t rails[] = { -32768, -32767, -1, 0, 1, 32766, 32767 };
+    uint32_t r = nextRandom();
+    return (r & 3) ? (int16_t)(r >> 16) : rails[(r >> 8) % (sizeof(rails) / sizeof(rails[0]))];
+}
+
+// Each primitive against the arithmetic it stands for, computed in wide integers
+static void checkPrimitives() {
+    bool smlald = true, smuad = true, qadd16 = true, pack = true, ssat = true;
+    for (uint32_t i = 0; i < CHECK_SAMPLES * CHECK_ROUNDS; i++) {
+        int16_t x0 = nextOperand(), x1 = nextOperand(), y0 = nextOperand(), y1 = nextOperand();
+        uint32_t x = dspPack(x0, x1), y = dspPack(y0, y1);
+        pack &= dspLo(x) == x0 && dspHi(x) == x1;
+
+        int64_t acc = ((int64_t)(int32_t)nextRandom() << 16) ^ nextRandom();
+        int64_t products = (int64_t)x0 * y0 + (int64_t)x1 * y1;
+        smlald &= dspSmlald(x, y, acc) == acc + products;
+        smuad &= dspSmuad(x, y) == (uint32_t)products;
+
+        uint32_t sum = dspQadd16(x, y);
+        qadd16 &= dspLo(sum) == dspSat16((int32_t)x0 + y0) && dspHi(sum) == dspSat16((int32_t)x1 + y1);
+
+        int32_t wide = (int32_t)nextRandom() >> (nextRandom() & 15);
+        ssat &= dspSsat16(wide) == (wide > 32767 ? 32767 : (wide < -32768 ? -32768 : wide));
+    }
+    expect("dspSmlald", 0, smlald);
+    expect("dspSmuad", 0, smuad);
+    expect("dspQadd16", 0, qadd16);
+    expect("dspPack", 0, pack);
+    expect("dspSsat16", 0, ssat);
+}
+
+static void checkEquivalence() {
+    static int16_t a[CHECK_SAMPLES], b[CHECK_SAMPLES], c[CHECK_SAMPLES];
+    static int16_t out[CHECK_SAMPLES], ref[CHECK_SAMPLES];
+    static int32_t sums[CHECK_SAMPLES], refSums[CHECK_SAMPLES];
+
+    // Filters designed the way the firmware would, plus one with every coefficient at
+    // the rails so the accumulators and the output saturation are exercised
+    int16_t firCoeffs[FIR_TAPS], firRails[FIR_TAPS];
+    dspDesignLowpassFir(10.0f, 104.0f, FIR_TAPS, firCoeffs);
+    for (uint16_t i = 0; i < FIR_TAPS; i++) firRails[i] = i & 1 ? -32768 : 32767;
+    int16_t biquadCoeffs[BIQUAD_STAGES * DSP_BIQUAD_COEFFS];
+    uint8_t postShift = dspDesignLowpassBiquad(5.0f, 104.0f, 0.7071f, biquadCoeffs);
+    dspDesignLowpassBiquad(5.0f, 104.0f, 1.3f, biquadCoeffs + DSP_BIQUAD_COEFFS);
+
+    for (int round = 0; round < CHECK_ROUNDS; round++) {
+        int kind = round % 3;
+        fillSignal(a, CHECK_SAMPLES, kind);
+        fillSignal(b, CHECK_SAMPLES, (kind + 1) % 3);
+        fillSignal(c, CHECK_SAMPLES, (kind + 2) % 3);
+        uint16_t n = (uint16_t)(CHECK_SAMPLES - (nextRandom() >> 8) % 8);   // odd tails too
+
+        expect("dspDotQ15", kind, dspDotQ15(a, b, n) == dspRefDotQ15(a, b, n));
+
+        dspAddQ15(a, b, out, n);
+        dspRefAddQ15(a, b, ref, n);
+        expect("dspAddQ15", kind, sameArrays(out, ref, n));
+
+        dspMagnitude3Q15(a, b, c, out, n);
+        dspRefMagnitude3Q15(a, b, c, ref, n);
+        expect("dspMagnitude3Q15", kind, sameArrays(out, ref, n));
+
+        int16_t movingBuffer[MOVING_LENGTH];
+        DspMovingSumQ15 moving;
+        dspMovingSumInit(moving, movingBuffer, MOVING_LENGTH);
+        for (uint32_t done = 0; done < n;) {
+            uint16_t block = nextBlock(n - done, FIR_MAX_BLOCK, 1);
+            dspMovingSumQ15(moving, a + done, sums + done, block);
+            done += block;
+        }
+        dspRefMovingSumQ15(a, n, MOVING_LENGTH, refSums);
+        expect("dspMovingSumQ15", kind, sameArrays(sums, refSums, n));
+
+        int16_t biquadState[BIQUAD_STAGES * DSP_BIQUAD_STATE];
+        DspBiquadQ15 biquad;
+        dspBiquadInit(biquad, BIQUAD_STAGES, biquadCoeffs, biquadState, postShift);
+        for (uint32_t done = 0; done < n;) {
+            uint16_t block = nextBlock(n - done, FIR_MAX_BLOCK, 1);
+            dspBiquadQ15(biquad, a + done, out + done, block);
+            done += block;
+        }
+        dspRefBiquadQ15(biquadCoeffs, BIQUAD_STAGES, postShift, a, ref, n);
+        expect("dspBiquadQ15", kind, sameArrays(out, ref, n));
+
+        for (int rails = 0; rails < 2; rails++) {
+            const int16_t* taps = rails ? firRails : firCoeffs;
+            int16_t firState[FIR_TAPS - 1 + FIR_MAX_BLOCK];
+            DspFirDecimatorQ15 fir;
+            dspFirDecimateInit(fir, FIR_TAPS, FIR_FACTOR, taps, firState, FIR_MAX_BLOCK);
+            uint32_t usable = n - n % FIR_FACTOR, produced = 0;
+            for (uint32_t done = 0; done < usable;) {
+                uint16_t block = nextBlock(usable - done, FIR_MAX_BLOCK, FIR_FACTOR);
+                produced += dspFirDecimateQ15(fir, a + done, out + produced, block);
+                done += block;
+            }
+            uint32_t expected = dspRefFirDecimateQ15(taps, FIR_TAPS, FIR_FACTOR, a, ref, usable);
+            expect(rails ? "dspFirDecimateQ15 (rails)" : "dspFirDecimateQ15", kind,
+                   produced == expected && sameArrays(out, ref, produced));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Timing
+// ---------------------------------------------------------------------------
+
+static volatile int64_t sink;
+
+template <typename F>
+static double nsPerSample(F body) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) body();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+    return ns / ((double)BENCH_ITERATIONS * BENCH_SAMPLES);
+}
+
+static void report(const char* name, double kernel, double reference) {
+    printf("%-20s %7.2f ns/sample   reference %7.2f ns/sample\n", name, kernel, reference);
+}
+
+static void benchmark() {
+    static int16_t a[BENCH_SAMPLES], b[BENCH_SAMPLES], c[BENCH_SAMPLES], out[BENCH_SAMPLES];
+    static int32_t sums[BENCH_SAMPLES];
+    fillSignal(a, BENCH_SAMPLES, 1);
+    fillSignal(b, BENCH_SAMPLES, 0);
+    fillSignal(c, BENCH_SAMPLES, 0);
+
+    report("dot", nsPerSample([&] { sink = dspDotQ15(a, b, BENCH_SAMPLES); }),
+           nsPerSample([&] { sink = dspRefDotQ15(a, b, BENCH_SAMPLES); }));
+    report("add", nsPerSample([&] { dspAddQ15(a, b, out, BENCH_SAMPLES); sink = out[7]; }),
+           nsPerSample([&] { dspRefAddQ15(a, b, out, BENCH_SAMPLES); sink = out[7]; }));
+    report("magnitude3", nsPerSample([&] { dspMagnitude3Q15(a, b, c, out, BENCH_SAMPLES); sink = out[7]; }),
+           nsPerSample([&] { dspRefMagnitude3Q15(a, b, c, out, BENCH_SAMPLES); sink = out[7]; }));
+
+    int16_t movingBuffer[MOVING_LENGTH];
+    DspMovingSumQ15 moving;
+    dspMovingSumInit(moving, movingBuffer, MOVING_LENGTH);
+    report("moving sum", nsPerSample([&] { dspMovingSumQ15(moving, a, sums, BENCH_SAMPLES); sink = sums[7]; }),
+           nsPerSample([&] { dspRefMovingSumQ15(a, BENCH_SAMPLES, MOVING_LENGTH, sums); sink = sums[7]; }));
+
+    int16_t biquadCoeffs[BIQUAD_STAGES * DSP_BIQUAD_COEFFS], biquadState[BIQUAD_STAGES * DSP_BIQUAD_STATE];
+    uint8_t postShift = dspDesignLowpassBiquad(5.0f, 104.0f, 0.7071f, biquadCoeffs);
+    dspDesignLowpassBiquad(5.0f, 104.0f, 1.3f, biquadCoeffs + DSP_BIQUAD_COEFFS);
+    DspBiquadQ15 biquad;
+    dspBiquadInit(biquad, BIQUAD_STAGES, biquadCoeffs, biquadState, postShift);
+    report("biquad x2", nsPerSample([&] { dspBiquadQ15(biquad, a, out, BENCH_SAMPLES); sink = out[7]; }),
+           nsPerSample([&] { dspRefBiquadQ15(biquadCoeffs, BIQUAD_STAGES, postShift, a, out, BENCH_SAMPLES);
+                             sink = out[7]; }));
+
+    int16_t firCoeffs[FIR_TAPS], firState[FIR_TAPS - 1 + FIR_MAX_BLOCK];
+    dspDesignLowpassFir(10.0f, 104.0f, FIR_TAPS, firCoeffs);
+    DspFirDecimatorQ15 fir;
+    dspFirDecimateInit(fir, FIR_TAPS, FIR_FACTOR, firCoeffs, firState, FIR_MAX_BLOCK);
+    report("fir 31 tap /4", nsPerSample([&] {
+               for (uint16_t i = 0; i < BENCH_SAMPLES; i += FIR_MAX_BLOCK) {
+                   dspFirDecimateQ15(fir, a + i, out + i / FIR_FACTOR, FIR_MAX_BLOCK);
+               }
+               sink = out[7];
+           }),
+           nsPerSample([&] { dspRefFirDecimateQ15(firCoeffs, FIR_TAPS, FIR_FACTOR, a, out, BENCH_SAMPLES);
+                             sink = out[7]; }));
+}
+
+int main() {
+    checkPrimitives();
+    checkEquivalence();
+    printf("Equivalence: 5 primitives, %d rounds x 6 kernels, %s\n", CHECK_ROUNDS,
+           failures ? "FAILED" : "bit-exact");
+    benchmark();
+    printf("Path: %s\n", DSP_USE_SIMD ? "Cortex-M DSP intrinsics" : "portable C (intrinsic emulation)");
+    return failures ? 1 : 0;
+}
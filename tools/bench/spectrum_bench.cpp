@@ -0,0 +1,90 @@
+/*
+ * Host benchmark for the microphone block path (SoundLevelMeter + SpectrumAnalyzer).
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Ilib/SensorPipeline/src tools/bench/spectrum_bench.cpp \
+ *       lib/SensorPipeline/src/SpectrumAnalyzer.cpp lib/SensorPipeline/src/SoundLevel.cpp \
+ *       -o spectrum_bench && ./spectrum_bench
+ *
+ * Reports host time and (on x86) TSC cycles per block. Host numbers come from the
+ * portable C butterflies; use them to compare changes, not as device cycle counts.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+#include "MicCapture.h"
+#include "SoundLevel.h"
+#include "SpectrumAnalyzer.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+#define BENCH_BLOCKS 20000
+#define BENCH_VARIANTS 64
+
+static uint64_t cycles() {
+#if BENCH_HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+int main() {
+    // A voice-like tone pair over noise, pre-generated so synthesis isn't timed
+    static uint16_t blocks[BENCH_VARIANTS][SPECTRUM_FFT_SIZE];
+    uint32_t noise = 12345;
+    for (uint32_t b = 0; b < BENCH_VARIANTS; b++) {
+        for (uint32_t i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+            uint32_t n = b * SPECTRUM_FFT_SIZE + i;
+            noise = noise * 1664525u + 1013904223u;
+            float v = 2048.0f + 300.0f * sinf(6.2831853f * 220.0f * n / MIC_SAMPLE_RATE_HZ)
+                    + 120.0f * sinf(6.2831853f * 1800.0f * n / MIC_SAMPLE_RATE_HZ)
+                    + (float)((int32_t)(noise >> 22) - 512) * 0.1f;
+            blocks[b][i] = (uint16_t)v;
+        }
+    }
+
+    SoundLevelMeter meter;
+    meter.begin(MIC_SAMPLE_RATE_HZ, 12, 20, 125, 1000);
+    SpectrumAnalyzer spectrum;
+    spectrum.begin(MIC_SAMPLE_RATE_HZ, 0);
+
+    const char* names[2] = {"SoundLevelMeter::process", "SpectrumAnalyzer::process"};
+    for (int stage = 0; stage < 2; stage++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        uint64_t c0 = cycles();
+        for (uint32_t i = 0; i < BENCH_BLOCKS; i++) {
+            const uint16_t* block = blocks[i % BENCH_VARIANTS];
+            if (stage == 0) {
+                meter.process(block, SPECTRUM_FFT_SIZE);
+            } else {
+                spectrum.process(block, SPECTRUM_FFT_SIZE);
+            }
+        }
+        uint64_t c1 = cycles();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+
+        printf("%-26s %8.0f ns/block", names[stage], ns / BENCH_BLOCKS);
+        if (BENCH_HAVE_TSC) printf("  %8.0f cycles/block", (double)(c1 - c0) / BENCH_BLOCKS);
+        printf("\n");
+    }
+
+    double blockMs = 1000.0 * SPECTRUM_FFT_SIZE / MIC_SAMPLE_RATE_HZ;
+    printf("Block length %.1f ms (%d samples at %d Hz)\n", blockMs, SPECTRUM_FFT_SIZE, MIC_SAMPLE_RATE_HZ);
+
+    SpectrumFeatures f;
+    if (spectrum.getFeatures(f)) {
+        printf("Bands (dBFS):");
+        for (int b = 0; b < SPECTRUM_BANDS; b++) printf(" %d", f.bandDb[b]);
+        printf("\nCentroid %u Hz, flatness %.3f, level %.1f dBFS\n",
+               f.centroidHz, f.flatnessQ15 / 32767.0f, meter.getLeqDbQ8() / 256.0f);
+    }
+    return 0;
+}
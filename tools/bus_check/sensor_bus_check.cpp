@@ -0,0 +1,227 @@
+/*
+ * Host check for the sensor bus: SensorBus over I2CAsyncEngine over MockI2CBackend.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Ilib/SensorBus/src tools/bus_check/sensor_bus_check.cpp \
+ *       lib/SensorBus/src/SensorBus.cpp lib/SensorBus/src/I2CAsyncEngine.cpp \
+ *       lib/SensorBus/src/I2CBackends.cpp -o sensor_bus_check && ./sensor_bus_check
+ *
+ * The mock holds a register file per device and applies each transfer the way the
+ * parts do, including the two auto-increment conventions (HTS221 needs the sub-address
+ * MSB, LSM6DS3 increments on its own). The firmware's plans from SensorRegisters.h are
+ * run through the same engine it uses: blocking reads and writes, queued reads with
+ * deferred completion standing in for the transfer-complete interrupt, a full queue, a
+ * device that does not answer, a transfer whose completion never comes (the engine's
+ * deadline must abort it) and the traffic counters. Each check prints expected vs got;
+ * any mismatch exits with status 1.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "SensorBus.h"
+#include "I2CAsyncEngine.h"
+#include "I2CBackends.h"
+#include "SensorRegisters.h"
+
+#define CHECK_ABSENT_ADDR 0x1E        // LIS2MDL address, registered on the bus but not fitted
+
+static int failures = 0;
+
+static void expect(const char* scenario, const char* what, uint32_t expected, uint32_t got) {
+    printf("%-9s %-30s expected %-6u got %-6u %s\n", scenario, what, expected, got,
+           expected == got ? "ok" : "MISMATCH");
+    if (expected != got) failures++;
+}
+
+// Bus assembled the way setup() does it
+struct Rig {
+    MockI2CBackend mock;
+    I2CAsyncEngine engine;
+    SensorBus bus;
+
+    Rig() {
+        mock.addDevice(HTS221Map::i2cAddress, HTS221Map::autoIncrementFlag);
+        mock.addDevice(LSM6DS3Map::i2cAddress, LSM6DS3Map::autoIncrementFlag);
+        engine.begin(&mock);
+        bus.begin(&engine);
+        bus.attachEngine(&engine);
+        bus.registerDevice(HTS221Map::i2cAddress, "HTS221", HTS221Map::autoIncrementFlag);
+        bus.registerDevice(LSM6DS3Map::i2cAddress, "LSM6DS3", LSM6DS3Map::autoIncrementFlag);
+        bus.registerDevice(CHECK_ABSENT_ADDR, "LIS2MDL", 0x00);
+
+        // Distinct value in every register so a wrong pointer shows
+        for (uint16_t r = 0; r < 256; r++) {
+            mock.setRegister(HTS221Map::i2cAddress, (uint8_t)r, (uint8_t)(r ^ 0x5A));
+            mock.setRegister(LSM6DS3Map::i2cAddress, (uint8_t)r, (uint8_t)(r ^ 0xA5));
+        }
+    }
+};
+
+// Bytes of a burst that hold the register they should (the rig's pattern)
+static uint32_t countMatching(const uint8_t* data, uint8_t startReg, uint8_t length, uint8_t pattern) {
+    uint32_t same = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        if (data[i] == (uint8_t)((startReg + i) ^ pattern)) same++;
+    }
+    return same;
+}
+
+static void blocking() {
+    Rig rig;
+    uint8_t data[SENSOR_BUS_MAX_BURST];
+
+    // Burst reads: one transaction each, register pointer advancing on both conventions
+    BusReadPlan hts = HTS221Map::SampleRead::plan(HTS221Map::i2cAddress);
+    expect("blocking", "HTS221 burst ok", 1, rig.bus.execute(hts, data));
+    expect("blocking", "HTS221 burst bytes", hts.length, countMatching(data, hts.startReg, hts.length, 0x5A));
+    BusReadPlan imu = LSM6DS3Map::SampleRead::plan(LSM6DS3Map::i2cAddress);
+    expect("blocking", "LSM6DS3 burst ok", 1, rig.bus.execute(imu, data));
+    expect("blocking", "LSM6DS3 burst bytes", imu.length, countMatching(data, imu.startReg, imu.length, 0xA5));
+    expect("blocking", "HTS221 WHO_AM_I", 0x0F ^ 0x5A, rig.bus.readRegister(HTS221Map::i2cAddress, 0x0F));
+
+    expect("blocking", "write lands", 1, rig.bus.writeRegister(HTS221Map::i2cAddress, 0x20, 0x81));
+    expect("blocking", "register value", 0x81, rig.mock.getRegister(HTS221Map::i2cAddress, 0x20));
+
+    expect("blocking", "probe present", 1, rig.bus.probe(LSM6DS3Map::i2cAddress, 0x0F));
+    expect("blocking", "probe absent", 0, rig.bus.probe(CHECK_ABSENT_ADDR, 0x0F));
+    expect("blocking", "absent read fails", 0, rig.bus.readRegisters(CHECK_ABSENT_ADDR, 0x68, data, 6));
+
+    // Counters: HTS221 saw a burst, a single read and a write; the absent device one error
+    const BusStats* s = rig.bus.getStats(HTS221Map::i2cAddress);
+    expect("blocking", "HTS221 transactions", 3, s->transactions);
+    expect("blocking", "HTS221 bytes read", hts.length + 1u, s->bytesRead);
+    expect("blocking", "HTS221 bytes written", 1 + 1 + 2, s->bytesWritten);
+    expect("blocking", "HTS221 errors", 0, s->errors);
+    expect("blocking", "absent errors", 1, rig.bus.getStats(CHECK_ABSENT_ADDR)->errors);
+    expect("blocking", "engine idle", 1, rig.engine.isIdle());
+}
+
+struct CallbackLog {
+    uint8_t order[I2C_ENGINE_QUEUE_DEPTH + 2];
+    uint8_t count;
+};
+
+static void logCompletion(void* ctx, I2CRequest* request) {
+    CallbackLog* log = static_cast<CallbackLog*>(ctx);
+    log->order[log->count++] = request->address;
+}
+
+// Queued reads stay in flight until the "interrupt" fires, complete in submission
+// order, and a read that fails in flight is counted against its device
+static void deferred() {
+    Rig rig;
+    rig.mock.setDeferredCompletion(true);
+    CallbackLog log = {{0}, 0};
+
+    BusAsyncRead hts, imu, absent;
+    BusReadPlan htsPlan = HTS221Map::SampleRead::plan(HTS221Map::i2cAddress);
+    BusReadPlan imuPlan = LSM6DS3Map::SampleRead::plan(LSM6DS3Map::i2cAddress);
+    BusReadPlan absentPlan = {CHECK_ABSENT_ADDR, 0x68, 6};
+    expect("deferred", "submit HTS221", 1, rig.bus.submit(htsPlan, hts, logCompletion, &log));
+    expect("deferred", "submit LSM6DS3", 1, rig.bus.submit(imuPlan, imu, logCompletion, &log));
+    expect("deferred", "submit absent", 1, rig.bus.submit(absentPlan, absent, logCompletion, &log));
+    expect("deferred", "resubmit while busy", 0, rig.bus.submit(htsPlan, hts));
+
+    expect("deferred", "in flight before interrupt", 1, hts.isBusy());
+    expect("deferred", "queued behind it", 2, rig.engine.getQueuedCount());
+    expect("deferred", "no transfer yet", 0, rig.mock.getTransferCount());
+
+    rig.mock.completePending();
+    expect("deferred", "first done", 1, hts.isDone());
+    expect("deferred", "second started", 1, imu.isBusy());
+    rig.mock.completePending();
+    rig.mock.completePending();
+    expect("deferred", "HTS221 bytes", htsPlan.length,
+           countMatching(hts.data, htsPlan.startReg, htsPlan.length, 0x5A));
+    expect("deferred", "LSM6DS3 bytes", imuPlan.length,
+           countMatching(imu.data, imuPlan.startReg, imuPlan.length, 0xA5));
+    expect("deferred", "absent failed", I2C_REQUEST_FAILED, absent.request.state);
+    expect("deferred", "callbacks", 3, log.count);
+    expect("deferred", "callback order", 1, log.order[0] == HTS221Map::i2cAddress &&
+                                            log.order[1] == LSM6DS3Map::i2cAddress &&
+                                            log.order[2] == CHECK_ABSENT_ADDR);
+    expect("deferred", "async error counted", 1, rig.bus.getStats(CHECK_ABSENT_ADDR)->errors);
+    expect("deferred", "engine completed", 2, rig.engine.getCompletedCount());
+    expect("deferred", "engine failed", 1, rig.engine.getFailedCount());
+
+    // A blocking call while deferred: wait() polls the backend until it finishes
+    expect("deferred", "blocking read through wait", 0x0F ^ 0xA5,
+           rig.bus.readRegister(LSM6DS3Map::i2cAddress, 0x0F));
+
+    hts.release();
+    expect("deferred", "released", I2C_REQUEST_IDLE, hts.request.state);
+}
+
+// More reads than the engine queue holds: the extra ones are refused, not lost in flight
+static void overflow() {
+    Rig rig;
+    rig.mock.setDeferredCompletion(true);
+    BusAsyncRead reads[I2C_ENGINE_QUEUE_DEPTH + 2];
+    BusReadPlan plan = LSM6DS3Map::SampleRead::plan(LSM6DS3Map::i2cAddress);
+
+    uint32_t accepted = 0;
+    for (uint8_t i = 0; i < I2C_ENGINE_QUEUE_DEPTH + 2; i++) {
+        if (rig.bus.submit(plan, reads[i])) accepted++;
+    }
+    // One in flight plus a full queue
+    expect("overflow", "accepted", I2C_ENGINE_QUEUE_DEPTH + 1, accepted);
+    expect("overflow", "rejected", 1, rig.engine.getRejectedCount());
+    while (rig.mock.completePending()) {}
+    expect("overflow", "all accepted completed", accepted, rig.engine.getCompletedCount());
+    expect("overflow", "engine idle", 1, rig.engine.isIdle());
+}
+
+// Simulated clock for the engine's deadline: every sleep advances it by the time asked
+// for, as a semaphore wait that no interrupt releases would take
+struct ClockWaiter : public I2CWaiter {
+    uint32_t now;
+    uint32_t sleeps;
+    uint32_t wakes;
+
+    ClockWaiter() : now(0), sleeps(0), wakes(0) {}
+    uint32_t nowMs() override { return now; }
+    void sleep(uint32_t maxMs) override { now += maxMs; sleeps++; }
+    void wake() override { wakes++; }
+};
+
+// The completion never arrives: the blocking read must fail after the timeout instead
+// of hanging, and the bus must work again once the device answers
+static void stalled() {
+    Rig rig;
+    ClockWaiter waiter;
+    rig.engine.setWaiter(&waiter, 25);
+    uint8_t data[SENSOR_BUS_MAX_BURST];
+
+    rig.mock.setStalled(true);
+    BusReadPlan imu = LSM6DS3Map::SampleRead::plan(LSM6DS3Map::i2cAddress);
+    expect("stalled", "read fails", 0, rig.bus.execute(imu, data));
+    expect("stalled", "gave up at the deadline", 25, waiter.now);
+    expect("stalled", "slept, not spun", 1, waiter.sleeps);
+    expect("stalled", "timeouts", 1, rig.engine.getTimeoutCount());
+    expect("stalled", "engine idle", 1, rig.engine.isIdle());
+    expect("stalled", "error counted", 1, rig.bus.getStats(LSM6DS3Map::i2cAddress)->errors);
+
+    // Two queued reads behind a stuck one: waitIdle() aborts each in turn
+    BusAsyncRead a, b;
+    rig.bus.submit(imu, a);
+    rig.bus.submit(imu, b);
+    rig.engine.waitIdle();
+    expect("stalled", "queue drained by deadlines", 1, rig.engine.isIdle());
+    expect("stalled", "both failed", 1, !a.isDone() && !b.isDone());
+    expect("stalled", "timeouts", 3, rig.engine.getTimeoutCount());
+
+    rig.mock.setStalled(false);
+    rig.mock.setDeferredCompletion(true);
+    uint32_t before = waiter.now;
+    expect("stalled", "recovered read", 1, rig.bus.execute(imu, data));
+    expect("stalled", "no deadline hit", before, waiter.now);
+    expect("stalled", "burst bytes", imu.length, countMatching(data, imu.startReg, imu.length, 0xA5));
+}
+
+int main() {
+    blocking();
+    deferred();
+    overflow();
+    stalled();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,294 @@
+/*
+ * Host replay harness for FallDetector.
+ *
+ * Build from the repository root:
+ *   g++ -std=gnu++11 -O2 -Ilib/SensorPipeline/src tools/fall_replay/fall_replay.cpp \
+ *       lib/SensorPipeline/src/FallDetector.cpp -o fall_replay
+ *
+ *   ./fall_replay                 synthetic scenarios, then every trace in traces/, expected vs got
+ *   ./fall_replay trace.csv ...   the given traces only
+ *   ./fall_replay --write DIR     render the scenarios as traces into DIR
+ *
+ * Trace format: one sample per line, "t_us,ax,ay,az,gx,gy,gz" with acceleration in m/s²
+ * and angular rate in degrees/s (what LSM6DS3_Direct reports); an optional eighth column
+ * is the barometric height change in metres. Samples are clipped to the full scale the
+ * firmware programs (±8 g, ±245 dps), as the sensor would. Lines starting with '#' are comments; a
+ * "# expect: fall" or "# expect: no fall" line gives the verdict the trace must get.
+ * Any wrong verdict exits with status 1. Run from the repository root so traces/ is found.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include "FallDetector.h"
+
+#define REPLAY_RATE_HZ 104.0f
+#define REPLAY_G 9.80665f
+#define REPLAY_TRACE_DIR "tools/fall_replay/traces"
+#define REPLAY_TRACE_JITTER_US 150    // Timestamp jitter in rendered traces (interrupt latency)
+#define REPLAY_ACCEL_FS_G 8.0f        // Ranges the firmware programs while the fall detector runs
+#define REPLAY_GYRO_FS_DPS 245.0f     // (IMU_FALL_ACCEL_FS_CODE, LSM6DS3_GYRO_FS_CODE)
+
+static void report(const char* name, const FallEvent& e) {
+    printf("  %s: fall at %.2fs, confidence %.2f, impact %.2fg (z %.1f), free fall %ums, "
+           "angle %.0f deg, still %s, height drop %.2fm\n",
+           name, e.timestampUs / 1e6, e.confidence, e.impactG, e.impactZ, e.freeFallMs,
+           e.angleChangeDeg, e.still ? "yes" : "no", e.heightDropM);
+}
+
+static float clip(float v, float range) {
+    return v > range ? range : (v < -range ? -range : v);
+}
+
+// What the LSM6DS3 can report: every axis saturates at the programmed full scale
+static void saturate(float a[3], float g[3]) {
+    for (uint8_t k = 0; k < 3; k++) {
+        a[k] = clip(a[k], REPLAY_ACCEL_FS_G * REPLAY_G);
+        g[k] = clip(g[k], REPLAY_GYRO_FS_DPS);
+    }
+}
+
+static void verdict(const char* name, bool expectFall, bool gotFall, int& failures) {
+    printf("%-34s expected %-7s got %-7s %s\n", name, expectFall ? "fall" : "no fall",
+           gotFall ? "fall" : "no fall", gotFall == expectFall ? "ok" : "MISMATCH");
+    if (gotFall != expectFall) failures++;
+}
+
+static void replayFile(const char* path, int& failures) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        printf("%s: cannot open\n", path);
+        failures++;
+        return;
+    }
+    FallDetector detector;
+    char line[256];
+    int expect = -1;                  // -1 = no "# expect:" line
+    FallEvent first;
+    bool gotFall = false;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#') {
+            if (strncmp(line, "# expect: no fall", 17) == 0) expect = 0;
+            else if (strncmp(line, "# expect: fall", 14) == 0) expect = 1;
+            continue;
+        }
+        double t;
+        float a[3], g[3], h;
+        int n = sscanf(line, "%lf,%f,%f,%f,%f,%f,%f,%f", &t, &a[0], &a[1], &a[2], &g[0], &g[1], &g[2], &h);
+        if (n < 7) continue;
+        saturate(a, g);
+        if (n == 8) detector.setHeight(h);
+        detector.addSample(a, g, (uint32_t)t);
+        FallEvent e;
+        if (detector.poll(e) && !gotFall) {
+            first = e;
+            gotFall = true;
+        }
+    }
+    fclose(f);
+    if (expect < 0) {
+        printf("%-34s (no expectation) got %s\n", path, gotFall ? "fall" : "no fall");
+    } else {
+        verdict(path, expect == 1, gotFall, failures);
+    }
+    if (gotFall) report(path, first);
+}
+
+static void replayDirectory(const char* dir, int& failures) {
+    DIR* d = opendir(dir);
+    if (!d) {
+        printf("%s: no traces\n", dir);
+        return;
+    }
+    // Sorted so the output is stable
+    char names[64][128];
+    uint32_t count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != nullptr && count < 64) {
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || strcmp(entry->d_name + len - 4, ".csv") != 0) continue;
+        snprintf(names[count++], sizeof(names[0]), "%s/%s", dir, entry->d_name);
+    }
+    closedir(d);
+    qsort(names, count, sizeof(names[0]), [](const void* x, const void* y) {
+        return strcmp((const char*)x, (const char*)y);
+    });
+    for (uint32_t i = 0; i < count; i++) replayFile(names[i], failures);
+}
+
+// ---------------------------------------------------------------------------
+// Synthetic scenarios: piecewise segments of orientation, |a| shape and rotation
+// ---------------------------------------------------------------------------
+
+// Where generated samples go: straight into a detector, or into a trace file
+struct Sink {
+    FallDetector* detector;
+    FILE* out;
+    uint32_t jitterUs;
+
+    void sample(const float a[3], const float g[3], uint32_t t, float height) {
+        if (detector) {
+            detector->setHeight(height);
+            detector->addSample(a, g, t);
+        }
+        if (out) {
+            uint32_t jitter = jitterUs ? (uint32_t)(rand() % (2 * jitterUs + 1)) : 0;
+            fprintf(out, "%u,%.3f,%.3f,%.3f,%.2f,%.2f,%.2f,%.2f\n", t + jitter, a[0], a[1], a[2],
+                    g[0], g[1], g[2], height);
+        }
+    }
+};
+
+struct Scenario {
+    const char* name;
+    const char* file;
+    bool expectFall;
+    void (*generate)(Sink& d, uint32_t& t);
+};
+
+static float noise(float amplitude) {
+    return amplitude * ((rand() % 2001) / 1000.0f - 1.0f);
+}
+
+// `seconds` of samples: gravity along (gx,gy,gz) unit vector scaled by `scale`, plus a
+// sinusoidal body component of `bodyG` at `hz`, and a rotation rate of `dps`
+static void segment(Sink& d, uint32_t& t, float seconds, const float dir[3],
+                    float scale, float bodyG, float hz, float dps, float height = 0.0f) {
+    uint32_t n = (uint32_t)(seconds * REPLAY_RATE_HZ);
+    uint32_t periodUs = (uint32_t)(1e6f / REPLAY_RATE_HZ);
+    for (uint32_t i = 0; i < n; i++) {
+        float body = bodyG * sinf(2.0f * 3.14159265f * hz * i / REPLAY_RATE_HZ);
+        float a[3], g[3];
+        for (uint8_t k = 0; k < 3; k++) {
+            a[k] = dir[k] * (scale + body) * REPLAY_G + noise(0.05f);
+            g[k] = (k == 1 ? dps : 0.0f) + noise(1.0f);
+        }
+        saturate(a, g);
+        d.sample(a, g, t, height);
+        t += periodUs;
+    }
+}
+
+static const float UPRIGHT[3] = {0.0f, 0.0f, 1.0f};
+static const float LYING[3] = {1.0f, 0.0f, 0.0f};
+static const float TILTED[3] = {0.5f, 0.0f, 0.866f};
+
+static void fallForward(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.15f, 1.8f, 0.0f);          // walking
+    segment(d, t, 0.35f, TILTED, 0.25f, 0.0f, 0.0f, 150.0f);         // toppling, near free fall
+    segment(d, t, 0.05f, LYING, 3.8f, 0.0f, 0.0f, 80.0f);           // impact
+    segment(d, t, 0.4f, LYING, 1.0f, 0.4f, 6.0f, 10.0f, -0.8f);      // bounce
+    segment(d, t, 4.0f, LYING, 1.0f, 0.0f, 0.0f, 0.0f, -0.8f);       // lying still
+}
+
+static void collapse(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.02f, 0.3f, 0.0f);          // standing
+    segment(d, t, 0.06f, TILTED, 3.0f, 0.0f, 0.0f, 60.0f);           // knees give, hits the floor
+    segment(d, t, 0.4f, LYING, 1.0f, 0.3f, 5.0f, 5.0f, -0.5f);
+    segment(d, t, 4.0f, LYING, 1.0f, 0.0f, 0.0f, 0.0f, -0.5f);
+}
+
+static void sitDown(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.02f, 0.3f, 0.0f);
+    segment(d, t, 0.3f, UPRIGHT, 0.7f, 0.0f, 0.0f, 20.0f);           // lowering
+    segment(d, t, 0.08f, UPRIGHT, 1.8f, 0.0f, 0.0f, 10.0f, -0.4f);   // landing on the chair
+    segment(d, t, 4.0f, TILTED, 1.0f, 0.01f, 0.2f, 0.0f, -0.4f);
+}
+
+static void jump(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.02f, 0.3f, 0.0f);
+    segment(d, t, 0.25f, UPRIGHT, 0.05f, 0.0f, 0.0f, 5.0f);          // airborne
+    segment(d, t, 0.05f, UPRIGHT, 3.5f, 0.0f, 0.0f, 5.0f);           // landing
+    segment(d, t, 4.0f, UPRIGHT, 1.0f, 0.15f, 1.8f, 0.0f);           // walks on
+}
+
+static void runningStairs(Sink& d, uint32_t& t) {
+    segment(d, t, 8.0f, UPRIGHT, 1.0f, 0.9f, 2.6f, 30.0f);           // heavy rhythmic steps
+}
+
+// The board put down hard on a table and left there: impact and stillness, nothing else
+static void setDownHard(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.1f, 1.0f, 20.0f);           // in the hand
+    segment(d, t, 0.05f, UPRIGHT, 3.2f, 0.0f, 0.0f, 10.0f);          // slammed down
+    segment(d, t, 0.3f, UPRIGHT, 1.0f, 0.2f, 8.0f, 5.0f);
+    segment(d, t, 4.0f, UPRIGHT, 1.0f, 0.0f, 0.0f, 0.0f);            // left on the table
+}
+
+// A reading stuck near 0 g for seconds, then a knock: the stuck stretch is not a free fall
+static void stuckThenKnock(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.0f, 0.0f, 0.0f);
+    segment(d, t, 3.0f, UPRIGHT, 0.02f, 0.0f, 0.0f, 0.0f);           // glitch
+    segment(d, t, 0.05f, UPRIGHT, 3.0f, 0.0f, 0.0f, 5.0f);
+    segment(d, t, 4.0f, UPRIGHT, 1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+static void droppedAndPickedUp(Sink& d, uint32_t& t) {
+    segment(d, t, 3.0f, UPRIGHT, 1.0f, 0.0f, 0.0f, 0.0f);            // on a table
+    segment(d, t, 0.4f, UPRIGHT, 0.02f, 0.0f, 0.0f, 200.0f);         // falls off
+    segment(d, t, 0.04f, LYING, 6.0f, 0.0f, 0.0f, 300.0f);           // hits the floor
+    segment(d, t, 0.5f, LYING, 1.0f, 0.0f, 0.0f, 0.0f);
+    segment(d, t, 2.5f, UPRIGHT, 1.0f, 0.3f, 2.0f, 90.0f);           // picked up, carried
+}
+
+static const Scenario SCENARIOS[] = {
+    {"fall forward", "fall_forward", true, fallForward},
+    {"collapse", "collapse", true, collapse},
+    {"sit down", "sit_down", false, sitDown},
+    {"jump", "jump", false, jump},
+    {"running on stairs", "running_stairs", false, runningStairs},
+    {"set down hard", "set_down_hard", false, setDownHard},
+    {"stuck at 0 g, then a knock", "stuck_then_knock", false, stuckThenKnock},
+    {"dropped, picked up", "dropped_picked_up", false, droppedAndPickedUp},
+};
+
+static int writeTraces(const char* dir) {
+    srand(2);
+    for (const Scenario& s : SCENARIOS) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s.csv", dir, s.file);
+        FILE* f = fopen(path, "w");
+        if (!f) {
+            printf("%s: cannot write\n", path);
+            return 1;
+        }
+        fprintf(f, "# %s, rendered by fall_replay --write (104 Hz, +-%u us jitter)\n", s.name,
+                REPLAY_TRACE_JITTER_US);
+        fprintf(f, "# expect: %s\n", s.expectFall ? "fall" : "no fall");
+        fprintf(f, "# t_us,ax,ay,az,gx,gy,gz,height_m\n");
+        Sink sink = {nullptr, f, REPLAY_TRACE_JITTER_US};
+        uint32_t t = 0;
+        s.generate(sink, t);
+        fclose(f);
+        printf("wrote %s\n", path);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 3 && strcmp(argv[1], "--write") == 0) {
+        return writeTraces(argv[2]);
+    }
+
+    int failures = 0;
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) replayFile(argv[i], failures);
+        return failures ? 1 : 0;
+    }
+
+    srand(1);
+    for (const Scenario& s : SCENARIOS) {
+        FallDetector detector;
+        Sink sink = {&detector, nullptr, 0};
+        uint32_t t = 0;
+        s.generate(sink, t);
+        FallEvent e;
+        bool got = detector.poll(e);
+        verdict(s.name, s.expectFall, got, failures);
+        if (got) report(s.name, e);
+    }
+    replayDirectory(REPLAY_TRACE_DIR, failures);
+    return failures ? 1 : 0;
+}
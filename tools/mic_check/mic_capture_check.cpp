@@ -0,0 +1,210 @@
+/*
+ * Host check for the microphone block path: MockMicDmaSource -> MicCapture -> the
+ * mic thread's processing (SoundLevelMeter, NoiseFloorTracker, SoundActivityDetector,
+ * SpectrumAnalyzer).
+ *
+ * Build and run from the repository root:
+ *   g++ -std=gnu++11 -O2 -Ilib/SensorPipeline/src tools/mic_check/mic_capture_check.cpp \
+ *       lib/SensorPipeline/src/MicCapture.cpp lib/SensorPipeline/src/MicSources.cpp \
+ *       lib/SensorPipeline/src/SoundLevel.cpp lib/SensorPipeline/src/NoiseFloorTracker.cpp \
+ *       lib/SensorPipeline/src/SoundActivity.cpp lib/SensorPipeline/src/SpectrumAnalyzer.cpp \
+ *       -o mic_capture_check && ./mic_capture_check
+ *
+ * The mock converts a DC level, a tone and noise at 8 kHz into the ping-pong buffer
+ * and fires the half/complete callbacks as simulated time advances. A consumer that
+ * keeps up must see every block once, in order, 32 ms apart; a 1 kHz tone must read at
+ * its calibrated level, wake the activity detector and put the spectral centroid at
+ * 1 kHz; a consumer that holds a block too long must see overruns and then recover.
+ * Each check prints expected vs got; any mismatch exits with status 1.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "MicCapture.h"
+#include "MicSources.h"
+#include "SoundLevel.h"
+#include "NoiseFloorTracker.h"
+#include "SoundActivity.h"
+#include "SpectrumAnalyzer.h"
+
+// The firmware's microphone settings (src/main.cpp)
+#define CHECK_ADC_BITS 12
+#define CHECK_HIGHPASS_HZ 20
+#define CHECK_FAST_MS 125
+#define CHECK_LEQ_MS 1000
+#define CHECK_REFERENCE_DB 120
+#define CHECK_BLOCK_US (1000000u / MIC_SAMPLE_RATE_HZ * MIC_BLOCK_SAMPLES)
+
+#define CHECK_TONE_HZ 1000.0f
+#define CHECK_TONE_AMPLITUDE 1024     // Half of full scale: -6.02 dBFS
+#define CHECK_TONE_DB 113.98f         // CHECK_REFERENCE_DB - 6.02
+
+static int failures = 0;
+
+static void expect(const char* scenario, const char* what, long expected, long got) {
+    printf("%-8s %-30s expected %-8ld got %-8ld %s\n", scenario, what, expected, got,
+           expected == got ? "ok" : "MISMATCH");
+    if (expected != got) failures++;
+}
+
+static void expectNear(const char* scenario, const char* what, float expected, float got, float tolerance) {
+    bool ok = got >= expected - tolerance && got <= expected + tolerance;
+    printf("%-8s %-30s expected %-8.1f got %-8.1f %s\n", scenario, what, expected, got, ok ? "ok" : "MISMATCH");
+    if (!ok) failures++;
+}
+
+static void countNotify(void* ctx) {
+    (*static_cast<uint32_t*>(ctx))++;
+}
+
+// The mic thread's work per block, set up as SoundCalibrator does
+struct MicPath {
+    SoundLevelMeter meter;
+    NoiseFloorTracker floor;
+    SoundActivityDetector activity;
+    SpectrumAnalyzer spectrum;
+
+    MicPath() {
+        meter.begin(MIC_SAMPLE_RATE_HZ, CHECK_ADC_BITS, CHECK_HIGHPASS_HZ, CHECK_FAST_MS, CHECK_LEQ_MS);
+        meter.setReferenceDb(CHECK_REFERENCE_DB);
+        floor.begin(1000, 8, SOUND_DB_Q8(1.5f));
+        SoundActivityConfig vad;
+        vad.onMarginDbQ8 = SOUND_DB_Q8(6);
+        vad.offMarginDbQ8 = SOUND_DB_Q8(3);
+        vad.strongMarginDbQ8 = SOUND_DB_Q8(15);
+        vad.onsetBlocks = 2;
+        vad.hangoverMs = 800;
+        vad.voiceMinHz = 80;
+        vad.voiceMaxHz = 1500;
+        vad.noiseMinHz = 1800;
+        activity.begin(vad, MIC_SAMPLE_RATE_HZ);
+        spectrum.begin(MIC_SAMPLE_RATE_HZ, CHECK_REFERENCE_DB);
+    }
+
+    void process(const MicBlock& block) {
+        meter.process(block.samples, block.count);
+        uint32_t nowMs = block.timestampUs / 1000;
+        floor.update(meter.getBlockDbQ8(), nowMs);
+        activity.update(meter.getBlockDbQ8(), floor.getFloorDbQ8(), meter.getBlockZeroCrossings(), block.count, nowMs);
+        if (activity.isActive()) spectrum.process(block.samples, block.count);
+    }
+};
+
+// What the consumer saw
+struct Consumer {
+    uint32_t received;
+    uint32_t nextSequence;
+    uint32_t skipped;
+    uint32_t badSpacing;
+    uint32_t lastTimestampUs;
+
+    Consumer() : received(0), nextSequence(0), skipped(0), badSpacing(0), lastTimestampUs(0) {}
+
+    void take(const MicBlock& block) {
+        if (block.sequence != nextSequence) skipped += block.sequence - nextSequence;
+        if (received > 0 && block.sequence == nextSequence &&
+            block.timestampUs - lastTimestampUs != CHECK_BLOCK_US) {
+            badSpacing++;
+        }
+        if (block.count != MIC_BLOCK_SAMPLES) badSpacing++;
+        nextSequence = block.sequence + 1;
+        lastTimestampUs = block.timestampUs;
+        received++;
+    }
+};
+
+// Advance in 1 ms steps (the mic thread wakes on every half) and process what is ready
+static void run(MockMicDmaSource& source, MicCapture& capture, Consumer& consumer, MicPath* path,
+                uint32_t durationMs) {
+    for (uint32_t t = 0; t < durationMs; t++) {
+        source.advance(1000);
+        MicBlock block;
+        while (capture.acquire(block)) {
+            consumer.take(block);
+            if (path != nullptr) path->process(block);
+            capture.release();
+        }
+    }
+}
+
+static void steady() {
+    MockMicDmaSource source;
+    MicCapture capture;
+    Consumer consumer;
+    MicPath path;
+    uint32_t notified = 0;
+    capture.setNotify(countNotify, &notified);
+    source.setSignal(2048, 0, CHECK_TONE_HZ, 8);
+    expect("steady", "capture started", 1, capture.begin(&source, MIC_SAMPLE_RATE_HZ));
+
+    // Quiet room: the floor settles and nothing is active
+    run(source, capture, consumer, &path, 10000);
+    float quietDb = path.meter.getLeqDbQ8() / 256.0f;
+    expect("steady", "floor converged", 1, path.floor.isConverged());
+    // The bias lifts the minimum back up to the mean, so the floor sits at the quiet Leq
+    expectNear("steady", "floor at quiet level (dB)", quietDb, path.floor.getFloorDbQ8() / 256.0f, 2.0f);
+    expect("steady", "quiet: no activity", 0, path.activity.isActive());
+
+    // Tone at half scale
+    source.setSignal(2048, CHECK_TONE_AMPLITUDE, CHECK_TONE_HZ, 8);
+    run(source, capture, consumer, &path, 3000);
+    expectNear("steady", "tone Leq (dB)", CHECK_TONE_DB, path.meter.getLeqDbQ8() / 256.0f, 0.5f);
+    expectNear("steady", "tone block level (dB)", CHECK_TONE_DB, path.meter.getBlockDbQ8() / 256.0f, 0.5f);
+    expect("steady", "tone: activity", 1, path.activity.isActive());
+    SpectrumFeatures features;
+    expect("steady", "spectrum published", 1, path.spectrum.getFeatures(features));
+    expectNear("steady", "centroid (Hz)", CHECK_TONE_HZ, features.centroidHz, 60.0f);
+    expect("steady", "tonal (flatness < 0.1)", 1, features.flatnessQ15 < 3277);
+
+    // Quiet again: activity ends after the hangover
+    source.setSignal(2048, 0, CHECK_TONE_HZ, 8);
+    run(source, capture, consumer, &path, 2000);
+    expect("steady", "after tone: no activity", 0, path.activity.isActive());
+
+    uint32_t produced = source.nowUs() / CHECK_BLOCK_US;
+    expect("steady", "blocks completed", produced, capture.getBlockCount());
+    expect("steady", "blocks received", produced, consumer.received);
+    expect("steady", "notifications", produced, notified);
+    expect("steady", "skipped", 0, consumer.skipped);
+    expect("steady", "bad spacing", 0, consumer.badSpacing);
+    expect("steady", "overruns", 0, capture.getOverrunCount());
+}
+
+// The consumer holds one block for 200 ms: every half completed meanwhile lands on a
+// block nobody has taken, which must count as an overrun and show as a sequence gap
+static void stall() {
+    MockMicDmaSource source;
+    MicCapture capture;
+    Consumer consumer;
+    capture.begin(&source, MIC_SAMPLE_RATE_HZ);
+    run(source, capture, consumer, nullptr, 1000);
+    expect("stall", "overruns before", 0, capture.getOverrunCount());
+
+    MicBlock held;
+    source.advance(CHECK_BLOCK_US);
+    expect("stall", "block ready", 1, capture.acquire(held));
+    consumer.take(held);
+    expect("stall", "second acquire refused", 0, capture.acquire(held));
+    source.advance(200000);
+    uint32_t overruns = capture.getOverrunCount();
+    expect("stall", "overruns counted", 1, overruns > 0);
+    capture.release();
+
+    run(source, capture, consumer, nullptr, 1000);
+    expect("stall", "recovered: no new overruns", overruns, capture.getOverrunCount());
+    expect("stall", "received + skipped", capture.getBlockCount(), consumer.received + consumer.skipped);
+    expect("stall", "skipped blocks overwritten", 1, consumer.skipped > 0 && consumer.skipped <= overruns);
+    expect("stall", "bad spacing", 0, consumer.badSpacing);
+
+    capture.end();
+    uint32_t blocks = capture.getBlockCount();
+    source.advance(100000);
+    expect("stall", "stopped: no more blocks", blocks, capture.getBlockCount());
+}
+
+int main() {
+    steady();
+    stall();
+    return failures ? 1 : 0;
+}